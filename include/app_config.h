@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file app_config.h
+ * @brief Application-wide compile-time configuration.
+ *
+ * Description:
+ * ------------
+ * Central place for sizes and tuning constants shared between modules. Every
+ * value is guarded with #ifndef so it can be overridden from the build
+ * (e.g., zephyr_compile_definitions() in CMakeLists.txt).
+ *
+ * @author Ameed Othman
+ * @date 2024-12-19
+ */
+
+#ifndef APP_CONFIG_H__
+#define APP_CONFIG_H__
+
+/* Size of one input line in uart_msgq, including the terminating NUL */
+#ifndef UART_MSG_SIZE
+#define UART_MSG_SIZE 64
+#endif
+
+/* Number of complete input lines that can be queued */
+#ifndef UART_MSGQ_LEN
+#define UART_MSGQ_LEN 10
+#endif
+
+/* Threads that can tag their output at once (see uart_handler_reply_tag_set()) */
+#ifndef UART_REPLY_TAG_SLOTS
+#define UART_REPLY_TAG_SLOTS 2
+#endif
+
+/*
+ * TX coalescing (see uart_handler_tx_cork()): how long a write to an idle
+ * transmitter waits for more output, how long corked output may be held,
+ * and how much uncorked output starts a transfer right away.
+ */
+#ifndef UART_TX_COALESCE_US
+#define UART_TX_COALESCE_US 200
+#endif
+
+#ifndef UART_TX_CORK_MAX_US
+#define UART_TX_CORK_MAX_US 5000
+#endif
+
+#ifndef UART_TX_COALESCE_BYTES
+#define UART_TX_COALESCE_BYTES 64
+#endif
+
+/* Default number of entries shown per page in dynamic list menus */
+#ifndef MENU_LIST_PAGE_SIZE
+#define MENU_LIST_PAGE_SIZE 10
+#endif
+
+/* Longest list menu header line (including NUL) */
+#ifndef MENU_LIST_LINE_MAX
+#define MENU_LIST_LINE_MAX 64
+#endif
+
+/* Number of independently controlled lights channels (at most 32) */
+#ifndef LIGHTS_CHANNEL_COUNT
+#define LIGHTS_CHANNEL_COUNT 8
+#endif
+
+/* Named channel groups usable in channel selectors ("g0", "g1", ...) */
+#ifndef LIGHTS_GROUP_COUNT
+#define LIGHTS_GROUP_COUNT 4
+#endif
+
+/* Largest chunk a streaming command producer yields at a time */
+#ifndef COMMAND_STREAM_CHUNK_SIZE
+#define COMMAND_STREAM_CHUNK_SIZE 80
+#endif
+
+/* Longest a streaming command waits for TX space before giving up */
+#ifndef COMMAND_STREAM_TX_TIMEOUT_MS
+#define COMMAND_STREAM_TX_TIMEOUT_MS 1000
+#endif
+
+/* How often blocking command waits check for an operator abort */
+#ifndef COMMAND_ABORT_POLL_MS
+#define COMMAND_ABORT_POLL_MS 10
+#endif
+
+/* Async commands (see command_async.h) that can be in flight at once */
+#ifndef COMMAND_ASYNC_MAX
+#define COMMAND_ASYNC_MAX 8
+#endif
+
+/* Per-command state an async command handler can keep across waits, in bytes */
+#ifndef COMMAND_ASYNC_DATA_SIZE
+#define COMMAND_ASYNC_DATA_SIZE 32
+#endif
+
+/* Interval at which lights usage counters are written to the state journal */
+#ifndef LIGHTS_USAGE_PERSIST_S
+#define LIGHTS_USAGE_PERSIST_S 300
+#endif
+
+/*
+ * Scene commits (lights_scene.c): the timer wakes up one tick plus this margin
+ * before the deadline, and the rest is busy-waited on a workqueue running at
+ * cooperative priority K_PRIO_COOP(LIGHTS_SCENE_WQ_PRIORITY).
+ */
+#ifndef LIGHTS_SCENE_WAKE_MARGIN_US
+#define LIGHTS_SCENE_WAKE_MARGIN_US 100
+#endif
+
+#ifndef LIGHTS_SCENE_WQ_PRIORITY
+#define LIGHTS_SCENE_WQ_PRIORITY 0
+#endif
+
+#ifndef LIGHTS_SCENE_WQ_STACK_SIZE
+#define LIGHTS_SCENE_WQ_STACK_SIZE 1024
+#endif
+
+/* Longest gap between measurements the regulator integrates and slews over */
+#ifndef LIGHTS_REGULATOR_DT_MAX_MS
+#define LIGHTS_REGULATOR_DT_MAX_MS 2000
+#endif
+
+/* Group commit window of the state journal, in milliseconds */
+#ifndef STATE_JOURNAL_COMMIT_MS
+#define STATE_JOURNAL_COMMIT_MS 20
+#endif
+
+/* Number of pending journal records that triggers an immediate commit */
+#ifndef STATE_JOURNAL_BATCH_MAX
+#define STATE_JOURNAL_BATCH_MAX 16
+#endif
+
+/* Compact the journal once the active half is this full (percent) */
+#ifndef STATE_JOURNAL_COMPACT_PCT
+#define STATE_JOURNAL_COMPACT_PCT 75
+#endif
+
+/* If non-zero, state-changing commands acknowledge only after commit */
+#ifndef STATE_JOURNAL_DEFER_ACK
+#define STATE_JOURNAL_DEFER_ACK 1
+#endif
+
+/* Longest a command waits for its journal commit before acknowledging */
+#ifndef STATE_JOURNAL_ACK_TIMEOUT_MS
+#define STATE_JOURNAL_ACK_TIMEOUT_MS 200
+#endif
+
+/* Number of events kept for reconnecting hosts to catch up on */
+#ifndef EVENT_LOG_SIZE
+#define EVENT_LOG_SIZE 64
+#endif
+
+/* Period of the sensor sampler that feeds the filter chains */
+#ifndef SENSOR_SAMPLE_INTERVAL_MS
+#define SENSOR_SAMPLE_INTERVAL_MS 100
+#endif
+
+/* Filter stages per sensor channel */
+#ifndef SENSOR_FILTER_STAGES_MAX
+#define SENSOR_FILTER_STAGES_MAX 4
+#endif
+
+/* Largest median/moving average window, in samples (at most 255) */
+#ifndef SENSOR_FILTER_WINDOW_MAX
+#define SENSOR_FILTER_WINDOW_MAX 16
+#endif
+
+/* Size of the downstream link TX ring buffer, in bytes */
+#ifndef UART_LINK_TX_BUF_SIZE
+#define UART_LINK_TX_BUF_SIZE 512
+#endif
+
+/* Requests the gateway can have outstanding downstream at once */
+#ifndef GATEWAY_INFLIGHT_MAX
+#define GATEWAY_INFLIGHT_MAX 8
+#endif
+
+/* Outstanding requests per destination; further ones wait in its queue */
+#ifndef GATEWAY_DEST_WINDOW
+#define GATEWAY_DEST_WINDOW 2
+#endif
+
+/* Destinations with queued or outstanding requests at once */
+#ifndef GATEWAY_DEST_MAX
+#define GATEWAY_DEST_MAX 8
+#endif
+
+/* Requests stored per destination while its window is full */
+#ifndef GATEWAY_QUEUE_DEPTH
+#define GATEWAY_QUEUE_DEPTH 4
+#endif
+
+/* Time a downstream unit has to finish its reply, in milliseconds */
+#ifndef GATEWAY_TIMEOUT_MS
+#define GATEWAY_TIMEOUT_MS 1000
+#endif
+
+#endif /* APP_CONFIG_H__ */
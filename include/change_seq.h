@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file change_seq.h
+ * @brief Global change sequence numbers.
+ *
+ * Description:
+ * ------------
+ * Every state change in the application (lights channel, config key, sensor
+ * value) is stamped with a number from a single, monotonically increasing
+ * global sequence. A host that remembers the last sequence number it has
+ * seen can then ask for exactly the objects that changed since then.
+ *
+ * The sequence space of each boot (an epoch) starts at a new base from a
+ * persisted boot counter (the "floor"). Objects restored at boot are stamped
+ * with the floor, and sequence numbers from before the floor belong to an
+ * earlier boot, so a host presenting one needs a full snapshot.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef CHANGE_SEQ_H__
+#define CHANGE_SEQ_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start this boot's sequence space.
+ *
+ * Increments the persisted boot counter. Call after state_journal_init() and
+ * before initializing the modules that stamp their objects.
+ */
+void change_seq_init(void);
+
+/**
+ * @brief Allocate the next sequence number for a change.
+ *
+ * When this boot's range is used up the sequence continues in a new epoch
+ * above a new floor, as after a reboot.
+ *
+ * @return A sequence number greater than any returned before in this epoch.
+ */
+uint32_t change_seq_next(void);
+
+/**
+ * @brief Get the most recently allocated sequence number.
+ *
+ * @return The current sequence number (the floor if nothing changed yet).
+ */
+uint32_t change_seq_current(void);
+
+/**
+ * @brief Get the first sequence number of this boot.
+ *
+ * @return The floor, which objects restored at boot are stamped with.
+ */
+uint32_t change_seq_floor(void);
+
+/**
+ * @brief Get the version objects start at in this boot.
+ *
+ * Per-object versions (lights channels, config keys) are seeded from the
+ * boot's sequence space as well, so a version a host saw before a reset
+ * never matches an object after it and a stale compare-and-set fails.
+ *
+ * @return The floor plus one (never LIGHTS_VERSION_ANY / 0).
+ */
+uint32_t change_seq_first_version(void);
+
+/**
+ * @brief Check whether a host's cursor can no longer be served as a delta.
+ *
+ * @param since Last sequence number the host has seen.
+ *
+ * @return true if @p since is from another epoch or not yet allocated, or if
+ *         the boot counter wrapped this boot, so the host needs a snapshot.
+ */
+bool change_seq_is_stale(uint32_t since);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHANGE_SEQ_H__ */
@@ -0,0 +1,166 @@
+/**
+ * @file command_async.h
+ * @brief Cooperative asynchronous command handlers.
+ *
+ * Description:
+ * ------------
+ * A command that has to wait (for a sensor conversion, a flash write, a
+ * downstream reply, ...) would block the thread running it. Async commands
+ * instead return to the dispatcher while they wait: the handler is a step
+ * function that runs until it has to wait, records a wake condition with one
+ * of the command_async_wait_*() helpers and returns COMMAND_ASYNC_PENDING.
+ * The dispatcher calls the step again once the condition fires (or its
+ * timeout expires), so the step resumes at the point saved in `state`, in
+ * the style of a protothread.
+ *
+ * Steps run on the system workqueue as triggered work items, so a single
+ * thread keeps up to COMMAND_ASYNC_MAX commands in flight, each costing one
+ * struct command_async instead of a thread and a stack. Steps must therefore
+ * never block; they keep their variables in `data`, since locals do not
+ * survive a wait.
+ *
+ * Example step:
+ * @code
+ *   static int blink_step(struct command_async *cmd)
+ *   {
+ *       switch (cmd->state) {
+ *       case 0:
+ *           lights_control_set_channel(0, true, 100);
+ *           cmd->state = 1;
+ *           return command_async_sleep(cmd, 500);
+ *       default:
+ *           lights_control_set_channel(0, false, 0);
+ *           return 0;
+ *       }
+ *   }
+ * @endcode
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#ifndef COMMAND_ASYNC_H__
+#define COMMAND_ASYNC_H__
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#include "app_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Step result: the command waits for the condition it has set. */
+#define COMMAND_ASYNC_PENDING 1
+
+struct command_async;
+
+/**
+ * @brief Run a command until it completes or has to wait.
+ *
+ * @param cmd The command; `state` and `data` hold its progress.
+ * @return COMMAND_ASYNC_PENDING after setting a wake condition, 0 when the
+ *         command completed, or a negative error code.
+ */
+typedef int (*command_async_step_fn)(struct command_async *cmd);
+
+/**
+ * @brief Completion callback, called on the system workqueue.
+ *
+ * @param cmd The completed command (released after the callback returns).
+ * @param status Final result of the step function.
+ */
+typedef void (*command_async_done_fn)(struct command_async *cmd, int status);
+
+/**
+ * @brief An asynchronous command in flight.
+ */
+struct command_async {
+	/** Step function (required). */
+	command_async_step_fn step;
+	/** Resume point for the step function, starts at 0. */
+	uint32_t state;
+	/** Outcome of the last wait: 0 if the condition fired, -EAGAIN on timeout. */
+	int wake_result;
+	/** Handler-specific state that survives waits. */
+	uint8_t data[COMMAND_ASYNC_DATA_SIZE] __aligned(8);
+
+	/* Private to the dispatcher */
+	command_async_done_fn done;
+	void *user_data;
+	struct k_work_poll work;
+	struct k_poll_event events[2];
+	struct k_poll_signal never;
+	k_timeout_t timeout;
+	char tag[16];
+	bool used;
+};
+
+/**
+ * @brief Take a command from the pool.
+ *
+ * @return The command with `state` and `data` cleared, or NULL if
+ *         COMMAND_ASYNC_MAX commands are already in flight.
+ */
+struct command_async *command_async_alloc(void);
+
+/**
+ * @brief Return a command that was allocated but not submitted.
+ */
+void command_async_free(struct command_async *cmd);
+
+/**
+ * @brief Start a command.
+ *
+ * The first step runs on the system workqueue. Output of the command is
+ * tagged with the calling thread's reply tag, if any (see
+ * uart_handler_reply_tag_set()). An abort wakes a waiting command and ends
+ * it with -ECANCELED instead of running its next step.
+ *
+ * @param cmd Command from command_async_alloc() with `step` set.
+ * @param done Callback receiving the final status (may be NULL).
+ * @param user_data Value stored in the command for the callback.
+ * @return COMMAND_ASYNC_PENDING; the result is reported through @p done.
+ */
+int command_async_submit(struct command_async *cmd, command_async_done_fn done,
+			 void *user_data);
+
+/**
+ * @brief Resume the command after a delay.
+ *
+ * @return COMMAND_ASYNC_PENDING, to be returned by the step function.
+ */
+int command_async_sleep(struct command_async *cmd, uint32_t ms);
+
+/**
+ * @brief Resume the command once a signal is raised, or after a timeout.
+ *
+ * The signal is reset before the command resumes; `wake_result` is -EAGAIN
+ * if the timeout expired first.
+ *
+ * @return COMMAND_ASYNC_PENDING, to be returned by the step function.
+ */
+int command_async_wait_signal(struct command_async *cmd, struct k_poll_signal *signal,
+			      uint32_t timeout_ms);
+
+/**
+ * @brief Resume the command once a semaphore is available, or after a timeout.
+ *
+ * The semaphore is not taken; the step takes it with K_NO_WAIT (another
+ * waiter may have been faster). `wake_result` is -EAGAIN on timeout.
+ *
+ * @return COMMAND_ASYNC_PENDING, to be returned by the step function.
+ */
+int command_async_wait_sem(struct command_async *cmd, struct k_sem *sem, uint32_t timeout_ms);
+
+/**
+ * @brief Number of commands currently in flight.
+ */
+int command_async_in_flight(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_ASYNC_H__ */
@@ -0,0 +1,51 @@
+/**
+ * @file command_events.h
+ * @brief Event catch-up and diagnostics command interface.
+ *
+ * Description:
+ * ------------
+ * This header provides the commands that read the event log: the menu
+ * diagnostics action (category=4) and the `events <since>` text command used
+ * by reconnecting hosts to replay missed events.
+ *
+ * Typical Actions:
+ * ----------------
+ *  action_id=0: List all events still held in the log
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef COMMAND_EVENTS_H__
+#define COMMAND_EVENTS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Execute a diagnostics menu command.
+ *
+ * @param action_id The diagnostics action (0=list event log).
+ */
+void command_events_execute(int action_id);
+
+/**
+ * @brief Execute an events text command.
+ *
+ * Form: `events <since>`, where <since> is the last event sequence number
+ * the host has seen. Replays every newer event, preceded by `EVENTS GAP` if
+ * some of them are no longer available.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 if the reply was sent, -EINVAL for invalid arguments, or the
+ *         error of the output stream (e.g., -ECANCELED on abort).
+ */
+int command_events_execute_args(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_EVENTS_H__ */
@@ -0,0 +1,111 @@
+/**
+ * @file command_gateway.h
+ * @brief Addressed commands and gateway forwarding to downstream units.
+ *
+ * Description:
+ * ------------
+ * Units can be daisy-chained, with only the first one connected to the host.
+ * A host addresses a unit by prefixing a text command with the unit address
+ * and a request ID of its choice:
+ *
+ *   @<address> <id> <command...>        e.g. "@3 17 lights get 0"
+ *
+ * The addressed unit runs the command and tags every reply line with the
+ * request ID, followed by an end line carrying the command's status:
+ *
+ *   #17 OK LIGHTS ch=0 on=1 level=40 ver=3
+ *   #17 END 0
+ *
+ * A unit in gateway mode (config key `gateway`) forwards commands for other
+ * addresses to its downstream UART. Each destination has a store-and-forward
+ * queue; up to GATEWAY_DEST_WINDOW requests per destination (and
+ * GATEWAY_INFLIGHT_MAX in total) are outstanding at once. Forwarded requests
+ * get a gateway-local ID, so IDs from the host never collide downstream, and
+ * reply lines are mapped back to the host's ID. A request whose reply does
+ * not end within GATEWAY_TIMEOUT_MS gets an END line with -ETIMEDOUT, and a
+ * request that cannot be queued gets one with -EBUSY.
+ *
+ * Address GATEWAY_BROADCAST_ADDRESS addresses every unit. Each unit runs a
+ * broadcast command and, in gateway mode, passes it on downstream with
+ * request ID 0 before running it. Only the unit the host talks to replies;
+ * replies tagged #0 are discarded on the way up.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef COMMAND_GATEWAY_H__
+#define COMMAND_GATEWAY_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Address of a command for all units of the chain. */
+#define GATEWAY_BROADCAST_ADDRESS 255
+
+/**
+ * @brief Gateway counters since boot.
+ */
+struct command_gateway_stats {
+	/** Requests sent downstream. */
+	uint32_t forwarded;
+	/** Requests completed by an END line from downstream. */
+	uint32_t completed;
+	/** Requests answered with a timeout. */
+	uint32_t timeouts;
+	/** Requests refused because the queues were full. */
+	uint32_t rejected;
+	/** Downstream lines that matched no outstanding request. */
+	uint32_t dropped;
+	/** Broadcast commands passed on downstream. */
+	uint32_t broadcasts;
+	/** Requests currently outstanding downstream. */
+	uint32_t inflight;
+	/** Requests currently waiting in destination queues. */
+	uint32_t queued;
+};
+
+/**
+ * @brief Set up the downstream link.
+ *
+ * Call after config_store_init(). Without a downstream UART, addressed
+ * commands for this unit still work but nothing is forwarded.
+ */
+void command_gateway_init(void);
+
+/**
+ * @brief Execute an addressed command line ("@<address> <id> <command...>").
+ *
+ * Runs the command locally if the address is this unit's, otherwise queues
+ * it for forwarding. Either way the reply is sent asynchronously tagged with
+ * the request ID, so the return value only reflects the framing.
+ *
+ * @param line The command line (modified).
+ * @return 0 if the request was handled, or -EINVAL if it is malformed.
+ */
+int command_gateway_execute_line(char *line);
+
+/**
+ * @brief Execute a gateway text command (`gateway status`).
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 on success, or -EINVAL for invalid arguments.
+ */
+int command_gateway_execute_args(int argc, char **argv);
+
+/**
+ * @brief Get a snapshot of the gateway counters.
+ *
+ * @param stats Pointer receiving the counters.
+ */
+void command_gateway_get_stats(struct command_gateway_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_GATEWAY_H__ */
@@ -18,6 +18,8 @@
 #ifndef COMMAND_LIGHTS_H__
 #define COMMAND_LIGHTS_H__
 
+#include "command_async.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +32,47 @@ extern "C" {
  */
 void command_lights_execute(int action_id);
 
+/**
+ * @brief Execute a lights text command.
+ *
+ * Supported forms (argv[0] is "lights"):
+ *   lights get <ch>
+ *   lights set <sel> <on|off> <level>
+ *   lights cas <ch> <version> <on|off> <level>
+ *   lights on <sel>
+ *   lights off <sel>
+ *   lights group <n> [<sel>]
+ *   lights stats
+ *   lights usage [<ch>]
+ *
+ * <sel> is a channel selector (see input_parser_parse_channels()): a
+ * comma-separated list of channels `N`, ranges `N-M`, groups `gK` and `*`
+ * (all channels), e.g. `0,2,4-7` or `g1,3`. `on` and `off` keep each
+ * channel's level. `group <n> <sel>` defines group n, `group <n>` shows it.
+ *
+ * Replies are single lines:
+ *   - `get`, `cas` and `set` of a plain channel number:
+ *     `[OK|CONFLICT] LIGHTS <ch> on=<0|1> level=<n> ver=<v>`
+ *   - `set`, `on` and `off` with any other selector:
+ *     `OK LIGHTS mask=0x<hex> changed=<n>`, where the mask holds the selected
+ *     channels and n is the number of channels that changed
+ *   - `group`: `OK GROUP g<n> mask=0x<hex>`
+ *   - `stats`: `OK LIGHTS_STATS writes=<n> coalesced=<n> commits=<n> pending=<n>`
+ *   - `usage <ch>`: `OK USAGE <ch> on_s=<n> duty_s=<n> cycles=<n> mwh=<n>`;
+ *     `usage` streams that line for every channel, then `OK USAGE END`
+ *
+ * Writes (`set`, `cas`, `on`, `off`) are applied at once. With
+ * STATE_JOURNAL_DEFER_ACK their reply is sent by an async command (see
+ * command_async.h) once the change is committed to the state journal.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @param cmd Receives the async command acknowledging a write.
+ * @return 0 if the command was understood, COMMAND_ASYNC_PENDING if @p cmd
+ *         was set up, -EINVAL for invalid arguments, or -ECANCELED on abort.
+ */
+int command_lights_execute_args(int argc, char **argv, struct command_async **cmd);
+
 #ifdef __cplusplus
 }
 #endif
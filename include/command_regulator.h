@@ -0,0 +1,41 @@
+/**
+ * @file command_regulator.h
+ * @brief Constant-light regulator command interface.
+ *
+ * Description:
+ * ------------
+ * This header provides the `regulator` text command, which enables, disables
+ * and reports the closed-loop lights regulator (see lights_regulator.h). The
+ * loop is tuned through the `reg_*` config keys (`config set reg_kp 30`).
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef COMMAND_REGULATOR_H__
+#define COMMAND_REGULATOR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Execute a regulator text command.
+ *
+ * Forms:
+ *   regulator on [<setpoint lux>]
+ *   regulator off
+ *   regulator status
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 on success, -EINVAL for invalid arguments, or the error of the
+ *         regulator or config store.
+ */
+int command_regulator_execute_args(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_REGULATOR_H__ */
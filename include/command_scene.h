@@ -0,0 +1,68 @@
+/**
+ * @file command_scene.h
+ * @brief Scene and time command interface.
+ *
+ * Description:
+ * ------------
+ * This header provides the `scene` text command, which stages lights
+ * changes and commits them at an absolute time (see lights_scene.h), and the
+ * `time` text command, which lets the host estimate and set the offset
+ * between its clock and the device time (see device_time.h).
+ *
+ * A synchronized scene switch across units then looks like:
+ *
+ *   @3 1 time sync <t1>              (repeated; host keeps the fastest round trip)
+ *   @3 2 time offset <offset>
+ *   @3 3 scene stage 0 on 80         (per unit, per channel)
+ *   @255 4 scene commit <host time>  (broadcast, see command_gateway.h)
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#ifndef COMMAND_SCENE_H__
+#define COMMAND_SCENE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Execute a scene text command.
+ *
+ * Forms:
+ *   scene stage <ch> <on|off> <level>
+ *   scene commit <host time us>
+ *   scene clear
+ *   scene status
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 on success, -EINVAL for invalid arguments, or the error of the
+ *         scene driver (-EBUSY while a commit is scheduled, -ENODATA when
+ *         committing an empty scene).
+ */
+int command_scene_execute_args(int argc, char **argv);
+
+/**
+ * @brief Execute a time text command.
+ *
+ * Forms:
+ *   time                   (device time, offset and host time)
+ *   time sync <t1>         (replies t1, receive time t2 and reply time t3)
+ *   time offset <us>       (host time minus device time)
+ *
+ * With t4 the host's receive time, the host estimates the offset as
+ * ((t2 - t1) + (t3 - t4)) / 2, with an error of at most half the round trip.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 on success, or -EINVAL for invalid arguments.
+ */
+int command_scene_time_execute_args(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_SCENE_H__ */
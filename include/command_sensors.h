@@ -15,6 +15,7 @@
 * ----------------
 *  action_id=0: Read temperature
 *  action_id=1: Read humidity
+*  action_id=2: Read ambient light
 * Additional actions can be easily added as needed.
 *
 * @author Ameed Othman
@@ -24,6 +25,8 @@
 #ifndef COMMAND_SENSORS_H__
 #define COMMAND_SENSORS_H__
 
+#include "command_async.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +42,25 @@ extern "C" {
      */
     void command_sensors_execute(int action_id);
 
+    /**
+     * @brief Execute a sensor text command.
+     *
+     * Forms: `sensor read <channel>`,
+     * `sensor filter <channel> [none | <type> <param> ...]`, which shows or
+     * replaces the filter chain of a channel (see sensor_filter.h), and
+     * `sensor sample <channel> <count> <interval_ms>`, which reports the
+     * minimum, average and maximum of a series of readings. Sampling runs as
+     * an async command (see command_async.h) that waits between readings.
+     *
+     * @param argc Number of arguments.
+     * @param argv Arguments, as produced by input_parser_tokenize().
+     * @param cmd Receives the async command of `sensor sample`.
+     * @return 0 on success, COMMAND_ASYNC_PENDING if @p cmd was set up,
+     *         -EINVAL for invalid arguments, -EBUSY if no async command is
+     *         free, or the error of the sensor driver.
+     */
+    int command_sensors_execute_args(int argc, char **argv, struct command_async **cmd);
+
 #ifdef __cplusplus
 }
 #endif
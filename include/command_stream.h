@@ -0,0 +1,86 @@
+/**
+ * @file command_stream.h
+ * @brief Streaming, chunked command output.
+ *
+ * Description:
+ * ------------
+ * Commands with large outputs (lists, dumps, many-channel status) implement a
+ * resumable producer instead of writing everything at once. The producer is
+ * called repeatedly and fills one chunk per call, keeping its position in the
+ * stream object between calls. command_stream_run() pulls the next chunk only
+ * once the UART TX path has room for it, so the memory needed per response is
+ * one chunk regardless of the output size, and the calling thread sleeps
+ * (letting other work run) while the UART catches up.
+ *
+ * Example producer:
+ * @code
+ *   static int count_next(struct command_stream *stream, char *buf, size_t len)
+ *   {
+ *       if (stream->position == 10) {
+ *           return 0;
+ *       }
+ *       return snprintf(buf, len, "Line %u\r\n", stream->position++);
+ *   }
+ *
+ *   struct command_stream stream = { .next = count_next };
+ *   command_stream_run(&stream);
+ * @endcode
+ *
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#ifndef COMMAND_STREAM_H__
+#define COMMAND_STREAM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct command_stream;
+
+/**
+ * @brief Produce the next chunk of a streamed response.
+ *
+ * @param stream The stream being produced; its position/ctx hold the cursor.
+ * @param buf Buffer receiving the chunk. Only the returned number of bytes
+ *            is sent, so the chunk may hold binary data (NUL bytes included).
+ * @param len Size of buf in bytes (COMMAND_STREAM_CHUNK_SIZE).
+ * @return Number of bytes produced (excluding any NUL), 0 when the stream is
+ *         finished, or a negative error code to abort the stream.
+ */
+typedef int (*command_stream_next_fn)(struct command_stream *stream, char *buf, size_t len);
+
+/**
+ * @brief A resumable producer of command output.
+ */
+struct command_stream {
+	/** Chunk producer (required). */
+	command_stream_next_fn next;
+	/** Producer-specific state. */
+	void *ctx;
+	/** Generic cursor for simple producers, starts at 0. */
+	uint32_t position;
+};
+
+/**
+ * @brief Send a streamed response to the UART.
+ *
+ * Pulls chunks from the producer until it reports completion, waiting for TX
+ * space before each one. An abort (see uart_handler_abort_pending()) stops
+ * the stream before the next chunk is produced.
+ *
+ * @param stream The stream to run.
+ * @return 0 when the whole stream was sent, -ECANCELED on abort, -EAGAIN if
+ *         the TX path stalled, or the producer's negative error code.
+ */
+int command_stream_run(struct command_stream *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_STREAM_H__ */
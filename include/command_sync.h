@@ -0,0 +1,39 @@
+/**
+ * @file command_sync.h
+ * @brief Delta sync command interface.
+ *
+ * Description:
+ * ------------
+ * This header provides the `sync` text command, which returns only the
+ * objects changed since a host-supplied global change sequence number (see
+ * change_seq.h), or a full snapshot if the host is too far behind.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef COMMAND_SYNC_H__
+#define COMMAND_SYNC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Execute a sync text command.
+ *
+ * Form: `sync <since>`, where <since> is the <upto> value of the host's
+ * previous sync reply, or 0 for a full snapshot.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 if the reply was sent, -EINVAL for invalid arguments, or the
+ *         error of the output stream (e.g., -ECANCELED on abort).
+ */
+int command_sync_execute_args(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_SYNC_H__ */
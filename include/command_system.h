@@ -0,0 +1,56 @@
+/**
+ * @file command_system.h
+ * @brief System configuration command interface.
+ *
+ * Description:
+ * ------------
+ * This header provides the entry points for system configuration commands.
+ * The menu path (category=3) shows the current configuration; the text
+ * command path reads and writes individual keys of the config store with
+ * version checks.
+ *
+ * Typical Actions:
+ * ----------------
+ *  action_id=0: Show all configuration keys
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef COMMAND_SYSTEM_H__
+#define COMMAND_SYSTEM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Execute a system configuration menu command.
+ *
+ * @param action_id The system action (0=show configuration).
+ */
+void command_system_execute(int action_id);
+
+/**
+ * @brief Execute a config text command.
+ *
+ * Supported forms (argv[0] is "config"):
+ *   config list
+ *   config get <name>
+ *   config set <name> <value>
+ *   config cas <name> <version> <value>
+ *
+ * Replies are single lines of the form
+ * `[OK|CONFLICT] CONFIG <name>=<value> ver=<v>`.
+ *
+ * @param argc Number of arguments.
+ * @param argv Arguments, as produced by input_parser_tokenize().
+ * @return 0 if the command was understood, or -EINVAL for invalid arguments.
+ */
+int command_system_execute_args(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COMMAND_SYSTEM_H__ */
@@ -9,6 +9,8 @@
 #ifndef COMMANDS_H__
 #define COMMANDS_H__
 
+#include "command_async.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,9 +20,41 @@ extern "C" {
  *
  * @param category Command category (1=Lights, 2=Sensors, 3=System, 4=Diagnostics)
  * @param action_id Specific action within the category.
+ * @return 0 once the command has run, or -ECANCELED if an abort is pending.
  */
 int commands_core_execute(int category, int action_id);
 
+/**
+ * @brief Execute a one-line text command, e.g. "lights get 0".
+ *
+ * The first word selects the command ("lights", "config", ...). The line is
+ * tokenized in place and therefore modified. Lines of the form
+ * "@<address> <id> <command>" are addressed commands and are handed to the
+ * gateway (see command_gateway.h). Async commands (see command_async.h)
+ * are waited for, so this must not be called from the system workqueue.
+ *
+ * @param line The null-terminated command line.
+ * @return 0 if the command ran, -ENOENT if the first word is not a known
+ *         command, -ECANCELED if an abort is pending, or a negative error
+ *         code for invalid arguments.
+ */
+int commands_core_execute_line(char *line);
+
+/**
+ * @brief Execute a one-line text command without waiting for async commands.
+ *
+ * Same as commands_core_execute_line(), except that a command that has to
+ * wait is left running on the system workqueue and reports its result
+ * through @p done, so one caller can keep many slow commands in flight.
+ *
+ * @param line The null-terminated command line (modified).
+ * @param done Completion callback for async commands (may be NULL).
+ * @param user_data Value stored in the async command for the callback.
+ * @return COMMAND_ASYNC_PENDING if @p done will be called, otherwise the
+ *         command's result as for commands_core_execute_line().
+ */
+int commands_core_execute_line_async(char *line, command_async_done_fn done, void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file config_store.h
+ * @brief Versioned runtime configuration values.
+ *
+ * Description:
+ * ------------
+ * The config store holds the runtime-tunable settings of the application as
+ * named integer keys with range checks. Every key carries a version counter
+ * that is incremented on each change, so several hosts can update settings
+ * with optimistic concurrency: a conditional write (compare-and-set) only
+ * applies if the version the host last saw is still current, and otherwise
+ * reports the current value and version in the same round trip.
+ *
+ * Values are persisted through the state journal.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef CONFIG_STORE_H__
+#define CONFIG_STORE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Expected-version value that matches any version (unconditional write). */
+#define CONFIG_STORE_VERSION_ANY 0U
+
+/**
+ * @brief Configuration keys.
+ *
+ * Keys are persisted by number, so existing values must never be renumbered.
+ */
+enum config_key {
+	/** Brightness change per increase/decrease step, in percent. */
+	CONFIG_KEY_BRIGHTNESS_STEP = 0,
+	/** Upper brightness limit for all lights channels, in percent. */
+	CONFIG_KEY_BRIGHTNESS_MAX = 1,
+	/** Brightness of channels that have no persisted state, in percent. */
+	CONFIG_KEY_DEFAULT_LEVEL = 2,
+	/** Lights channel driven by the light regulator. */
+	CONFIG_KEY_REG_CHANNEL = 3,
+	/** Light regulator target illuminance, in lux. */
+	CONFIG_KEY_REG_SETPOINT = 4,
+	/** Proportional gain, in 1/1000 percent per lux of error. */
+	CONFIG_KEY_REG_KP = 5,
+	/** Integral gain, in 1/1000 percent per lux of error and second. */
+	CONFIG_KEY_REG_KI = 6,
+	/** Lowest brightness the regulator may set, in percent. */
+	CONFIG_KEY_REG_MIN_LEVEL = 7,
+	/** Highest brightness the regulator may set, in percent. */
+	CONFIG_KEY_REG_MAX_LEVEL = 8,
+	/** Largest brightness change per second, in percent. */
+	CONFIG_KEY_REG_SLEW = 9,
+	/** Control loop period, in milliseconds. */
+	CONFIG_KEY_REG_PERIOD_MS = 10,
+	/** Errors up to this size are ignored, in lux. */
+	CONFIG_KEY_REG_DEADBAND = 11,
+	/** Address of this unit on a daisy chain, for addressed commands. */
+	CONFIG_KEY_UNIT_ADDRESS = 12,
+	/** 1 to forward commands for other addresses to the downstream UART. */
+	CONFIG_KEY_GATEWAY = 13,
+	/** Lights update coalescing window in milliseconds, 0 to apply at once. */
+	CONFIG_KEY_COALESCE_MS = 14,
+	/** Power of one lights channel at full brightness, in watts (usage energy estimate). */
+	CONFIG_KEY_RATED_W = 15,
+
+	CONFIG_KEY_COUNT
+};
+
+/**
+ * @brief Load persisted values, falling back to defaults.
+ *
+ * Call after state_journal_init().
+ */
+void config_store_init(void);
+
+/**
+ * @brief Read a configuration value and its version.
+ *
+ * @param key The key to read.
+ * @param value Pointer receiving the value.
+ * @param version Optional pointer receiving the version (may be NULL).
+ * @return 0 on success, or -EINVAL for an invalid key or pointer.
+ */
+int config_store_get(enum config_key key, int32_t *value, uint32_t *version);
+
+/**
+ * @brief Convenience accessor returning only the value of a key.
+ *
+ * @param key The key to read.
+ * @return The current value, or 0 for an invalid key.
+ */
+int32_t config_store_value(enum config_key key);
+
+/**
+ * @brief Write a configuration value, optionally conditional on its version.
+ *
+ * @param key The key to write.
+ * @param value The new value; must be within the key's range.
+ * @param expected_version Version the caller last saw, or
+ *        CONFIG_STORE_VERSION_ANY for an unconditional write.
+ * @param current_value Optional pointer receiving the value after the call.
+ * @param current_version Optional pointer receiving the version after the call.
+ * @return 0 if the value was written, -EAGAIN if the version did not match
+ *         (nothing written), or -EINVAL for an invalid key or value.
+ */
+int config_store_set(enum config_key key, int32_t value, uint32_t expected_version,
+		     int32_t *current_value, uint32_t *current_version);
+
+/**
+ * @brief Function notified after a key's value changed.
+ *
+ * Called by the thread that made the change, after the store is unlocked,
+ * so it may read the store and take its own locks. The new value is already
+ * visible to other threads, and observers of concurrent changes may run in
+ * either order: a module that keeps a copy of the value must read the
+ * current value under its own lock rather than trust @p value.
+ *
+ * @param key The key that changed.
+ * @param old_value The value before the change.
+ * @param value The value after the change.
+ */
+typedef void (*config_store_observer_fn)(enum config_key key, int32_t old_value, int32_t value);
+
+/**
+ * @brief Register the function notified of changes of a key.
+ *
+ * A key has at most one observer; registering again replaces it.
+ *
+ * @param key The key to observe.
+ * @param fn The observer, or NULL to remove it.
+ * @return 0 on success, or -EINVAL for an invalid key.
+ */
+int config_store_observe(enum config_key key, config_store_observer_fn fn);
+
+/**
+ * @brief Get the global change sequence number of a key's last change.
+ *
+ * @param key The key.
+ * @return The sequence number (see change_seq.h), or 0 for an invalid key.
+ */
+uint32_t config_store_change_seq(enum config_key key);
+
+/**
+ * @brief Get the name of a key as used by text commands.
+ *
+ * @param key The key.
+ * @return The key name, or NULL for an invalid key.
+ */
+const char *config_store_key_name(enum config_key key);
+
+/**
+ * @brief Look up a key by name.
+ *
+ * @param name The key name.
+ * @return The key, or a negative error code (-ENOENT) if no key has that name.
+ */
+int config_store_key_from_name(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_STORE_H__ */
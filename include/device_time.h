@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file device_time.h
+ * @brief Device time and its offset to the host's time base.
+ *
+ * Description:
+ * ------------
+ * Device time is the microsecond uptime of this unit. Units sharing a host
+ * agree on time through a per-unit offset: host time = device time + offset.
+ * The host estimates the offset of each unit with an NTP-style exchange
+ * (`time sync`), where the unit reports when it received the request and
+ * when it replied, and then sets it with `time offset`. Deadlines sent to
+ * many units (see lights_scene.h) are expressed in host time, so every unit
+ * converts the same value into its own device time.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#ifndef DEVICE_TIME_H__
+#define DEVICE_TIME_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the device time.
+ *
+ * @return Microseconds since boot.
+ */
+int64_t device_time_now_us(void);
+
+/**
+ * @brief Set the offset from device time to host time.
+ *
+ * @param offset_us Host time minus device time, in microseconds.
+ */
+void device_time_set_offset(int64_t offset_us);
+
+/**
+ * @brief Get the offset from device time to host time, 0 until set.
+ */
+int64_t device_time_get_offset(void);
+
+/**
+ * @brief Convert a host time to device time.
+ *
+ * @param host_us Time in the host's time base, in microseconds.
+ * @return The same instant in device time.
+ */
+int64_t device_time_from_host(int64_t host_us);
+
+/**
+ * @brief Convert a device time to host time.
+ *
+ * @param device_us Device time in microseconds.
+ * @return The same instant in the host's time base.
+ */
+int64_t device_time_to_host(int64_t device_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DEVICE_TIME_H__ */
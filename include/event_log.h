@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file event_log.h
+ * @brief Bounded in-RAM log of state change and alarm events.
+ *
+ * Description:
+ * ------------
+ * The event log keeps the last EVENT_LOG_SIZE events (lights changes, config
+ * changes, alarms) in a ring buffer. Every event is stamped with a number from
+ * the global change sequence (change_seq.h), so event numbers increase
+ * monotonically and match the `seq=` values reported by `sync`.
+ *
+ * A host that lost its connection reconnects with the last sequence number it
+ * saw and gets every newer event replayed. If some of those events have
+ * already been overwritten, or belong to an earlier boot, the log reports a
+ * gap so the host knows it must resynchronize (e.g., with `sync 0`).
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef EVENT_LOG_H__
+#define EVENT_LOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Kinds of events.
+ */
+enum event_type {
+	/** Lights channel changed: id=channel, value=level, aux=on. */
+	EVENT_LIGHTS = 0,
+	/** Config key changed: id=key, value=value, aux=version. */
+	EVENT_CONFIG = 1,
+	/** Alarm raised: id=alarm source, value=measured value, aux=threshold. */
+	EVENT_ALARM = 2,
+};
+
+/**
+ * @brief Sources of EVENT_ALARM events.
+ */
+enum event_alarm_source {
+	/** A sensor channel started failing: value=error code, aux=channel. */
+	EVENT_ALARM_SENSOR_FAILED = 0,
+	/** The regulator output hit a limit: value=measured milli-lux, aux=setpoint. */
+	EVENT_ALARM_REG_SATURATED = 1,
+};
+
+/**
+ * @brief One logged event.
+ */
+struct event_record {
+	/** Global change sequence number. */
+	uint32_t seq;
+	/** Uptime when the event was recorded, in milliseconds. */
+	uint32_t timestamp_ms;
+	/** enum event_type. */
+	uint16_t type;
+	/** Object the event refers to (channel, key, alarm source). */
+	uint16_t id;
+	/** Type-specific value. */
+	int32_t value;
+	/** Type-specific auxiliary value. */
+	int32_t aux;
+};
+
+/**
+ * @brief Record an event.
+ *
+ * Allocates the next global change sequence number, stores the event
+ * (overwriting the oldest one if the log is full) and returns the number.
+ * Safe to call from interrupt context.
+ *
+ * @param type Event type.
+ * @param id Object the event refers to.
+ * @param value Type-specific value.
+ * @param aux Type-specific auxiliary value.
+ * @return The sequence number assigned to the event.
+ */
+uint32_t event_log_record(enum event_type type, uint16_t id, int32_t value, int32_t aux);
+
+/**
+ * @brief Find the first event newer than a sequence number.
+ *
+ * @param seq Sequence number the caller has already seen.
+ * @param event Pointer receiving a copy of the event.
+ * @return 0 if an event was found, or -ENOENT if there is no newer event.
+ */
+int event_log_next_after(uint32_t seq, struct event_record *event);
+
+/**
+ * @brief Check whether events newer than a sequence number were lost.
+ *
+ * True if an event newer than @p seq has been overwritten, or if @p seq
+ * cannot be trusted as a cursor (see change_seq_is_stale()).
+ *
+ * @param seq Sequence number the caller has already seen.
+ * @return true if replaying from @p seq would miss events.
+ */
+bool event_log_has_gap(uint32_t seq);
+
+/**
+ * @brief Get the number of events currently held.
+ */
+size_t event_log_count(void);
+
+/**
+ * @brief Get an event by position, 0 being the oldest held event.
+ *
+ * @param index Position of the event.
+ * @param event Pointer receiving a copy of the event.
+ * @return 0 on success, or -ENOENT if index is out of range.
+ */
+int event_log_get(size_t index, struct event_record *event);
+
+/**
+ * @brief Format an event as a single line of text (no line ending).
+ *
+ * @param event The event to format.
+ * @param buf Buffer receiving the text.
+ * @param len Size of buf in bytes.
+ * @return Number of characters that would have been written, as snprintf().
+ */
+int event_log_format(const struct event_record *event, char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_LOG_H__ */
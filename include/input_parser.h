@@ -0,0 +1,101 @@
+/**
+ * @file input_parser.h
+ * @brief Parsing helpers for text commands.
+ *
+ * Description:
+ * ------------
+ * Besides the numbered menus, the application accepts one-line text commands
+ * such as `lights cas 2 7 on 40` so that hosts can script the device. This
+ * header provides the small, allocation-free helpers used to split such a
+ * line into arguments and to convert arguments into numbers.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef INPUT_PARSER_H__
+#define INPUT_PARSER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Split a line into whitespace-separated arguments, in place.
+ *
+ * Separators in @p line are overwritten with NUL characters and @p argv is
+ * filled with pointers into @p line.
+ *
+ * @param line The line to split (modified).
+ * @param argv Array receiving the argument pointers.
+ * @param max_args Capacity of argv.
+ * @return Number of arguments, or -E2BIG if the line has more than max_args.
+ */
+int input_parser_tokenize(char *line, char *argv[], int max_args);
+
+/**
+ * @brief Parse a signed decimal integer.
+ *
+ * @param str The argument to parse; the whole string must be a number.
+ * @param value Pointer receiving the parsed value.
+ * @return 0 on success, or -EINVAL if str is not a valid 32-bit integer.
+ */
+int input_parser_parse_int(const char *str, int32_t *value);
+
+/**
+ * @brief Parse a signed 64-bit decimal integer (e.g., a time in microseconds).
+ *
+ * @param str The argument to parse; the whole string must be a number.
+ * @param value Pointer receiving the parsed value.
+ * @return 0 on success, or -EINVAL if str is not a valid 64-bit integer.
+ */
+int input_parser_parse_int64(const char *str, int64_t *value);
+
+/**
+ * @brief Parse an unsigned decimal integer.
+ *
+ * @param str The argument to parse; the whole string must be a number.
+ * @param value Pointer receiving the parsed value.
+ * @return 0 on success, or -EINVAL if str is not a valid 32-bit unsigned integer.
+ */
+int input_parser_parse_uint(const char *str, uint32_t *value);
+
+/**
+ * @brief Parse an on/off argument ("on", "off", "1" or "0").
+ *
+ * @param str The argument to parse.
+ * @param on Pointer receiving true for on, false for off.
+ * @return 0 on success, or -EINVAL for any other string.
+ */
+int input_parser_parse_on_off(const char *str, bool *on);
+
+/**
+ * @brief Compile a channel selector into a bitmask.
+ *
+ * A selector is a comma-separated list of items, each one of:
+ *   - `N`: channel N
+ *   - `N-M`: channels N to M inclusive
+ *   - `gK`: the channels of group K (see @p groups)
+ *   - `*`: all channels
+ * e.g. "0,2,4-7" or "g1,3". Bit N of the result selects channel N.
+ *
+ * @param str The selector to parse.
+ * @param count Number of channels (1-32); higher channels are rejected.
+ * @param groups Channel masks of the groups (may be NULL if @p group_count is 0).
+ * @param group_count Number of entries in @p groups.
+ * @param mask Pointer receiving the selected channels.
+ * @return 0 on success, or -EINVAL for a malformed selector or an unknown
+ *         channel or group.
+ */
+int input_parser_parse_channels(const char *str, unsigned int count, const uint32_t *groups,
+				size_t group_count, uint32_t *mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INPUT_PARSER_H__ */
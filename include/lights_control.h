@@ -12,6 +12,22 @@
  * It provides function prototypes for turning lights on/off, adjusting 
  * brightness levels, and querying their current state.
  *
+ * The simple functions act on channel 0. The channel functions address any of
+ * LIGHTS_CHANNEL_COUNT channels and expose a per-channel version counter for
+ * conditional (compare-and-set) updates.
+ *
+ * Changes take effect in the channel state immediately. With the
+ * `coalesce_ms` config key set, the hardware outputs are committed once per
+ * window, so a burst of writes to a channel only drives its last value.
+ *
+ * lights_control_set_channels() changes any set of channels (a bitmask, e.g.
+ * compiled from a selector by input_parser_parse_channels()) in one pass
+ * with a single output commit. Channel groups are stored masks that
+ * selectors can refer to.
+ *
+ * Each channel also accumulates usage counters (on-time, brightness-weighted
+ * duty, switch cycles and an energy estimate) for maintenance planning.
+ *
  * @author Ameed Othman
  * @date 2024-12-20
  */
@@ -20,13 +36,63 @@
 #define LIGHTS_CONTROL_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <zephyr/kernel.h>  /* For return types like int */
+#include "app_config.h"
 
 /* C++ support */
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Expected-version value that matches any version (unconditional write). */
+#define LIGHTS_VERSION_ANY 0U
+
+/** Level for lights_control_set_channels() that keeps each channel's level. */
+#define LIGHTS_LEVEL_KEEP (-1)
+
+/**
+ * @brief Snapshot of one lights channel.
+ */
+struct lights_channel_state {
+	/** True if the channel is ON. */
+	bool on;
+	/** Brightness level, 0-100%. */
+	int level;
+	/** Change counter, starts at change_seq_first_version() and increments on every change. */
+	uint32_t version;
+	/** Global change sequence number of the last change (see change_seq.h). */
+	uint32_t change_seq;
+};
+
+/**
+ * @brief Lights write and commit counters since boot.
+ */
+struct lights_control_stats {
+	/** Changes applied to channel states. */
+	uint32_t writes;
+	/** Changes superseded by a later one within the same coalescing window. */
+	uint32_t coalesced;
+	/** Hardware commits (one per window, or one per change without coalescing). */
+	uint32_t commits;
+	/** Channels currently waiting for a commit. */
+	uint32_t pending;
+};
+
+/**
+ * @brief Cumulative usage of one lights channel.
+ */
+struct lights_channel_usage {
+	/** Time switched on, in milliseconds. */
+	uint64_t on_ms;
+	/** On-time weighted by brightness (time at 100% for the same output), in ms. */
+	uint64_t duty_ms;
+	/** Estimated energy from the `rated_w` config key, in milliwatt-hours. */
+	uint64_t energy_mwh;
+	/** Off-to-on switch cycles. */
+	uint32_t cycles;
+};
+
 /**
  * @brief Initialize the lights control subsystem.
  *
@@ -95,6 +161,143 @@ int lights_control_decrease_brightness(void);
  */
 int lights_control_get_state(bool *state, int *level);
 
+/**
+ * @brief Retrieve the state and version of one channel.
+ *
+ * @param channel Channel index, below LIGHTS_CHANNEL_COUNT.
+ * @param state Pointer receiving a snapshot of the channel.
+ *
+ * @return 0 on success, or -EINVAL for an invalid channel or pointer.
+ */
+int lights_control_get_channel(unsigned int channel, struct lights_channel_state *state);
+
+/**
+ * @brief Set the state of one channel, optionally conditional on its version.
+ *
+ * With @p expected_version set to the version last read by the caller, the
+ * write is only applied if no one else changed the channel in the meantime
+ * (optimistic concurrency). Either way @p current receives the resulting
+ * state, so a rejected caller learns the new state in the same call. The
+ * level is limited to the configured maximum brightness.
+ *
+ * @param channel Channel index, below LIGHTS_CHANNEL_COUNT.
+ * @param on New ON/OFF state.
+ * @param level New brightness level (0-100).
+ * @param expected_version Version the caller last saw, or LIGHTS_VERSION_ANY.
+ * @param current Optional pointer receiving the channel state after the call.
+ *
+ * @return 0 if applied, -EAGAIN if the version did not match (nothing
+ *         changed), or -EINVAL for invalid parameters.
+ */
+int lights_control_set_channel(unsigned int channel, bool on, int level,
+			       uint32_t expected_version, struct lights_channel_state *current);
+
+/**
+ * @brief Set several channels at once.
+ *
+ * All channels in @p mask are updated under one lock and committed to the
+ * outputs together (one commit, or one coalescing window). Each changed
+ * channel gets a new version as with lights_control_set_channel().
+ *
+ * @param mask Channels to set (bit N selects channel N).
+ * @param on New ON/OFF state.
+ * @param level New brightness level (0-100), or LIGHTS_LEVEL_KEEP.
+ * @return Number of channels that changed, or -EINVAL for invalid parameters.
+ */
+int lights_control_set_channels(uint32_t mask, bool on, int level);
+
+/**
+ * @brief Define a channel group.
+ *
+ * Groups are persisted in the state journal.
+ *
+ * @param group Group index, below LIGHTS_GROUP_COUNT.
+ * @param mask Channels in the group.
+ * @return 0 on success, or -EINVAL for an invalid group or channel.
+ */
+int lights_control_set_group(unsigned int group, uint32_t mask);
+
+/**
+ * @brief Get the channel masks of all groups.
+ *
+ * @param groups Array receiving LIGHTS_GROUP_COUNT masks.
+ */
+void lights_control_get_groups(uint32_t groups[LIGHTS_GROUP_COUNT]);
+
+/**
+ * @brief Commit coalesced changes to the outputs now.
+ *
+ * Ends the current coalescing window early, so the changes are also handed
+ * to the state journal (e.g., for a scene that must apply at a set time).
+ */
+void lights_control_flush(void);
+
+/**
+ * @brief Take a ticket for the commit that covers every change staged so far.
+ *
+ * Once the commit has run, the changes are on the outputs and appended to
+ * the state journal; a durable acknowledgement then waits for the journal.
+ * Unlike lights_control_flush(), this leaves the coalescing window alone.
+ *
+ * @return The commit number to wait for.
+ */
+uint32_t lights_control_commit_ticket(void);
+
+/**
+ * @brief Check whether the commit of a ticket has run.
+ *
+ * @param ticket Ticket from lights_control_commit_ticket().
+ * @return true once the changes covered by @p ticket are committed.
+ */
+bool lights_control_ticket_committed(uint32_t ticket);
+
+/**
+ * @brief Wait for the commit of a ticket.
+ *
+ * @param ticket Ticket from lights_control_commit_ticket().
+ * @param timeout Maximum time to wait.
+ * @return 0 once committed, or -EAGAIN on timeout.
+ */
+int lights_control_wait_committed(uint32_t ticket, k_timeout_t timeout);
+
+/**
+ * @brief Get the signal raised after every commit.
+ *
+ * Async commands wait on it with command_async_wait_signal(). Since any of
+ * several waiters may reset it, they must also wake up periodically and
+ * re-check their ticket.
+ *
+ * @return The commit signal.
+ */
+struct k_poll_signal *lights_control_commit_signal(void);
+
+/**
+ * @brief Get the usage counters of one channel.
+ *
+ * Counters are updated when the output changes and include the time since
+ * then. They survive resets up to the last periodic save (every
+ * LIGHTS_USAGE_PERSIST_S seconds, see lights_control_save_usage()).
+ *
+ * @param channel Channel index, below LIGHTS_CHANNEL_COUNT.
+ * @param usage Pointer receiving the counters.
+ * @return 0 on success, or -EINVAL for an invalid channel or pointer.
+ */
+int lights_control_get_usage(unsigned int channel, struct lights_channel_usage *usage);
+
+/**
+ * @brief Write the usage counters to the state journal now.
+ *
+ * Only counters that changed since the last save are journaled.
+ */
+void lights_control_save_usage(void);
+
+/**
+ * @brief Get the write and commit counters.
+ *
+ * @param stats Pointer receiving the counters.
+ */
+void lights_control_get_stats(struct lights_control_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file lights_regulator.h
+ * @brief Closed-loop constant-light control.
+ *
+ * Description:
+ * ------------
+ * The lights regulator keeps the illuminance measured by the ambient light
+ * sensor at a setpoint by adjusting the brightness of one lights channel.
+ * It runs a fixed-point PI controller at a fixed rate, with output limits,
+ * a slew-rate limit and an error deadband.
+ *
+ * The tuning parameters are config store keys (`reg_setpoint`, `reg_kp`,
+ * `reg_ki`, `reg_min_level`, `reg_max_level`, `reg_slew`, `reg_period_ms`,
+ * `reg_deadband`, `reg_channel`) and are re-read on every control step, so
+ * `config set` retunes a running loop. The regulator starts disabled after
+ * boot.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef LIGHTS_REGULATOR_H__
+#define LIGHTS_REGULATOR_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Snapshot of the regulator state.
+ */
+struct lights_regulator_status {
+	/** True while the control loop runs. */
+	bool enabled;
+	/** Last measured illuminance, in milli-lux. */
+	int32_t lux_milli;
+	/** Last control error (setpoint - measurement), in milli-lux. */
+	int32_t error_milli;
+	/** Controller output, in 1/1000 percent. */
+	int32_t output_milli;
+	/** Brightness last applied to the lights channel, in percent. */
+	int level;
+	/** Number of control steps since the regulator was enabled. */
+	uint32_t steps;
+};
+
+/**
+ * @brief Enable the control loop.
+ *
+ * The integrator is seeded with the channel's current brightness so that
+ * enabling does not cause a jump (bumpless transfer).
+ *
+ * @return 0 on success, or a negative error code on failure.
+ */
+int lights_regulator_enable(void);
+
+/**
+ * @brief Disable the control loop, leaving the brightness where it is.
+ */
+void lights_regulator_disable(void);
+
+/**
+ * @brief Get a snapshot of the regulator state.
+ *
+ * @param status Pointer receiving the state.
+ */
+void lights_regulator_get_status(struct lights_regulator_status *status);
+
+/**
+ * @brief Run one control step now.
+ *
+ * Called by the periodic work item; exposed so tests can run the loop
+ * step by step against an emulated sensor.
+ *
+ * @return 0 on success, -EAGAIN if the regulator is disabled, or the
+ *         negative error code of the sensor read.
+ */
+int lights_regulator_step(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIGHTS_REGULATOR_H__ */
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file lights_scene.h
+ * @brief Staged lights changes applied together at an absolute time.
+ *
+ * Description:
+ * ------------
+ * A scene is a set of staged channel changes that are applied together at a
+ * deadline in device time (see device_time.h). Hosts stage the changes on
+ * every unit first, then broadcast one commit with a deadline in host time;
+ * each unit converts it with its clock offset, so all units switch at the
+ * same instant however long the commands took to reach them.
+ *
+ * The deadline is served by a one-shot kernel timer armed with an absolute
+ * timeout slightly before it, so nothing polls while waiting; the last
+ * microseconds are busy-waited on a high-priority workqueue. A commit is
+ * never applied early; the lateness of the last commit is reported in the
+ * status.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#ifndef LIGHTS_SCENE_H__
+#define LIGHTS_SCENE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Snapshot of the scene state.
+ */
+struct lights_scene_status {
+	/** Bit mask of channels with a staged change. */
+	uint32_t staged;
+	/** True while a commit is scheduled. */
+	bool armed;
+	/** Device time of the scheduled commit, in microseconds. */
+	int64_t deadline_us;
+	/** Scenes applied since boot. */
+	uint32_t commits;
+	/** Time from the deadline to the end of the last commit, in microseconds. */
+	int64_t last_late_us;
+};
+
+/**
+ * @brief Start the workqueue that applies scenes.
+ *
+ * Call once at startup, before the first lights_scene_commit_at().
+ */
+void lights_scene_init(void);
+
+/**
+ * @brief Stage a change of one channel for the next commit.
+ *
+ * Staging a channel again replaces its staged change.
+ *
+ * @param channel Channel index, below LIGHTS_CHANNEL_COUNT.
+ * @param on ON/OFF state to apply.
+ * @param level Brightness level to apply (0-100).
+ * @return 0 on success, -EINVAL for invalid parameters, or -EBUSY while a
+ *         commit is scheduled.
+ */
+int lights_scene_stage(unsigned int channel, bool on, int level);
+
+/**
+ * @brief Drop all staged changes and cancel a scheduled commit.
+ */
+void lights_scene_clear(void);
+
+/**
+ * @brief Schedule the staged changes to be applied at a deadline.
+ *
+ * Scheduling again moves the deadline. A deadline in the past applies the
+ * changes at once.
+ *
+ * @param deadline_us Deadline in device time, in microseconds.
+ * @return 0 on success, or -ENODATA if nothing is staged.
+ */
+int lights_scene_commit_at(int64_t deadline_us);
+
+/**
+ * @brief Get a snapshot of the scene state.
+ *
+ * @param status Pointer receiving the state.
+ */
+void lights_scene_get_status(struct lights_scene_status *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIGHTS_SCENE_H__ */
@@ -14,6 +14,8 @@
 #ifndef MENU_DISPLAY_H__
 #define MENU_DISPLAY_H__
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,6 +37,17 @@ void menu_display_show_main_menu(void);
  */
 void menu_display_message(const char *msg);
 
+/**
+ * @brief Print a message of known length, followed by a line break.
+ *
+ * @param msg The message; may contain NUL bytes.
+ * @param len Length of the message in bytes.
+ */
+void menu_display_write_message(const char *msg, size_t len);
+
+/** Print a string literal message, with its length taken at compile time. */
+#define menu_display_message_literal(lit) menu_display_write_message("" lit, sizeof(lit) - 1)
+
 /**
  * @brief Print an error message indicating invalid input or similar conditions.
  *
@@ -44,6 +57,17 @@ void menu_display_message(const char *msg);
  */
 void menu_display_error(const char *err_msg);
 
+/**
+ * @brief Print an error message of known length.
+ *
+ * @param err_msg The message; may contain NUL bytes.
+ * @param len Length of the message in bytes.
+ */
+void menu_display_write_error(const char *err_msg, size_t len);
+
+/** Print a string literal error message, with its length taken at compile time. */
+#define menu_display_error_literal(lit) menu_display_write_error("" lit, sizeof(lit) - 1)
+
 #ifdef __cplusplus
 }
 #endif
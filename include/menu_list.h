@@ -0,0 +1,114 @@
+/**
+ * @file menu_list.h
+ * @brief Paged menus for large dynamic lists.
+ * 
+ * Description:
+ * ------------
+ * A dynamic list menu does not hold its entries. Instead it is backed by two
+ * callbacks: one returning the current number of entries, and one formatting
+ * a single entry by index on demand. Only the entries on the visible page are
+ * ever formatted, and each one is written to the UART as soon as it is
+ * produced, so the cost of a redraw depends on the page size and not on the
+ * length of the list.
+ *
+ * Navigation inside a list menu:
+ *   n        next page
+ *   p        previous page
+ *   j <page> jump to a page (1-based)
+ *   <number> select an entry (1-based), if the list supports selection
+ *   0        return to the calling menu
+ * 
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#ifndef MENU_LIST_H__
+#define MENU_LIST_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Return the current number of entries in the list.
+ *
+ * @param ctx The list's user context.
+ */
+typedef size_t (*menu_list_count_fn)(void *ctx);
+
+/**
+ * @brief Format one entry of the list.
+ *
+ * @param index Zero-based index of the entry, always below the current count.
+ * @param buf Buffer receiving the null-terminated entry text (no line ending).
+ * @param len Size of buf in bytes.
+ * @param ctx The list's user context.
+ * @return 0 on success, or a negative error code to skip the entry.
+ */
+typedef int (*menu_list_format_fn)(size_t index, char *buf, size_t len, void *ctx);
+
+/**
+ * @brief Handle selection of an entry.
+ *
+ * @param index Zero-based index of the selected entry.
+ * @param ctx The list's user context.
+ */
+typedef void (*menu_list_select_fn)(size_t index, void *ctx);
+
+/**
+ * @brief Description of a dynamic list menu node.
+ */
+struct menu_list {
+	/** Title printed above every page. */
+	const char *title;
+	/** Entry count callback (required). */
+	menu_list_count_fn count;
+	/** Entry formatting callback (required). */
+	menu_list_format_fn format;
+	/** Selection callback, or NULL for a read-only list. */
+	menu_list_select_fn select;
+	/** Opaque pointer passed to every callback. */
+	void *ctx;
+	/** Entries per page, or 0 for MENU_LIST_PAGE_SIZE. */
+	size_t page_size;
+};
+
+/**
+ * @brief Get the number of pages of a list.
+ *
+ * An empty list still has one (empty) page.
+ *
+ * @param list The list to inspect.
+ * @return Number of pages, at least 1.
+ */
+size_t menu_list_page_count(const struct menu_list *list);
+
+/**
+ * @brief Render one page of a list to the UART.
+ *
+ * Only the entries of the requested page are formatted. The page index is
+ * clamped to the last page.
+ *
+ * @param list The list to render.
+ * @param page Zero-based page index.
+ * @return Number of entries rendered, or a negative error code.
+ */
+int menu_list_render_page(const struct menu_list *list, size_t page);
+
+/**
+ * @brief Run the interactive loop for a list menu.
+ *
+ * Renders the first page and processes navigation input from `uart_msgq`
+ * until the user returns with "0" or an abort is received.
+ *
+ * @param list The list to browse.
+ */
+void menu_list_run(const struct menu_list *list);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MENU_LIST_H__ */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file sensor_filter.h
+ * @brief Fixed-point streaming filters for sensor samples.
+ *
+ * Description:
+ * ------------
+ * A sensor filter processes one integer sample at a time and either emits a
+ * filtered value or withholds the sample. Filters are chained per sensor
+ * channel; a sample only leaves the chain if every stage emits it.
+ *
+ * Filter types (parameter in brackets):
+ *   median [N]:    median of the last N samples, rejects spikes. O(N).
+ *   ewma [alpha]:  y += (x - y) * alpha / 256, alpha 1-256. O(1).
+ *   average [N]:   mean of the last N samples. O(1).
+ *   decimate [N]:  emits every Nth sample (N up to 10000), withholds the
+ *                  others. O(1).
+ *   deadband [D]:  emits a sample only if it differs from the last emitted
+ *                  one by more than D. O(1).
+ *
+ * Window sizes are limited to SENSOR_FILTER_WINDOW_MAX samples.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef SENSOR_FILTER_H__
+#define SENSOR_FILTER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "app_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Filter types.
+ */
+enum sensor_filter_type {
+	SENSOR_FILTER_NONE = 0,
+	SENSOR_FILTER_MEDIAN,
+	SENSOR_FILTER_EWMA,
+	SENSOR_FILTER_AVERAGE,
+	SENSOR_FILTER_DECIMATE,
+	SENSOR_FILTER_DEADBAND,
+
+	SENSOR_FILTER_TYPE_COUNT
+};
+
+/**
+ * @brief Type and parameter of one filter stage.
+ */
+struct sensor_filter_config {
+	enum sensor_filter_type type;
+	int32_t param;
+};
+
+/**
+ * @brief One filter stage and its state.
+ *
+ * The window holds the last samples in arrival order (median, average); the
+ * sorted copy is kept for the median. acc is the EWMA value in Q8 or the
+ * window sum; last is the last emitted value (deadband) and counter the
+ * position in the decimation cycle.
+ */
+struct sensor_filter {
+	struct sensor_filter_config config;
+	int32_t window[SENSOR_FILTER_WINDOW_MAX];
+	int32_t sorted[SENSOR_FILTER_WINDOW_MAX];
+	uint8_t count;
+	uint8_t pos;
+	int64_t acc;
+	int32_t last;
+	int32_t counter;
+	bool primed;
+};
+
+/**
+ * @brief Chain of filter stages applied in order.
+ */
+struct sensor_filter_chain {
+	struct sensor_filter stages[SENSOR_FILTER_STAGES_MAX];
+	size_t count;
+};
+
+/**
+ * @brief Configure a filter stage and clear its state.
+ *
+ * @param filter The stage to configure.
+ * @param config Filter type and parameter.
+ * @return 0 on success, or -EINVAL if the parameter is out of range.
+ */
+int sensor_filter_init(struct sensor_filter *filter, const struct sensor_filter_config *config);
+
+/**
+ * @brief Feed one sample to a filter stage.
+ *
+ * @param filter The stage.
+ * @param in The input sample.
+ * @param out Pointer receiving the output if one is emitted.
+ * @return 0 if a value was emitted, or -EAGAIN if the sample was withheld.
+ */
+int sensor_filter_process(struct sensor_filter *filter, int32_t in, int32_t *out);
+
+/**
+ * @brief Replace the stages of a chain.
+ *
+ * The chain is left unchanged if any stage is invalid.
+ *
+ * @param chain The chain.
+ * @param configs Stage configurations, in processing order.
+ * @param count Number of stages (0 clears the chain).
+ * @return 0 on success, or -EINVAL for too many or invalid stages.
+ */
+int sensor_filter_chain_set(struct sensor_filter_chain *chain,
+			    const struct sensor_filter_config *configs, size_t count);
+
+/**
+ * @brief Feed one sample through every stage of a chain.
+ *
+ * @param chain The chain.
+ * @param in The input sample.
+ * @param out Pointer receiving the output if one is emitted.
+ * @return 0 if a value was emitted, or -EAGAIN if a stage withheld it.
+ */
+int sensor_filter_chain_process(struct sensor_filter_chain *chain, int32_t in, int32_t *out);
+
+/**
+ * @brief Get the name of a filter type (e.g., "median").
+ *
+ * @return The name, or NULL for an invalid type.
+ */
+const char *sensor_filter_type_name(enum sensor_filter_type type);
+
+/**
+ * @brief Look up a filter type by name.
+ *
+ * @return The type, or -EINVAL if the name is unknown.
+ */
+int sensor_filter_type_from_name(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_FILTER_H__ */
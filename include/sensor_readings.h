@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file sensor_readings.h
+ * @brief Public interface for reading the application's sensors.
+ *
+ * Description:
+ * ------------
+ * This header defines the sensor readings driver. It exposes a small set of
+ * sensor channels (temperature, humidity, ambient light) as fixed-point
+ * integers in milli-units, independent of the sensor hardware behind them.
+ *
+ * Each channel is backed by a Zephyr sensor device found through a
+ * devicetree alias. Channels without a device fall back to an emulated value
+ * that can be set with sensor_readings_emul_set(), which lets native_sim
+ * builds and tests run the sensor-driven features without hardware.
+ *
+ * A periodic sampler feeds every channel through a per-channel chain of
+ * streaming filters (median, EWMA, moving average, decimation, deadband; see
+ * sensor_filter.h). Consumers read the last filtered value, so they only see
+ * clean and reduced data and never disturb each other's filter state.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef SENSOR_READINGS_H__
+#define SENSOR_READINGS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sensor channels provided by the driver.
+ */
+enum sensor_readings_channel {
+	/** Temperature in milli-degrees Celsius (alias `ambient-temp0`). */
+	SENSOR_READINGS_TEMPERATURE = 0,
+	/** Relative humidity in milli-percent (alias `ambient-temp0`). */
+	SENSOR_READINGS_HUMIDITY = 1,
+	/** Illuminance in milli-lux (alias `ambient-light0`). */
+	SENSOR_READINGS_AMBIENT_LIGHT = 2,
+
+	SENSOR_READINGS_COUNT
+};
+
+/**
+ * @brief Initialize the sensor readings driver.
+ *
+ * Checks which sensor devices are ready; channels without a ready device
+ * use their emulated value. Takes a first sample of every channel and starts
+ * the periodic sampler (every SENSOR_SAMPLE_INTERVAL_MS).
+ *
+ * @return 0 on success, or a negative error code on failure.
+ */
+int sensor_readings_init(void);
+
+/**
+ * @brief Sample every channel once and feed the samples to the filter chains.
+ *
+ * Called by the periodic sampler. Tests call it directly to feed the chains
+ * at a known rate; other consumers must use sensor_readings_get().
+ */
+void sensor_readings_sample(void);
+
+/**
+ * @brief Get the current (last filtered) value of a channel.
+ *
+ * Does not take a sample, so any number of consumers can poll without
+ * changing the filter state.
+ *
+ * @param channel The channel to read.
+ * @param value Pointer receiving the value in milli-units.
+ * @param updates Optional pointer receiving the number of values the filter
+ *                chain has emitted; it changes whenever a new value arrives.
+ * @return 0 on success, -ENODATA if no value was emitted yet, -EINVAL for an
+ *         invalid channel or pointer, or the negative error code of the last
+ *         sample if the sensor device failed.
+ */
+int sensor_readings_get(enum sensor_readings_channel channel, int32_t *value, uint32_t *updates);
+
+/**
+ * @brief Get the global change sequence number of a channel's last change.
+ *
+ * A channel changes when its filtered value differs from the previous one or
+ * when its device starts or stops failing.
+ *
+ * @param channel The channel.
+ * @return The sequence number (see change_seq.h), or 0 for an invalid channel
+ *         or a channel that was never sampled.
+ */
+uint32_t sensor_readings_change_seq(enum sensor_readings_channel channel);
+
+/**
+ * @brief Replace the filter chain of a channel.
+ *
+ * The filter state is cleared. An invalid stage leaves the chain unchanged.
+ *
+ * @param channel The channel to configure.
+ * @param configs Filter stages in processing order.
+ * @param count Number of stages, up to SENSOR_FILTER_STAGES_MAX (0 disables
+ *              filtering).
+ * @return 0 on success, or -EINVAL for an invalid channel or stage.
+ */
+int sensor_readings_set_filters(enum sensor_readings_channel channel,
+				const struct sensor_filter_config *configs, size_t count);
+
+/**
+ * @brief Get the filter chain of a channel.
+ *
+ * @param channel The channel to query.
+ * @param configs Array receiving the stages.
+ * @param max Size of configs.
+ * @return Number of stages copied, or -EINVAL for an invalid channel.
+ */
+int sensor_readings_get_filters(enum sensor_readings_channel channel,
+				struct sensor_filter_config *configs, size_t max);
+
+/**
+ * @brief Get the name of a channel (e.g., "ambient_light").
+ *
+ * @return The name, or NULL for an invalid channel.
+ */
+const char *sensor_readings_channel_name(enum sensor_readings_channel channel);
+
+/**
+ * @brief Look up a channel by name.
+ *
+ * @return The channel, or -EINVAL if the name is unknown.
+ */
+int sensor_readings_channel_from_name(const char *name);
+
+/**
+ * @brief Check whether a channel is served by its emulated value.
+ *
+ * @param channel The channel to check.
+ * @return true if the channel has no sensor device.
+ */
+bool sensor_readings_is_emulated(enum sensor_readings_channel channel);
+
+/**
+ * @brief Set the value returned by an emulated channel.
+ *
+ * @param channel The channel to set.
+ * @param value The value in milli-units.
+ * @return 0 on success, -EINVAL for an invalid channel, or -ENOTSUP if the
+ *         channel is backed by a sensor device.
+ */
+int sensor_readings_emul_set(enum sensor_readings_channel channel, int32_t value);
+
+/**
+ * @brief Get the temperature in whole degrees Celsius.
+ *
+ * @param celsius Receives the temperature (may be negative).
+ * @return 0 on success, or the error of sensor_readings_get().
+ */
+int sensor_readings_get_temperature(int *celsius);
+
+/**
+ * @brief Get the relative humidity in whole percent.
+ *
+ * @param percent Receives the humidity.
+ * @return 0 on success, or the error of sensor_readings_get().
+ */
+int sensor_readings_get_humidity(int *percent);
+
+/**
+ * @brief Get the ambient light level in whole lux.
+ *
+ * @param lux Receives the illuminance.
+ * @return 0 on success, or the error of sensor_readings_get().
+ */
+int sensor_readings_get_ambient_light(int *lux);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSOR_READINGS_H__ */
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file state_journal.h
+ * @brief Write-ahead journal of persistent application state.
+ *
+ * Description:
+ * ------------
+ * The state journal keeps a small table of integer values (lights on/off,
+ * brightness, ...) persistent across power loss. Changes are appended to an
+ * in-RAM batch and written to the `storage_partition` flash area together
+ * (group commit) when the commit window expires or the batch fills up.
+ * Callers that must not acknowledge a change before it is durable can wait
+ * for the commit with state_journal_wait_committed().
+ *
+ * At boot, state_journal_init() replays the last checkpoint and the records
+ * appended after it. When the active half of the flash area fills up, the
+ * journal is compacted into a fresh checkpoint in the other half.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#ifndef STATE_JOURNAL_H__
+#define STATE_JOURNAL_H__
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of lights channels the key layout reserves room for. */
+#define STATE_JOURNAL_LIGHTS_CHANNELS 32
+
+/** Number of configuration keys the key layout reserves room for. */
+#define STATE_JOURNAL_CONFIG_KEYS 16
+
+/** Number of usage counters kept per lights channel. */
+#define STATE_JOURNAL_USAGE_FIELDS 4
+
+/** Number of lights channel groups the key layout reserves room for. */
+#define STATE_JOURNAL_LIGHTS_GROUPS 8
+
+/**
+ * @brief Keys of the persistent values.
+ *
+ * Keys are stored on flash, so existing values must never be renumbered.
+ * Lights channel 0 keeps the original single-channel keys; channels 1 and up
+ * use two keys each starting at STATE_KEY_LIGHTS_CHANNEL_BASE.
+ */
+enum state_journal_key {
+	STATE_KEY_LIGHTS_ON = 0,
+	STATE_KEY_LIGHTS_LEVEL = 1,
+	STATE_KEY_LIGHTS_CHANNEL_BASE = 2,
+	STATE_KEY_CONFIG_BASE = STATE_KEY_LIGHTS_CHANNEL_BASE + 2 * (STATE_JOURNAL_LIGHTS_CHANNELS - 1),
+	STATE_KEY_BOOT_COUNT = STATE_KEY_CONFIG_BASE + STATE_JOURNAL_CONFIG_KEYS,
+	STATE_KEY_USAGE_BASE = STATE_KEY_BOOT_COUNT + 1,
+	STATE_KEY_LIGHTS_GROUP_BASE = STATE_KEY_USAGE_BASE +
+				      STATE_JOURNAL_USAGE_FIELDS * STATE_JOURNAL_LIGHTS_CHANNELS,
+	STATE_KEY_USAGE_ENERGY_MWH_BASE = STATE_KEY_LIGHTS_GROUP_BASE + STATE_JOURNAL_LIGHTS_GROUPS,
+
+	STATE_KEY_COUNT = STATE_KEY_USAGE_ENERGY_MWH_BASE + STATE_JOURNAL_LIGHTS_CHANNELS
+};
+
+/**
+ * @brief Usage counters of a lights channel, in their persisted units.
+ */
+enum state_journal_usage_field {
+	/** Time switched on, in seconds. */
+	STATE_USAGE_ON_S = 0,
+	/** Time at full brightness with the same light output, in seconds. */
+	STATE_USAGE_DUTY_S = 1,
+	/** Off-to-on switch cycles. */
+	STATE_USAGE_CYCLES = 2,
+	/** Estimated energy, in whole watt-hours (see STATE_KEY_USAGE_ENERGY_MWH_CH()). */
+	STATE_USAGE_ENERGY_WH = 3,
+};
+
+/** Journal key of the on/off state of a lights channel. */
+#define STATE_KEY_LIGHTS_ON_CH(ch) \
+	((ch) == 0 ? STATE_KEY_LIGHTS_ON : STATE_KEY_LIGHTS_CHANNEL_BASE + 2 * ((ch) - 1))
+
+/** Journal key of the brightness level of a lights channel. */
+#define STATE_KEY_LIGHTS_LEVEL_CH(ch) \
+	((ch) == 0 ? STATE_KEY_LIGHTS_LEVEL : STATE_KEY_LIGHTS_CHANNEL_BASE + 2 * ((ch) - 1) + 1)
+
+/** Journal key of a usage counter of a lights channel. */
+#define STATE_KEY_USAGE_CH(ch, field) \
+	(STATE_KEY_USAGE_BASE + STATE_JOURNAL_USAGE_FIELDS * (ch) + (field))
+
+/**
+ * Journal key of the energy of a lights channel below one watt-hour, in
+ * milliwatt-hours (0-999). Kept apart from STATE_USAGE_ENERGY_WH so existing
+ * keys are not renumbered and the watt-hour counter keeps its range; both are
+ * appended together with state_journal_append_batch().
+ */
+#define STATE_KEY_USAGE_ENERGY_MWH_CH(ch) (STATE_KEY_USAGE_ENERGY_MWH_BASE + (ch))
+
+/** Journal key of the channel mask of a lights group. */
+#define STATE_KEY_LIGHTS_GROUP(group) (STATE_KEY_LIGHTS_GROUP_BASE + (group))
+
+/** Journal key of a configuration value. */
+#define STATE_KEY_CONFIG(key) (STATE_KEY_CONFIG_BASE + (key))
+
+/**
+ * @brief Open the flash area and replay the journal.
+ *
+ * Must be called before any other state journal function, and before the
+ * modules whose state is journaled are initialized. Calling it again drops
+ * uncommitted changes and reloads the state from flash.
+ *
+ * @return 0 on success, or a negative error code if the flash area is unusable.
+ */
+int state_journal_init(void);
+
+/**
+ * @brief Read the last recorded value of a key.
+ *
+ * @param key The key to look up.
+ * @param value Pointer receiving the value.
+ * @return 0 on success, -ENOENT if the key was never recorded, -EINVAL for an
+ *         invalid key or pointer, or -ENODEV if the journal is not initialized.
+ */
+int state_journal_get(uint16_t key, int32_t *value);
+
+/**
+ * @brief Record a new value for a key.
+ *
+ * The value is visible to state_journal_get() immediately and is written to
+ * flash with the next group commit.
+ *
+ * @param key The key to update.
+ * @param value The new value.
+ * @return 0 on success, -EINVAL for an invalid key, or -ENODEV if the journal
+ *         is not initialized.
+ */
+int state_journal_append(uint16_t key, int32_t value);
+
+/**
+ * @brief One key update of state_journal_append_batch().
+ */
+struct state_journal_update {
+	uint16_t key;
+	int32_t value;
+};
+
+/**
+ * @brief Record new values for several keys in the same group commit.
+ *
+ * For values that are only meaningful together (e.g., whole and sub-unit
+ * parts of one counter): the records are queued under one lock, after
+ * committing the pending batch first if they would not fit, so a commit
+ * never writes one without the others.
+ *
+ * @param updates The keys and their new values.
+ * @param count Number of updates, at most STATE_JOURNAL_BATCH_MAX.
+ * @return 0 on success, -EINVAL for an invalid key or count (nothing is
+ *         recorded), or -ENODEV if the journal is not initialized.
+ */
+int state_journal_append_batch(const struct state_journal_update *updates, size_t count);
+
+/**
+ * @brief Wait until every change appended so far is on flash.
+ *
+ * @param timeout Maximum time to wait for the commit.
+ * @return 0 once committed, -EAGAIN on timeout, -ENODEV if the journal is not
+ *         initialized, or the negative error code of a failed flash write.
+ */
+int state_journal_wait_committed(k_timeout_t timeout);
+
+/**
+ * @brief Take a ticket for every change appended so far.
+ *
+ * The non-blocking form of state_journal_wait_committed(): check the ticket
+ * with state_journal_ticket_committed() after each commit signal.
+ *
+ * @return The journal position of the last appended change.
+ */
+uint32_t state_journal_ticket(void);
+
+/**
+ * @brief Check whether the changes covered by a ticket are on flash.
+ *
+ * @param ticket Ticket from state_journal_ticket().
+ * @return 0 if committed, -EAGAIN if not yet, -ENODEV if the journal is not
+ *         initialized, or the negative error code of a failed flash write.
+ */
+int state_journal_ticket_committed(uint32_t ticket);
+
+/**
+ * @brief Get the signal raised after every commit attempt.
+ *
+ * Async commands wait on it with command_async_wait_signal(). Since any of
+ * several waiters may reset it, they must also wake up periodically and
+ * re-check their ticket.
+ *
+ * @return The commit signal; its result is that of the commit.
+ */
+struct k_poll_signal *state_journal_commit_signal(void);
+
+/**
+ * @brief Commit pending changes now instead of waiting for the window.
+ *
+ * @return 0 on success, or a negative error code on flash failure.
+ */
+int state_journal_commit(void);
+
+/**
+ * @brief Rewrite the journal as a fresh checkpoint.
+ *
+ * Happens automatically when the active half of the flash area passes
+ * STATE_JOURNAL_COMPACT_PCT, but can also be requested explicitly.
+ *
+ * @return 0 on success, or a negative error code on flash failure.
+ */
+int state_journal_compact(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATE_JOURNAL_H__ */
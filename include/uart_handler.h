@@ -11,7 +11,9 @@
  * The UART handler is responsible for:
  *   - Initializing the UART interface with interrupt-driven reception.
  *   - Providing a message queue from which complete input lines can be retrieved.
- *   - Offering utility functions to write strings to the UART output.
+ *   - Offering sized (binary-safe) and string writes to the UART output.
+ *   - Detecting Ctrl-C / break on RX and aborting pending output.
+ *   - Coalescing small writes into fewer, larger TX transfers.
  *
  * Other modules can interact with the UART via these functions, enabling line-based
  * command parsing and interactive menus over UART.
@@ -23,12 +25,27 @@
 #ifndef UART_HANDLER_H__
 #define UART_HANDLER_H__
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <zephyr/kernel.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief TX transfer counters since boot.
+ */
+struct uart_handler_tx_stats {
+	/** Calls that queued output. */
+	uint32_t writes;
+	/** Transfers started on an idle transmitter. */
+	uint32_t transfers;
+	/** Transfers started by the coalescing or cork deadline. */
+	uint32_t deadline_flushes;
+};
+
 /**
  * @brief Initialize the UART subsystem.
  *
@@ -40,19 +57,163 @@ extern "C" {
  */
 int uart_handler_init(void);
 
+/**
+ * @brief Write @p len bytes to the UART output.
+ *
+ * Queues the data in the TX ring buffer, which is drained by the UART TX
+ * interrupt. Blocks while the ring buffer is full. While an abort is
+ * pending (see uart_handler_abort_pending()) the output is discarded.
+ * The data is sent as is, so it may contain NUL bytes.
+ *
+ * @param data Bytes to send.
+ * @param len Number of bytes.
+ * @return 0 on success, -ECANCELED if an abort is pending, or -EINVAL on
+ *         invalid parameters.
+ */
+int uart_handler_write(const void *data, size_t len);
+
+/**
+ * @brief Write a string literal, with its length taken at compile time.
+ *
+ * Only accepts literals (e.g., `uart_handler_write_literal("OK\r\n")`).
+ */
+#define uart_handler_write_literal(lit) uart_handler_write("" lit, sizeof(lit) - 1)
+
+/**
+ * @brief Write a buffer filled by snprintf().
+ *
+ * @param buf The buffer.
+ * @param size Size of the buffer.
+ * @param len Return value of snprintf(); a truncated result is limited to
+ *            the @p size - 1 bytes actually in the buffer.
+ * @return As for uart_handler_write().
+ */
+static inline int uart_handler_write_formatted(const char *buf, size_t size, int len)
+{
+	if (len < 0) {
+		return -EINVAL;
+	}
+	return uart_handler_write(buf, MIN((size_t)len, size - 1));
+}
+
 /**
  * @brief Write a null-terminated string to the UART output.
  *
- * Sends the given string over UART using polling mode. This function is
- * best used for relatively short messages, such as prompts, logging messages,
- * or status updates. For large amounts of data, consider implementing a
- * buffered or DMA-based solution.
+ * Same as uart_handler_write() with the length from strlen(). For strings
+ * whose length is not known up front; literals and formatted buffers use
+ * uart_handler_write_literal() and uart_handler_write_formatted().
  *
  * @param str A null-terminated string to send.
- * @return 0 on success, or a negative error code on invalid parameters.
+ * @return 0 on success, -ECANCELED if an abort is pending, or -EINVAL on
+ *         invalid parameters.
  */
 int uart_handler_write_string(const char *str);
 
+/**
+ * @brief Tag every line written by the calling thread.
+ *
+ * While a tag is set, uart_handler_write*() calls made by the thread
+ * that set it insert the tag at the start of every output line. Output of
+ * other threads is not affected. Up to UART_REPLY_TAG_SLOTS threads can have
+ * a tag at the same time. Used to frame the reply of an addressed
+ * command (see command_gateway.h).
+ *
+ * @param tag Text inserted at each line start; must remain valid until the
+ *            tag is cleared. NULL clears the tag.
+ */
+void uart_handler_reply_tag_set(const char *tag);
+
+/**
+ * @brief Get the reply tag of the calling thread.
+ *
+ * Lets work that continues a command on another thread carry its tag along
+ * (see command_async.h).
+ *
+ * @return The tag, or NULL if the calling thread has none.
+ */
+const char *uart_handler_reply_tag_get(void);
+
+/**
+ * @brief Wait until the TX ring buffer can take a write of a given size.
+ *
+ * Lets producers of long outputs generate their next chunk only once it can
+ * be queued without blocking, which keeps per-response memory bounded.
+ * Returns immediately before uart_handler_init() (polling mode).
+ *
+ * @param len Number of bytes the caller intends to write.
+ * @param timeout Maximum time to wait for space.
+ * @return 0 when space is available, -EAGAIN on timeout, -ECANCELED if an
+ *         abort is pending, or -EINVAL if len exceeds the buffer size.
+ */
+int uart_handler_tx_wait_space(size_t len, k_timeout_t timeout);
+
+/**
+ * @brief Hold back output until uart_handler_tx_uncork().
+ *
+ * A response is usually written in several small pieces (a progress line,
+ * the result, the next menu). While corked, they collect in the TX ring
+ * buffer and go out as one transfer when the last uncork arrives, the ring
+ * buffer fills up, or UART_TX_CORK_MAX_US after the first held byte,
+ * whichever comes first. Calls nest and apply to output of all threads.
+ *
+ * Without a cork, a write to an idle transmitter still waits up to
+ * UART_TX_COALESCE_US (or until UART_TX_COALESCE_BYTES are pending) for
+ * more output before starting a transfer.
+ */
+void uart_handler_tx_cork(void);
+
+/**
+ * @brief Release one uart_handler_tx_cork(); the last one starts the transfer.
+ */
+void uart_handler_tx_uncork(void);
+
+/**
+ * @brief Send the output collected so far, even while corked.
+ *
+ * For code that is about to block (e.g., waiting for input) and cannot
+ * tell whether a caller has corked output.
+ */
+void uart_handler_tx_flush(void);
+
+/**
+ * @brief Get the TX transfer counters.
+ *
+ * @param stats Pointer receiving the counters.
+ */
+void uart_handler_tx_get_stats(struct uart_handler_tx_stats *stats);
+
+/**
+ * @brief Check whether the operator requested an abort.
+ *
+ * An abort is raised from the RX interrupt when Ctrl-C or a line break
+ * condition is received. All queued output and queued input lines are
+ * discarded, and an empty line is posted to `uart_msgq` so that a reader
+ * blocked on the queue wakes up. Long-running commands should poll this
+ * function and stop early when it returns true.
+ *
+ * @return true if an abort is pending, false otherwise.
+ */
+bool uart_handler_abort_pending(void);
+
+/**
+ * @brief Clear a pending abort.
+ *
+ * Called by the menu once it has returned to a prompt, after which output
+ * is accepted again.
+ */
+void uart_handler_abort_clear(void);
+
+/**
+ * @brief Get the poll signal raised when an abort is requested.
+ *
+ * Commands that wait with k_poll() (e.g., async commands) add this signal to
+ * their events so an abort wakes them at once instead of when their own
+ * wait ends.
+ *
+ * @return The abort signal; it stays raised until uart_handler_abort_clear().
+ */
+struct k_poll_signal *uart_handler_abort_signal(void);
+
 /**
  * @brief Externally accessible message queue for retrieved UART lines.
  *
@@ -68,6 +229,9 @@ int uart_handler_write_string(const char *str);
  *   }
  * @endcode
  *
+ * An empty line is never produced by normal input; it marks an abort
+ * (see uart_handler_abort_pending()).
+ *
  * Note:
  * The size of the queue elements and the number of messages, as well as the line buffer size,
  * should be defined in app_config.h or uart_handler.c as per design.
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file uart_link.h
+ * @brief Line-oriented link to a downstream unit on a second UART.
+ *
+ * Description:
+ * ------------
+ * The UART link connects this unit to the next unit of a daisy chain. It
+ * sends and receives whole text lines on the UART given by the devicetree
+ * alias `downstream-uart`. Received lines are queued in `uart_link_msgq`
+ * and announced through a callback, so the gateway can process them outside
+ * interrupt context.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#ifndef UART_LINK_H__
+#define UART_LINK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callback invoked from the UART interrupt when a line was queued.
+ */
+typedef void (*uart_link_rx_cb_t)(void);
+
+/**
+ * @brief Initialize the downstream link.
+ *
+ * @param rx_cb Callback for received lines (may be NULL).
+ * @return 0 on success, or -ENODEV if the board has no downstream UART.
+ */
+int uart_link_init(uart_link_rx_cb_t rx_cb);
+
+/**
+ * @brief Check whether the downstream link is available.
+ */
+bool uart_link_ready(void);
+
+/**
+ * @brief Queue one line for transmission.
+ *
+ * The line is queued entirely or not at all, so lines from different
+ * requests never interleave on the wire.
+ *
+ * @param line Line to send, including its line ending.
+ * @param len Length of the line in bytes.
+ * @return 0 on success, -ENOBUFS if the TX buffer cannot take the whole
+ *         line, or -ENODEV if the link is not available.
+ */
+int uart_link_send(const char *line, size_t len);
+
+/**
+ * @brief Queue of lines received from the downstream unit.
+ *
+ * Elements are UART_MSG_SIZE bytes, NUL-terminated, without line ending.
+ */
+extern struct k_msgq uart_link_msgq;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_LINK_H__ */
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_async.c
+ * @brief Cooperative asynchronous command handlers.
+ *
+ * Description:
+ * ------------
+ * This file implements the dispatcher side of `command_async.h`. Commands
+ * come from a static pool. Each one owns a triggered work item
+ * (k_work_poll) and two poll events: after a step returns
+ * COMMAND_ASYNC_PENDING the work item is submitted with the event the step
+ * asked for, the UART abort signal and the step's timeout, and the kernel
+ * queues it on the system workqueue when any of them fires. An abort thus
+ * cancels a waiting command right away rather than when its wait ends.
+ *
+ * Plain delays poll a per-command signal that is never raised, so every
+ * wait takes the same path. A step that returns COMMAND_ASYNC_PENDING
+ * without setting a wait simply yields and runs again right away.
+ *
+ * Author: Ameed Othman
+ * Date: 2024-12-23
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "command_async.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_async, LOG_LEVEL_INF);
+
+static struct command_async pool[COMMAND_ASYNC_MAX];
+static struct k_spinlock pool_lock;
+
+static void command_async_work_handler(struct k_work *work);
+
+struct command_async *command_async_alloc(void)
+{
+	struct command_async *cmd = NULL;
+	k_spinlock_key_t key = k_spin_lock(&pool_lock);
+
+	for (size_t i = 0; i < ARRAY_SIZE(pool) && !cmd; i++) {
+		if (!pool[i].used) {
+			cmd = &pool[i];
+			memset(cmd, 0, sizeof(*cmd));
+			cmd->used = true;
+		}
+	}
+	k_spin_unlock(&pool_lock, key);
+
+	if (!cmd) {
+		LOG_WRN("All %d async command slots in use", COMMAND_ASYNC_MAX);
+		return NULL;
+	}
+
+	k_work_poll_init(&cmd->work, command_async_work_handler);
+	k_poll_signal_init(&cmd->never);
+	return cmd;
+}
+
+void command_async_free(struct command_async *cmd)
+{
+	k_spinlock_key_t key = k_spin_lock(&pool_lock);
+
+	cmd->used = false;
+	k_spin_unlock(&pool_lock, key);
+}
+
+/**
+ * @brief Set the condition the command waits for before its next step.
+ */
+static int command_async_wait(struct command_async *cmd, uint32_t type, void *obj,
+			      k_timeout_t timeout)
+{
+	k_poll_event_init(&cmd->events[0], type, K_POLL_MODE_NOTIFY_ONLY, obj);
+	cmd->timeout = timeout;
+	return COMMAND_ASYNC_PENDING;
+}
+
+int command_async_sleep(struct command_async *cmd, uint32_t ms)
+{
+	return command_async_wait(cmd, K_POLL_TYPE_SIGNAL, &cmd->never, K_MSEC(ms));
+}
+
+int command_async_wait_signal(struct command_async *cmd, struct k_poll_signal *signal,
+			      uint32_t timeout_ms)
+{
+	return command_async_wait(cmd, K_POLL_TYPE_SIGNAL, signal, K_MSEC(timeout_ms));
+}
+
+int command_async_wait_sem(struct command_async *cmd, struct k_sem *sem, uint32_t timeout_ms)
+{
+	return command_async_wait(cmd, K_POLL_TYPE_SEM_AVAILABLE, sem, K_MSEC(timeout_ms));
+}
+
+/**
+ * @brief Queue the next step for when the current wake condition fires.
+ */
+static void command_async_schedule(struct command_async *cmd)
+{
+	k_poll_event_init(&cmd->events[1], K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY,
+			  uart_handler_abort_signal());
+
+	int ret = k_work_poll_submit(&cmd->work, cmd->events, ARRAY_SIZE(cmd->events),
+				     cmd->timeout);
+
+	if (ret < 0) {
+		/* Cannot happen with valid events; resume at once rather than hang */
+		LOG_ERR("Failed to schedule async command (err %d)", ret);
+		cmd->timeout = K_NO_WAIT;
+		(void)k_work_poll_submit(&cmd->work, cmd->events, ARRAY_SIZE(cmd->events),
+					 K_NO_WAIT);
+	}
+}
+
+static void command_async_work_handler(struct k_work *work)
+{
+	struct k_work_poll *poll = CONTAINER_OF(work, struct k_work_poll, work);
+	struct command_async *cmd = CONTAINER_OF(poll, struct command_async, work);
+	struct k_poll_event *event = &cmd->events[0];
+	void *obj = event->obj;
+	int ret;
+
+	if (obj == &cmd->never) {
+		/* A delay (or yield) always ends by its timeout */
+		cmd->wake_result = 0;
+	} else if (event->state != K_POLL_STATE_NOT_READY) {
+		cmd->wake_result = 0;
+		if (event->type == K_POLL_TYPE_SIGNAL) {
+			k_poll_signal_reset(obj);
+		}
+	} else {
+		/* Timed out, or woken by the abort signal */
+		cmd->wake_result = -EAGAIN;
+	}
+
+	if (uart_handler_abort_pending()) {
+		ret = -ECANCELED;
+	} else {
+		if (cmd->tag[0] != '\0') {
+			uart_handler_reply_tag_set(cmd->tag);
+		}
+
+		/* Unless the step sets a wait, PENDING means "run again" */
+		command_async_wait(cmd, K_POLL_TYPE_SIGNAL, &cmd->never, K_NO_WAIT);
+		ret = cmd->step(cmd);
+
+		if (cmd->tag[0] != '\0') {
+			uart_handler_reply_tag_set(NULL);
+		}
+	}
+
+	if (ret == COMMAND_ASYNC_PENDING) {
+		command_async_schedule(cmd);
+		return;
+	}
+
+	if (cmd->done) {
+		cmd->done(cmd, ret);
+	}
+	command_async_free(cmd);
+}
+
+int command_async_submit(struct command_async *cmd, command_async_done_fn done,
+			 void *user_data)
+{
+	const char *tag = uart_handler_reply_tag_get();
+
+	cmd->done = done;
+	cmd->user_data = user_data;
+	if (tag) {
+		strncpy(cmd->tag, tag, sizeof(cmd->tag) - 1);
+		cmd->tag[sizeof(cmd->tag) - 1] = '\0';
+	}
+
+	command_async_wait(cmd, K_POLL_TYPE_SIGNAL, &cmd->never, K_NO_WAIT);
+	command_async_schedule(cmd);
+	return COMMAND_ASYNC_PENDING;
+}
+
+int command_async_in_flight(void)
+{
+	int count = 0;
+	k_spinlock_key_t key = k_spin_lock(&pool_lock);
+
+	for (size_t i = 0; i < ARRAY_SIZE(pool); i++) {
+		count += pool[i].used ? 1 : 0;
+	}
+	k_spin_unlock(&pool_lock, key);
+	return count;
+}
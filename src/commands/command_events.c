@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_events.c
+ * @brief Event catch-up command logic.
+ *
+ * Description:
+ * ------------
+ * This file implements the `events <since>` text command used by hosts after
+ * reconnecting. Every event newer than <since> that is still held in the
+ * event log is replayed in one burst:
+ *
+ *   EVENTS <since> <newest>
+ *   [EVENTS GAP]
+ *   EVENT <seq> t=<ms> LIGHTS ch=3 on=1 level=40
+ *   ...
+ *   EVENTS END <last>
+ *
+ * `EVENTS GAP` is sent when events newer than <since> were already
+ * overwritten (or <since> belongs to an earlier boot); the host should then
+ * resynchronize its state with `sync 0`. Events are replayed while new ones
+ * are recorded, so the log is re-checked before every event: if entries the
+ * host has not received yet were overwritten in the meantime, `EVENTS GAP`
+ * is sent at that point of the stream. The host stores <last> and passes it
+ * as <since> on its next reconnect.
+ *
+ * It also provides the diagnostics menu action that lists the event log.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "change_seq.h"
+#include "command_events.h"
+#include "command_stream.h"
+#include "event_log.h"
+#include "input_parser.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_events, LOG_LEVEL_INF);
+
+struct events_cursor {
+	uint32_t since;
+	uint32_t last;
+	bool gap;
+	bool header_sent;
+	bool done;
+};
+
+/**
+ * @brief Stream producer: header, optional gap marker, events, trailer.
+ */
+static int command_events_next(struct command_stream *stream, char *buf, size_t len)
+{
+	struct events_cursor *cursor = stream->ctx;
+	struct event_record event;
+
+	if (!cursor->header_sent) {
+		cursor->header_sent = true;
+		return snprintf(buf, len, "EVENTS %u %u\r\n%s", cursor->since, change_seq_current(),
+				cursor->gap ? "EVENTS GAP\r\n" : "");
+	}
+
+	if (cursor->done) {
+		return 0;
+	}
+
+	if (!cursor->gap && event_log_has_gap(cursor->last)) {
+		/* Overwritten while streaming: the next event would skip some */
+		cursor->gap = true;
+		return snprintf(buf, len, "EVENTS GAP\r\n");
+	}
+
+	if (event_log_next_after(cursor->last, &event) == 0) {
+		cursor->last = event.seq;
+
+		int n = event_log_format(&event, buf, len - 2);
+		n = MIN(n, (int)len - 3);
+		buf[n++] = '\r';
+		buf[n++] = '\n';
+		buf[n] = '\0';
+		return n;
+	}
+
+	cursor->done = true;
+	return snprintf(buf, len, "EVENTS END %u\r\n", cursor->last);
+}
+
+/**
+ * @brief Replay all held events newer than a sequence number.
+ *
+ * @param since Sequence number the host has already seen.
+ * @return 0 on success, or the error of the output stream.
+ */
+static int command_events_replay(uint32_t since)
+{
+	struct events_cursor cursor = {
+		.since = since,
+		.last = since,
+		.gap = event_log_has_gap(since),
+	};
+	struct command_stream stream = {
+		.next = command_events_next,
+		.ctx = &cursor,
+	};
+
+	LOG_INF("events since=%u gap=%d", since, cursor.gap);
+	return command_stream_run(&stream);
+}
+
+void command_events_execute(int action_id)
+{
+	LOG_INF("command_events_execute called with action_id=%d", action_id);
+
+	switch (action_id) {
+	case 0:
+		/* Everything still held, starting from the oldest event */
+		command_events_replay(change_seq_floor());
+		break;
+	default:
+		uart_handler_write_literal("Invalid diagnostics command.\r\n");
+		LOG_WRN("Invalid diagnostics action_id=%d provided to command_events_execute",
+			action_id);
+		break;
+	}
+}
+
+int command_events_execute_args(int argc, char **argv)
+{
+	uint32_t since;
+
+	if (argc != 2 || input_parser_parse_uint(argv[1], &since) < 0) {
+		uart_handler_write_literal("ERROR usage: events <since>\r\n");
+		return -EINVAL;
+	}
+
+	return command_events_replay(since);
+}
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_gateway.c
+ * @brief Addressed commands and gateway forwarding to downstream units.
+ *
+ * Description:
+ * ------------
+ * This file implements the addressed command protocol from
+ * `command_gateway.h`.
+ *
+ * Local requests run in the caller's thread with a reply tag set on the
+ * UART handler, so every line the command writes is prefixed with its
+ * request ID. Async commands inherit the tag and end the reply from their
+ * completion callback.
+ *
+ * Forwarded requests go through three tables, all protected by
+ * gateway_lock:
+ *   - dests: per-destination FIFO of requests waiting for a window slot.
+ *   - requests: outstanding requests, keyed by the gateway-local ID that was
+ *     sent downstream, holding the host's ID and the reply deadline.
+ *   - stats: counters reported by `gateway status`.
+ *
+ * Downstream lines are handled by a work item submitted from the link's RX
+ * interrupt; a delayable work item expires requests at their deadline.
+ * Untagged downstream output (e.g., the downstream menu) is dropped.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "command_async.h"
+#include "command_gateway.h"
+#include "commands.h"
+#include "config_store.h"
+#include "uart_handler.h"
+#include "uart_link.h"
+
+LOG_MODULE_REGISTER(command_gateway, LOG_LEVEL_INF);
+
+/* Longest reply line: tag, downstream text and line ending */
+#define GATEWAY_LINE_MAX (UART_MSG_SIZE + 16)
+
+struct gateway_request {
+	bool used;
+	uint16_t gid;
+	uint8_t dest;
+	uint32_t host_id;
+	int64_t deadline;
+};
+
+struct gateway_pending {
+	uint32_t host_id;
+	char command[UART_MSG_SIZE];
+};
+
+/* addr 0 marks an unused entry */
+struct gateway_dest {
+	uint8_t addr;
+	uint8_t inflight;
+	uint8_t head;
+	uint8_t count;
+	struct gateway_pending queue[GATEWAY_QUEUE_DEPTH];
+};
+
+static struct gateway_request requests[GATEWAY_INFLIGHT_MAX];
+static struct gateway_dest dests[GATEWAY_DEST_MAX];
+static struct command_gateway_stats stats;
+static uint16_t next_gid;
+
+static K_MUTEX_DEFINE(gateway_lock);
+
+static void command_gateway_rx_work_handler(struct k_work *work);
+static void command_gateway_timeout_work_handler(struct k_work *work);
+
+static K_WORK_DEFINE(gateway_rx_work, command_gateway_rx_work_handler);
+static K_WORK_DELAYABLE_DEFINE(gateway_timeout_work, command_gateway_timeout_work_handler);
+
+/**
+ * @brief Answer a request with its END line.
+ */
+static void command_gateway_reply_end(uint32_t host_id, int status)
+{
+	char buf[32];
+
+	int len = snprintf(buf, sizeof(buf), "#%u END %d\r\n", host_id, status);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Schedule the timeout work for the earliest reply deadline.
+ */
+static void command_gateway_arm_timeout(void)
+{
+	int64_t earliest = INT64_MAX;
+
+	for (size_t i = 0; i < ARRAY_SIZE(requests); i++) {
+		if (requests[i].used) {
+			earliest = MIN(earliest, requests[i].deadline);
+		}
+	}
+
+	if (earliest == INT64_MAX) {
+		k_work_cancel_delayable(&gateway_timeout_work);
+	} else {
+		k_work_reschedule(&gateway_timeout_work,
+				  K_MSEC(MAX(earliest - k_uptime_get(), 0)));
+	}
+}
+
+static struct gateway_dest *command_gateway_dest(uint8_t addr, bool create)
+{
+	struct gateway_dest *free_dest = NULL;
+
+	for (size_t i = 0; i < ARRAY_SIZE(dests); i++) {
+		if (dests[i].addr == addr) {
+			return &dests[i];
+		}
+		if (!free_dest && dests[i].addr == 0) {
+			free_dest = &dests[i];
+		}
+	}
+
+	if (create && free_dest) {
+		memset(free_dest, 0, sizeof(*free_dest));
+		free_dest->addr = addr;
+		return free_dest;
+	}
+	return NULL;
+}
+
+/**
+ * @brief Send a request downstream under a fresh gateway-local ID.
+ *
+ * @return 0 on success, -EBUSY if all request slots are taken, or the
+ *         error of the link.
+ */
+static int command_gateway_send(struct gateway_dest *dest, const struct gateway_pending *pending)
+{
+	struct gateway_request *request = NULL;
+	char buf[GATEWAY_LINE_MAX];
+
+	for (size_t i = 0; i < ARRAY_SIZE(requests) && !request; i++) {
+		if (!requests[i].used) {
+			request = &requests[i];
+		}
+	}
+	if (!request) {
+		return -EBUSY;
+	}
+
+	/* IDs are unique among outstanding requests; 0 is never used */
+	bool taken;
+	do {
+		next_gid = next_gid == UINT16_MAX ? 1 : next_gid + 1;
+		taken = false;
+		for (size_t i = 0; i < ARRAY_SIZE(requests); i++) {
+			taken |= requests[i].used && requests[i].gid == next_gid;
+		}
+	} while (taken);
+
+	int len = snprintf(buf, sizeof(buf), "@%u %u %s\r\n", dest->addr, next_gid,
+			   pending->command);
+	int ret = uart_link_send(buf, MIN(len, (int)sizeof(buf) - 1));
+	if (ret < 0) {
+		return ret;
+	}
+
+	request->used = true;
+	request->gid = next_gid;
+	request->dest = dest->addr;
+	request->host_id = pending->host_id;
+	request->deadline = k_uptime_get() + GATEWAY_TIMEOUT_MS;
+	dest->inflight++;
+	stats.forwarded++;
+	return 0;
+}
+
+/**
+ * @brief Move queued requests downstream while windows and slots allow.
+ */
+static void command_gateway_pump(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(dests); i++) {
+		struct gateway_dest *dest = &dests[i];
+
+		while (dest->addr != 0 && dest->count > 0 && dest->inflight < GATEWAY_DEST_WINDOW) {
+			struct gateway_pending *pending = &dest->queue[dest->head];
+			int ret = command_gateway_send(dest, pending);
+
+			if (ret == -EBUSY) {
+				/* No free slot: retry when a request completes */
+				break;
+			}
+			if (ret < 0) {
+				command_gateway_reply_end(pending->host_id, ret);
+			}
+			dest->head = (dest->head + 1) % GATEWAY_QUEUE_DEPTH;
+			dest->count--;
+		}
+
+		if (dest->addr != 0 && dest->count == 0 && dest->inflight == 0) {
+			dest->addr = 0;
+		}
+	}
+
+	command_gateway_arm_timeout();
+}
+
+/**
+ * @brief Release an outstanding request.
+ */
+static void command_gateway_release(struct gateway_request *request)
+{
+	struct gateway_dest *dest = command_gateway_dest(request->dest, false);
+
+	if (dest && dest->inflight > 0) {
+		dest->inflight--;
+	}
+	request->used = false;
+}
+
+/**
+ * @brief Queue a request for another unit.
+ */
+static int command_gateway_forward(uint8_t addr, uint32_t host_id, const char *command)
+{
+	int ret = 0;
+
+	k_mutex_lock(&gateway_lock, K_FOREVER);
+
+	struct gateway_dest *dest = command_gateway_dest(addr, true);
+
+	if (!config_store_value(CONFIG_KEY_GATEWAY) || !uart_link_ready()) {
+		ret = -ENODEV;
+	} else if (!dest || dest->count == GATEWAY_QUEUE_DEPTH) {
+		ret = -EBUSY;
+		stats.rejected++;
+	} else {
+		struct gateway_pending *pending =
+			&dest->queue[(dest->head + dest->count) % GATEWAY_QUEUE_DEPTH];
+
+		pending->host_id = host_id;
+		strncpy(pending->command, command, sizeof(pending->command) - 1);
+		pending->command[sizeof(pending->command) - 1] = '\0';
+		dest->count++;
+	}
+
+	/* Also frees a destination entry created for a refused request */
+	command_gateway_pump();
+	k_mutex_unlock(&gateway_lock);
+
+	if (ret < 0) {
+		command_gateway_reply_end(host_id, ret);
+	}
+	return ret;
+}
+
+/**
+ * @brief End the reply of a local request that ran as an async command.
+ */
+static void command_gateway_local_done(struct command_async *cmd, int status)
+{
+	command_gateway_reply_end(POINTER_TO_UINT(cmd->user_data), status);
+}
+
+/**
+ * @brief Run a request addressed to this unit with its reply tagged.
+ *
+ * Async commands carry the tag along and send the END line when they
+ * complete, so slow local requests do not hold up the caller.
+ */
+static void command_gateway_execute_local(uint32_t host_id, char *command)
+{
+	char tag[16];
+	int ret = -EINVAL;
+
+	snprintf(tag, sizeof(tag), "#%u ", host_id);
+
+	if (command[0] != '@') {
+		uart_handler_reply_tag_set(tag);
+		ret = commands_core_execute_line_async(command, command_gateway_local_done,
+						       UINT_TO_POINTER(host_id));
+		uart_handler_reply_tag_set(NULL);
+	}
+
+	if (ret != COMMAND_ASYNC_PENDING) {
+		command_gateway_reply_end(host_id, ret);
+	}
+}
+
+/**
+ * @brief Pass a broadcast command on to the downstream units, without reply.
+ */
+static void command_gateway_broadcast(const char *command)
+{
+	char buf[GATEWAY_LINE_MAX];
+
+	if (!config_store_value(CONFIG_KEY_GATEWAY) || !uart_link_ready()) {
+		return;
+	}
+
+	int len = snprintf(buf, sizeof(buf), "@%u 0 %s\r\n", GATEWAY_BROADCAST_ADDRESS, command);
+	int ret = uart_link_send(buf, MIN(len, (int)sizeof(buf) - 1));
+
+	k_mutex_lock(&gateway_lock, K_FOREVER);
+	if (ret == 0) {
+		stats.broadcasts++;
+	} else {
+		stats.rejected++;
+	}
+	k_mutex_unlock(&gateway_lock);
+}
+
+int command_gateway_execute_line(char *line)
+{
+	char *end;
+
+	if (!line || line[0] != '@') {
+		return -EINVAL;
+	}
+
+	unsigned long addr = strtoul(line + 1, &end, 10);
+	if (end == line + 1 || *end != ' ' || addr == 0 || addr > GATEWAY_BROADCAST_ADDRESS) {
+		return -EINVAL;
+	}
+
+	char *id_str = end + 1;
+	unsigned long host_id = strtoul(id_str, &end, 10);
+	if (end == id_str || *end != ' ') {
+		return -EINVAL;
+	}
+
+	char *command = end + 1;
+
+	if (addr == GATEWAY_BROADCAST_ADDRESS) {
+		/* Pass it on first: running it here modifies the line */
+		command_gateway_broadcast(command);
+		command_gateway_execute_local(host_id, command);
+	} else if (addr == (unsigned long)config_store_value(CONFIG_KEY_UNIT_ADDRESS)) {
+		command_gateway_execute_local(host_id, command);
+	} else {
+		(void)command_gateway_forward(addr, host_id, command);
+	}
+	return 0;
+}
+
+/**
+ * @brief Map one downstream reply line back to the host's request ID.
+ */
+static void command_gateway_handle_reply(const char *line)
+{
+	char buf[GATEWAY_LINE_MAX];
+	char *rest;
+	struct gateway_request *request = NULL;
+
+	unsigned long gid = strtoul(line + 1, &rest, 10);
+	if (line[0] != '#' || rest == line + 1 || *rest != ' ') {
+		stats.dropped++;
+		return;
+	}
+
+	if (gid == 0) {
+		/* Reply to a broadcast; the host gets ours */
+		return;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(requests) && !request; i++) {
+		if (requests[i].used && requests[i].gid == gid) {
+			request = &requests[i];
+		}
+	}
+	if (!request) {
+		/* Untagged output, or a reply that arrived after its timeout */
+		stats.dropped++;
+		return;
+	}
+
+	int len = snprintf(buf, sizeof(buf), "#%u%s\r\n", request->host_id, rest);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+
+	if (strncmp(rest, " END ", 5) == 0) {
+		command_gateway_release(request);
+		stats.completed++;
+	}
+}
+
+static void command_gateway_rx_work_handler(struct k_work *work)
+{
+	char line[UART_MSG_SIZE];
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&gateway_lock, K_FOREVER);
+	while (k_msgq_get(&uart_link_msgq, line, K_NO_WAIT) == 0) {
+		command_gateway_handle_reply(line);
+	}
+	command_gateway_pump();
+	k_mutex_unlock(&gateway_lock);
+}
+
+static void command_gateway_timeout_work_handler(struct k_work *work)
+{
+	int64_t now = k_uptime_get();
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&gateway_lock, K_FOREVER);
+	for (size_t i = 0; i < ARRAY_SIZE(requests); i++) {
+		if (requests[i].used && requests[i].deadline <= now) {
+			LOG_WRN("Request %u to unit %u timed out", requests[i].host_id,
+				requests[i].dest);
+			command_gateway_reply_end(requests[i].host_id, -ETIMEDOUT);
+			command_gateway_release(&requests[i]);
+			stats.timeouts++;
+		}
+	}
+	command_gateway_pump();
+	k_mutex_unlock(&gateway_lock);
+}
+
+/* Called from the link's RX interrupt */
+static void command_gateway_rx_notify(void)
+{
+	k_work_submit(&gateway_rx_work);
+}
+
+void command_gateway_init(void)
+{
+	(void)uart_link_init(command_gateway_rx_notify);
+}
+
+void command_gateway_get_stats(struct command_gateway_stats *out)
+{
+	k_mutex_lock(&gateway_lock, K_FOREVER);
+	*out = stats;
+	out->inflight = 0;
+	out->queued = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(requests); i++) {
+		out->inflight += requests[i].used;
+	}
+	for (size_t i = 0; i < ARRAY_SIZE(dests); i++) {
+		out->queued += dests[i].addr != 0 ? dests[i].count : 0;
+	}
+	k_mutex_unlock(&gateway_lock);
+}
+
+int command_gateway_execute_args(int argc, char **argv)
+{
+	struct command_gateway_stats current;
+	char buf[160];
+
+	if (argc != 2 || strcmp(argv[1], "status") != 0) {
+		uart_handler_write_literal("ERROR usage: gateway status\r\n");
+		return -EINVAL;
+	}
+
+	command_gateway_get_stats(&current);
+	int len = snprintf(buf, sizeof(buf),
+			   "OK GATEWAY on=%d addr=%d link=%d inflight=%u queued=%u forwarded=%u"
+			   " completed=%u timeouts=%u rejected=%u dropped=%u broadcasts=%u\r\n",
+			   config_store_value(CONFIG_KEY_GATEWAY),
+			   config_store_value(CONFIG_KEY_UNIT_ADDRESS), uart_link_ready(),
+			   current.inflight, current.queued, current.forwarded, current.completed,
+			   current.timeouts, current.rejected, current.dropped, current.broadcasts);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+	return 0;
+}
@@ -20,6 +20,44 @@
  * called. Depending on success or failure, a message is printed to the user.
  * If the action_id is invalid, an error message is displayed.
  *
+ * With STATE_JOURNAL_DEFER_ACK enabled, the success message is only printed
+ * once the change has been committed to the state journal, so the host is
+ * never told about a change that a power failure could still undo. If the
+ * commit fails or STATE_JOURNAL_ACK_TIMEOUT_MS runs out, the reply says the
+ * change is not yet saved instead. An abort (Ctrl-C or break) ends that wait,
+ * and the command returns -ECANCELED without a reply.
+ *
+ * Text commands (command_lights_execute_args()) address individual channels
+ * and report each channel's version for optimistic concurrency:
+ *   lights get <ch>
+ *   lights set <ch> <on|off> <level>
+ *   lights cas <ch> <version> <on|off> <level>
+ *   lights stats
+ *   lights usage [<ch>]
+ *   lights on <sel> | lights off <sel>
+ *   lights group <n> [<sel>]
+ * `set`, `on` and `off` also take a channel selector such as `0,2,4-7`,
+ * `g1` (a group) or `*`. The selector is compiled into a channel mask and all
+ * selected channels change in one pass with a single commit; the reply is
+ * `OK LIGHTS mask=<hex> changed=<n>`. `on` and `off` keep each channel's
+ * level. A `cas` only applies if the channel is still at <version>; otherwise the
+ * reply is CONFLICT with the current state, so the host can retry without an
+ * extra read. `stats` reports how many writes were coalesced (see the
+ * `coalesce_ms` config key). With coalescing, a write reaches the outputs
+ * and the journal when its window ends. A write that is only acknowledged
+ * once durable (STATE_JOURNAL_DEFER_ACK) first waits for that commit and then
+ * for the journal commit, so a burst of host writes still becomes one output
+ * commit and every write still gets its own reply. Without deferred acks, a
+ * write is acknowledged once it is staged.
+ *
+ * Text commands that change channels are async commands (command_async.h):
+ * the change is applied right away, and with STATE_JOURNAL_DEFER_ACK the
+ * reply waits in a step that parks on the lights and then the journal commit
+ * signal, so the thread dispatching commands is not held up by the commit. If no async
+ * command is free, the reply falls back to a blocking wait.
+ * `usage` prints the usage counters of one channel, or streams them for all
+ * channels followed by an END line.
+ *
  * This implementation ensures that commands_core.c and menu_actions_execute()
  * can successfully route lights commands to actual functionality.
  *
@@ -29,12 +67,111 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+#include "app_config.h"
+#include "command_async.h"
 #include "command_lights.h"
+#include "command_stream.h"
+#include "config_store.h"
+#include "input_parser.h"
 #include "lights_control.h"
+#include "state_journal.h"
 #include "uart_handler.h"
 
 LOG_MODULE_REGISTER(command_lights, LOG_LEVEL_INF);
 
+/* Write result: the reply (e.g., CONFLICT) was sent, nothing to acknowledge */
+#define COMMAND_LIGHTS_REPLIED 1
+
+/* Acknowledgement of a text command write, kept in the async command */
+struct command_lights_ack {
+	int64_t deadline;
+	uint32_t commit; /* lights commit ticket */
+	uint32_t ticket; /* journal ticket, once journaled */
+	uint32_t mask;
+	uint32_t version;
+	int16_t level;
+	int8_t changed; /* -1: single channel reply */
+	uint8_t channel;
+	bool on;
+	bool journaled;
+};
+
+BUILD_ASSERT(sizeof(struct command_lights_ack) <= COMMAND_ASYNC_DATA_SIZE,
+	     "lights ack state does not fit in an async command");
+
+/**
+ * @brief Warn that a lights change was applied but is not durable.
+ *
+ * @param ret Outcome of the commit; a missing journal is not an error.
+ */
+static void command_lights_check_commit(int ret)
+{
+	if (ret < 0 && ret != -ENODEV) {
+		uart_handler_write_literal("Warning: lights state not persisted.\r\n");
+		LOG_ERR("Lights state commit failed, error code %d", ret);
+	}
+}
+
+/**
+ * @brief Wait for the journal commit of a lights change before acknowledging.
+ *
+ * Does nothing unless STATE_JOURNAL_DEFER_ACK is set. A coalesced change
+ * first waits for the commit that ends its window, which appends it to the
+ * journal. A missing journal is not an error; a failed or late commit does not undo the change, but the
+ * caller must not report it as saved. The wait is done in
+ * COMMAND_ABORT_POLL_MS slices so an abort ends it early.
+ *
+ * @return 0 once the change is durable (or there is no journal), -ECANCELED
+ *         on abort, -EAGAIN if the window plus STATE_JOURNAL_ACK_TIMEOUT_MS
+ *         ran out, or the error of a failed commit.
+ */
+static int command_lights_wait_durable(void)
+{
+	int ret = -EAGAIN;
+
+	if (!STATE_JOURNAL_DEFER_ACK) {
+		return 0;
+	}
+
+	uint32_t commit = lights_control_commit_ticket();
+	int64_t deadline = k_uptime_get() + config_store_value(CONFIG_KEY_COALESCE_MS) +
+			   STATE_JOURNAL_ACK_TIMEOUT_MS;
+
+	while (ret == -EAGAIN && k_uptime_get() < deadline) {
+		if (uart_handler_abort_pending()) {
+			LOG_INF("Abort while waiting for the lights state commit");
+			return -ECANCELED;
+		}
+		if (lights_control_wait_committed(commit, K_MSEC(COMMAND_ABORT_POLL_MS)) == 0) {
+			ret = state_journal_wait_committed(K_MSEC(COMMAND_ABORT_POLL_MS));
+		}
+	}
+
+	return ret == -ENODEV ? 0 : ret;
+}
+
+/**
+ * @brief Wait until a menu change is durable before its reply is printed.
+ *
+ * @return true if the reply is to be printed; false after an abort (no
+ *         reply) or after reporting that the change is not yet saved.
+ */
+static bool command_lights_menu_durable(void)
+{
+	int ret = command_lights_wait_durable();
+
+	if (ret == -ECANCELED) {
+		return false;
+	} else if (ret < 0) {
+		uart_handler_write_literal("Lights changed, but not yet saved.\r\n");
+		LOG_ERR("Lights state commit failed, error code %d", ret);
+		return false;
+	}
+	return true;
+}
+
 void command_lights_execute(int action_id)
 {
 	LOG_INF("command_lights_execute called with action_id=%d", action_id);
@@ -44,46 +181,441 @@ void command_lights_execute(int action_id)
 	case 0: // Turn ON
 		ret = lights_control_turn_on();
 		if (ret == 0) {
-			uart_handler_write_string("Lights turned ON.\r\n");
-			LOG_INF("Lights turned ON successfully.");
+			if (command_lights_menu_durable()) {
+				uart_handler_write_literal("Lights turned ON.\r\n");
+				LOG_INF("Lights turned ON successfully.");
+			}
 		} else {
-			uart_handler_write_string("Failed to turn lights ON.\r\n");
+			uart_handler_write_literal("Failed to turn lights ON.\r\n");
 			LOG_ERR("Failed to turn lights ON, error code %d", ret);
 		}
 		break;
 	case 1: // Turn OFF
 		ret = lights_control_turn_off();
 		if (ret == 0) {
-			uart_handler_write_string("Lights turned OFF.\r\n");
-			LOG_INF("Lights turned OFF successfully.");
+			if (command_lights_menu_durable()) {
+				uart_handler_write_literal("Lights turned OFF.\r\n");
+				LOG_INF("Lights turned OFF successfully.");
+			}
 		} else {
-			uart_handler_write_string("Failed to turn lights OFF.\r\n");
+			uart_handler_write_literal("Failed to turn lights OFF.\r\n");
 			LOG_ERR("Failed to turn lights OFF, error code %d", ret);
 		}
 		break;
 	case 2: // Increase Brightness
 		ret = lights_control_increase_brightness();
 		if (ret == 0) {
-			uart_handler_write_string("Brightness increased.\r\n");
-			LOG_INF("Brightness increased successfully.");
+			if (command_lights_menu_durable()) {
+				uart_handler_write_literal("Brightness increased.\r\n");
+				LOG_INF("Brightness increased successfully.");
+			}
 		} else {
-			uart_handler_write_string("Failed to increase brightness.\r\n");
+			uart_handler_write_literal("Failed to increase brightness.\r\n");
 			LOG_ERR("Failed to increase brightness, error code %d", ret);
 		}
 		break;
 	case 3: // Decrease Brightness
 		ret = lights_control_decrease_brightness();
 		if (ret == 0) {
-			uart_handler_write_string("Brightness decreased.\r\n");
-			LOG_INF("Brightness decreased successfully.");
+			if (command_lights_menu_durable()) {
+				uart_handler_write_literal("Brightness decreased.\r\n");
+				LOG_INF("Brightness decreased successfully.");
+			}
 		} else {
-			uart_handler_write_string("Failed to decrease brightness.\r\n");
+			uart_handler_write_literal("Failed to decrease brightness.\r\n");
 			LOG_ERR("Failed to decrease brightness, error code %d", ret);
 		}
 		break;
 	default:
-		uart_handler_write_string("Invalid lights action.\r\n");
+		uart_handler_write_literal("Invalid lights action.\r\n");
 		LOG_WRN("Invalid action_id=%d provided to command_lights_execute", action_id);
 		break;
 	}
 }
+
+/**
+ * @brief Print one channel's state in the text command reply format.
+ *
+ * @param status Reply status word ("OK", "CONFLICT"), or NULL for a plain read.
+ * @param channel Channel index.
+ * @param state Channel snapshot to print.
+ */
+static void command_lights_report(const char *status, unsigned int channel,
+				  const struct lights_channel_state *state)
+{
+	char buf[64];
+
+	int len = snprintf(buf, sizeof(buf), "%s%sLIGHTS %u on=%d level=%d ver=%u\r\n",
+			   status ? status : "", status ? " " : "", channel, state->on ? 1 : 0,
+			   state->level, state->version);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Send the reply of a write once it is acknowledged.
+ *
+ * @param ack The write.
+ * @param commit Outcome of the journal commit.
+ */
+static void command_lights_send_ack(const struct command_lights_ack *ack, int commit)
+{
+	char buf[48];
+
+	command_lights_check_commit(commit);
+
+	if (ack->changed < 0) {
+		struct lights_channel_state state = {
+			.on = ack->on,
+			.level = ack->level,
+			.version = ack->version,
+		};
+
+		command_lights_report("OK", ack->channel, &state);
+		return;
+	}
+
+	int len = snprintf(buf, sizeof(buf), "OK LIGHTS mask=0x%08x changed=%d\r\n", ack->mask,
+			   ack->changed);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Async step: reply once the journal has committed the write.
+ *
+ * Parks on the lights commit signal until the coalescing window holding the
+ * write is committed, then takes a journal ticket and parks on the journal's
+ * commit signal. Another waiter may reset a signal before this command sees
+ * it, so the tickets are also re-checked every journal commit window. An
+ * abort ends the command without a reply.
+ */
+static int command_lights_ack_step(struct command_async *cmd)
+{
+	struct command_lights_ack *ack = (struct command_lights_ack *)cmd->data;
+	int64_t left = ack->deadline - k_uptime_get();
+	int ret;
+
+	if (!ack->journaled) {
+		if (!lights_control_ticket_committed(ack->commit)) {
+			if (left > 0) {
+				return command_async_wait_signal(cmd, lights_control_commit_signal(),
+								 (uint32_t)MIN(left, STATE_JOURNAL_COMMIT_MS));
+			}
+			command_lights_send_ack(ack, -EAGAIN);
+			return 0;
+		}
+		/* The commit appended the write to the journal */
+		ack->ticket = state_journal_ticket();
+		ack->journaled = true;
+	}
+
+	ret = state_journal_ticket_committed(ack->ticket);
+	if (ret == -EAGAIN && left > 0) {
+		return command_async_wait_signal(cmd, state_journal_commit_signal(),
+						 (uint32_t)MIN(left, STATE_JOURNAL_COMMIT_MS));
+	}
+
+	command_lights_send_ack(ack, ret);
+	return 0;
+}
+
+/**
+ * @brief Acknowledge a write, after its journal commit if required.
+ *
+ * @param ret Result of the write: 0 if @p ack is to be sent,
+ *            COMMAND_LIGHTS_REPLIED if the reply was sent, or an error.
+ * @param ack The write.
+ * @param out Receives the async command waiting for the commit.
+ * @return 0 if the reply was sent, COMMAND_ASYNC_PENDING if @p out was set
+ *         up, -ECANCELED on abort, or the error of the write.
+ */
+static int command_lights_acknowledge(int ret, const struct command_lights_ack *ack,
+				      struct command_async **out)
+{
+	if (ret != 0) {
+		return ret == COMMAND_LIGHTS_REPLIED ? 0 : ret;
+	}
+
+	if (!STATE_JOURNAL_DEFER_ACK || ack->changed == 0) {
+		command_lights_send_ack(ack, 0);
+		return 0;
+	}
+
+	struct command_async *cmd = command_async_alloc();
+
+	if (!cmd) {
+		/* The change is applied already: keep the guarantee, block instead */
+		ret = command_lights_wait_durable();
+		if (ret == -ECANCELED) {
+			return ret;
+		}
+		command_lights_send_ack(ack, ret);
+		return 0;
+	}
+
+	struct command_lights_ack *wait = (struct command_lights_ack *)cmd->data;
+
+	*wait = *ack;
+	/* A staged write is not journaled until its coalescing window closes */
+	wait->commit = lights_control_commit_ticket();
+	wait->journaled = false;
+	wait->deadline = k_uptime_get() + config_store_value(CONFIG_KEY_COALESCE_MS) +
+			 STATE_JOURNAL_ACK_TIMEOUT_MS;
+	cmd->step = command_lights_ack_step;
+	*out = cmd;
+	return COMMAND_ASYNC_PENDING;
+}
+
+/**
+ * @brief Handle `lights set` and `lights cas`.
+ *
+ * @param argv Arguments after the sub-command: <ch> [<version>] <on|off> <level>.
+ * @param conditional True for `cas` (argv carries a version).
+ * @param ack Receives the write to acknowledge.
+ * @return 0 if @p ack is to be sent, COMMAND_LIGHTS_REPLIED after a CONFLICT
+ *         reply, or -EINVAL for malformed arguments.
+ */
+static int command_lights_write(char **argv, bool conditional, struct command_lights_ack *ack)
+{
+	struct lights_channel_state current;
+	uint32_t channel;
+	uint32_t version = LIGHTS_VERSION_ANY;
+	int32_t level;
+	bool on;
+	int i = 0;
+
+	if (input_parser_parse_uint(argv[i++], &channel) < 0 ||
+	    (conditional && input_parser_parse_uint(argv[i++], &version) < 0) ||
+	    input_parser_parse_on_off(argv[i++], &on) < 0 ||
+	    input_parser_parse_int(argv[i++], &level) < 0) {
+		return -EINVAL;
+	}
+
+	/* Version 0 would turn a conditional write into an unconditional one */
+	if (conditional && version == LIGHTS_VERSION_ANY) {
+		return -EINVAL;
+	}
+
+	int ret = lights_control_set_channel(channel, on, level, version, &current);
+	if (ret == -EAGAIN) {
+		command_lights_report("CONFLICT", channel, &current);
+		return COMMAND_LIGHTS_REPLIED;
+	} else if (ret < 0) {
+		return ret;
+	}
+
+	ack->changed = -1;
+	ack->channel = channel;
+	ack->on = current.on;
+	ack->level = current.level;
+	ack->version = current.version;
+	return 0;
+}
+
+/**
+ * @brief Compile a channel selector into a channel mask.
+ *
+ * @param str Selector, see input_parser_parse_channels().
+ * @param mask Receives the selected channels.
+ * @return 0 on success, or -EINVAL for an invalid or empty selection.
+ */
+static int command_lights_parse_selector(const char *str, uint32_t *mask)
+{
+	uint32_t groups[LIGHTS_GROUP_COUNT];
+
+	lights_control_get_groups(groups);
+	if (input_parser_parse_channels(str, LIGHTS_CHANNEL_COUNT, groups, LIGHTS_GROUP_COUNT,
+					mask) < 0 || *mask == 0) {
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/**
+ * @brief Set all channels of a selector in one pass.
+ *
+ * @param selector Channel selector.
+ * @param on New ON/OFF state.
+ * @param level New level, or LIGHTS_LEVEL_KEEP.
+ * @param ack Receives the write to acknowledge.
+ * @return 0 if @p ack is to be sent, or -EINVAL for malformed arguments.
+ */
+static int command_lights_write_many(const char *selector, bool on, int level,
+				     struct command_lights_ack *ack)
+{
+	uint32_t mask;
+
+	if (command_lights_parse_selector(selector, &mask) < 0) {
+		return -EINVAL;
+	}
+
+	int changed = lights_control_set_channels(mask, on, level);
+	if (changed < 0) {
+		return changed;
+	}
+
+	ack->mask = mask;
+	ack->changed = changed;
+	return 0;
+}
+
+/**
+ * @brief Handle `lights set <sel> <on|off> <level>` for a selector.
+ *
+ * A plain channel number keeps the per-channel reply of command_lights_write().
+ */
+static int command_lights_set(char **argv, struct command_lights_ack *ack)
+{
+	uint32_t channel;
+	int32_t level;
+	bool on;
+
+	if (input_parser_parse_uint(argv[0], &channel) == 0) {
+		return command_lights_write(argv, false, ack);
+	}
+
+	if (input_parser_parse_on_off(argv[1], &on) < 0 ||
+	    input_parser_parse_int(argv[2], &level) < 0 || level < 0 || level > 100) {
+		return -EINVAL;
+	}
+	return command_lights_write_many(argv[0], on, level, ack);
+}
+
+/**
+ * @brief Handle `lights group <n> [<sel>]`: define or show a group.
+ */
+static int command_lights_group(int argc, char **argv)
+{
+	uint32_t groups[LIGHTS_GROUP_COUNT];
+	uint32_t group;
+	uint32_t mask;
+	char buf[48];
+
+	if (input_parser_parse_uint(argv[2], &group) < 0 || group >= LIGHTS_GROUP_COUNT) {
+		return -EINVAL;
+	}
+
+	if (argc == 4) {
+		/* Parsed before the update, so a group may be defined from itself */
+		if (command_lights_parse_selector(argv[3], &mask) < 0 ||
+		    lights_control_set_group(group, mask) < 0) {
+			return -EINVAL;
+		}
+	} else {
+		lights_control_get_groups(groups);
+		mask = groups[group];
+	}
+
+	int len = snprintf(buf, sizeof(buf), "OK GROUP g%u mask=0x%08x\r\n", group, mask);
+	return uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Print the lights write and commit counters.
+ */
+static void command_lights_report_stats(void)
+{
+	struct lights_control_stats stats;
+	char buf[96];
+
+	lights_control_get_stats(&stats);
+	int len = snprintf(buf, sizeof(buf), "OK LIGHTS_STATS writes=%u coalesced=%u commits=%u pending=%u\r\n",
+			   stats.writes, stats.coalesced, stats.commits, stats.pending);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Format the usage counters of one channel as a reply line.
+ */
+static int command_lights_format_usage(unsigned int channel, char *buf, size_t len)
+{
+	struct lights_channel_usage usage;
+
+	lights_control_get_usage(channel, &usage);
+	return snprintf(buf, len, "OK USAGE %u on_s=%llu duty_s=%llu cycles=%u mwh=%llu\r\n",
+			channel, (unsigned long long)(usage.on_ms / 1000U),
+			(unsigned long long)(usage.duty_ms / 1000U), usage.cycles,
+			(unsigned long long)usage.energy_mwh);
+}
+
+/**
+ * @brief Stream producer: one usage line per channel, then an END line.
+ */
+static int command_lights_usage_next(struct command_stream *stream, char *buf, size_t len)
+{
+	unsigned int channel = stream->position++;
+
+	if (channel < LIGHTS_CHANNEL_COUNT) {
+		return command_lights_format_usage(channel, buf, len);
+	}
+	if (channel == LIGHTS_CHANNEL_COUNT) {
+		return snprintf(buf, len, "OK USAGE END\r\n");
+	}
+	return 0;
+}
+
+/**
+ * @brief Handle `lights usage [<ch>]`.
+ */
+static int command_lights_usage(int argc, char **argv)
+{
+	uint32_t channel;
+	char buf[COMMAND_STREAM_CHUNK_SIZE];
+
+	if (argc == 2) {
+		struct command_stream stream = { .next = command_lights_usage_next };
+
+		return command_stream_run(&stream);
+	}
+
+	if (input_parser_parse_uint(argv[2], &channel) < 0 || channel >= LIGHTS_CHANNEL_COUNT) {
+		return -EINVAL;
+	}
+
+	int len = command_lights_format_usage(channel, buf, sizeof(buf));
+
+	return uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+int command_lights_execute_args(int argc, char **argv, struct command_async **cmd)
+{
+	struct command_lights_ack ack = { 0 };
+	struct lights_channel_state state;
+	uint32_t channel;
+	int ret = -EINVAL;
+
+	if (argc == 3 && strcmp(argv[1], "get") == 0) {
+		if (input_parser_parse_uint(argv[2], &channel) == 0 &&
+		    lights_control_get_channel(channel, &state) == 0) {
+			command_lights_report(NULL, channel, &state);
+			ret = 0;
+		}
+	} else if (argc == 5 && strcmp(argv[1], "set") == 0) {
+		ret = command_lights_acknowledge(command_lights_set(&argv[2], &ack), &ack, cmd);
+	} else if (argc == 3 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0)) {
+		ret = command_lights_write_many(argv[2], argv[1][1] == 'n', LIGHTS_LEVEL_KEEP, &ack);
+		ret = command_lights_acknowledge(ret, &ack, cmd);
+	} else if ((argc == 3 || argc == 4) && strcmp(argv[1], "group") == 0) {
+		ret = command_lights_group(argc, argv);
+	} else if (argc == 6 && strcmp(argv[1], "cas") == 0) {
+		ret = command_lights_acknowledge(command_lights_write(&argv[2], true, &ack), &ack, cmd);
+	} else if (argc == 2 && strcmp(argv[1], "stats") == 0) {
+		command_lights_report_stats();
+		ret = 0;
+	} else if ((argc == 2 || argc == 3) && strcmp(argv[1], "usage") == 0) {
+		ret = command_lights_usage(argc, argv);
+		if (ret == -ECANCELED || ret == -EAGAIN) {
+			return ret;
+		}
+	}
+
+	if (ret == -ECANCELED || ret == COMMAND_ASYNC_PENDING) {
+		return ret;
+	} else if (ret < 0) {
+		uart_handler_write_literal("ERROR usage: lights get <ch> | lights set <sel> <on|off> <level>"
+					   " | lights cas <ch> <ver> <on|off> <level> | lights on|off <sel>"
+					   " | lights group <n> [<sel>] | lights stats | lights usage [<ch>]\r\n");
+		LOG_WRN("Invalid lights text command (argc=%d)", argc);
+	}
+
+	return ret;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_regulator.c
+ * @brief Constant-light regulator command logic.
+ *
+ * Description:
+ * ------------
+ * This file implements the `regulator` text command on top of
+ * `lights_regulator.c`. Every form answers with the regulator state:
+ *
+ *   OK REGULATOR on=1 lux=296 setpoint=300 error=4 output=42.125 level=42 steps=87
+ *
+ * `regulator on <lux>` also writes the `reg_setpoint` config key, so the
+ * setpoint is versioned and persisted like the other tuning parameters.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "command_regulator.h"
+#include "config_store.h"
+#include "input_parser.h"
+#include "lights_regulator.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_regulator, LOG_LEVEL_INF);
+
+/**
+ * @brief Print the regulator state in the text command reply format.
+ */
+static void command_regulator_report(void)
+{
+	struct lights_regulator_status status;
+	char buf[112];
+
+	lights_regulator_get_status(&status);
+	int len = snprintf(buf, sizeof(buf),
+			   "OK REGULATOR on=%d lux=%d setpoint=%d error=%d output=%d.%03d level=%d steps=%u\r\n",
+			   status.enabled, status.lux_milli / 1000,
+			   config_store_value(CONFIG_KEY_REG_SETPOINT), status.error_milli / 1000,
+			   status.output_milli / 1000, status.output_milli % 1000, status.level,
+			   status.steps);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+int command_regulator_execute_args(int argc, char **argv)
+{
+	int ret = -EINVAL;
+	int32_t setpoint;
+
+	if ((argc == 2 || argc == 3) && strcmp(argv[1], "on") == 0) {
+		ret = 0;
+		if (argc == 3) {
+			ret = input_parser_parse_int(argv[2], &setpoint);
+			if (ret == 0) {
+				ret = config_store_set(CONFIG_KEY_REG_SETPOINT, setpoint,
+						       CONFIG_STORE_VERSION_ANY, NULL, NULL);
+			}
+		}
+		if (ret == 0) {
+			ret = lights_regulator_enable();
+		}
+	} else if (argc == 2 && strcmp(argv[1], "off") == 0) {
+		lights_regulator_disable();
+		ret = 0;
+	} else if (argc == 2 && strcmp(argv[1], "status") == 0) {
+		ret = 0;
+	}
+
+	if (ret < 0) {
+		uart_handler_write_literal("ERROR usage: regulator on [<lux>] | regulator off"
+					   " | regulator status\r\n");
+		LOG_WRN("Invalid regulator text command (argc=%d, err %d)", argc, ret);
+		return ret;
+	}
+
+	command_regulator_report();
+	return 0;
+}
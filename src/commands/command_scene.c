@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_scene.c
+ * @brief Scene and time command logic.
+ *
+ * Description:
+ * ------------
+ * This file implements the `scene` and `time` text commands on top of
+ * `lights_scene.c` and `device_time.c`. Scene replies report the scene
+ * state, times in microseconds:
+ *
+ *   OK SCENE staged=0x03 armed=1 at=81234567 commits=4 late_us=112
+ *
+ * `scene commit` takes the deadline in host time and converts it with the
+ * offset set by `time offset`, so one broadcast line serves every unit.
+ *
+ * The receive time t2 of `time sync` is taken when the command starts
+ * running, so time spent queued in the UART input counts as transit time;
+ * hosts should repeat the exchange and keep the sample with the shortest
+ * round trip.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "command_scene.h"
+#include "device_time.h"
+#include "input_parser.h"
+#include "lights_scene.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_scene, LOG_LEVEL_INF);
+
+/**
+ * @brief Print the scene state in the text command reply format.
+ */
+static void command_scene_report(void)
+{
+	struct lights_scene_status status;
+	char buf[112];
+
+	lights_scene_get_status(&status);
+	int len = snprintf(buf, sizeof(buf), "OK SCENE staged=0x%02x armed=%d at=%lld commits=%u late_us=%lld\r\n",
+			   status.staged, status.armed ? 1 : 0, (long long)status.deadline_us,
+			   status.commits, (long long)status.last_late_us);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Handle `scene stage <ch> <on|off> <level>`.
+ */
+static int command_scene_stage(char **argv)
+{
+	uint32_t channel;
+	int32_t level;
+	bool on;
+
+	if (input_parser_parse_uint(argv[0], &channel) < 0 ||
+	    input_parser_parse_on_off(argv[1], &on) < 0 ||
+	    input_parser_parse_int(argv[2], &level) < 0) {
+		return -EINVAL;
+	}
+
+	return lights_scene_stage(channel, on, level);
+}
+
+int command_scene_execute_args(int argc, char **argv)
+{
+	int64_t host_us;
+	int ret = -EINVAL;
+
+	if (argc == 5 && strcmp(argv[1], "stage") == 0) {
+		ret = command_scene_stage(&argv[2]);
+	} else if (argc == 3 && strcmp(argv[1], "commit") == 0) {
+		if (input_parser_parse_int64(argv[2], &host_us) == 0) {
+			ret = lights_scene_commit_at(device_time_from_host(host_us));
+		}
+	} else if (argc == 2 && strcmp(argv[1], "clear") == 0) {
+		lights_scene_clear();
+		ret = 0;
+	} else if (argc == 2 && strcmp(argv[1], "status") == 0) {
+		ret = 0;
+	}
+
+	if (ret == 0) {
+		command_scene_report();
+	} else if (ret == -EBUSY) {
+		uart_handler_write_literal("ERROR scene commit pending\r\n");
+	} else if (ret == -ENODATA) {
+		uart_handler_write_literal("ERROR nothing staged\r\n");
+	} else {
+		uart_handler_write_literal("ERROR usage: scene stage <ch> <on|off> <level>"
+					   " | scene commit <time_us> | scene clear | scene status\r\n");
+		LOG_WRN("Invalid scene text command (argc=%d)", argc);
+	}
+
+	return ret;
+}
+
+int command_scene_time_execute_args(int argc, char **argv)
+{
+	int64_t t2 = device_time_now_us();
+	int64_t value;
+	char buf[96];
+	int len;
+
+	if (argc == 1) {
+		len = snprintf(buf, sizeof(buf), "OK TIME now=%lld offset=%lld host=%lld\r\n",
+			       (long long)t2, (long long)device_time_get_offset(),
+			       (long long)device_time_to_host(t2));
+	} else if (argc == 3 && strcmp(argv[1], "sync") == 0 &&
+		   input_parser_parse_int64(argv[2], &value) == 0) {
+		len = snprintf(buf, sizeof(buf), "OK TIME t1=%lld t2=%lld t3=", (long long)value,
+			       (long long)t2);
+
+		/* t3 as late as possible: right before the reply is queued */
+		len += snprintf(buf + len, sizeof(buf) - len, "%lld\r\n", (long long)device_time_now_us());
+	} else if (argc == 3 && strcmp(argv[1], "offset") == 0 &&
+		   input_parser_parse_int64(argv[2], &value) == 0) {
+		device_time_set_offset(value);
+		len = snprintf(buf, sizeof(buf), "OK TIME offset=%lld\r\n", (long long)value);
+	} else {
+		uart_handler_write_literal("ERROR usage: time | time sync <t1> | time offset <us>\r\n");
+		LOG_WRN("Invalid time text command (argc=%d)", argc);
+		return -EINVAL;
+	}
+
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+	return 0;
+}
@@ -16,15 +16,27 @@
  * The design approach:
  * - Professional: Uses descriptive comments, structured logging, and robust error handling.
  * - Maintainable: Easy to add new sensor commands by extending the switch-case.
- * - Comprehensive: Provides clear user feedback via `uart_handler_write_string()`
+ * - Comprehensive: Provides clear user feedback via `uart_handler_write_literal()`
  *   and logs all actions and errors for easier debugging.
  *
  * Examples of actions:
  *   action_id=0: Read temperature
  *   action_id=1: Read humidity
+ *   action_id=2: Read ambient light
  * Additional actions can be added as needed. If an action_id is unrecognized, it
  * logs a warning and informs the user that the command is invalid.
  *
+ * Text commands:
+ *   sensor read <channel>
+ *   sensor filter <channel>                       (show the filter chain)
+ *   sensor filter <channel> none                  (disable filtering)
+ *   sensor filter <channel> <type> <param> ...    (e.g., median 5 ewma 64)
+ *   sensor sample <channel> <count> <interval_ms> (min/avg/max of a series)
+ * Channels are named as in sensor_readings.c (temperature, humidity,
+ * ambient_light); values are reported in milli-units. Readings are the
+ * channel's current filtered value; `sensor read` also reports its update
+ * count, which advances whenever the periodic sampler emits a new value.
+ *
  * @author Ameed Othman
  * @date 2024-12-21
  */
@@ -32,12 +44,33 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <stdio.h>
+#include <string.h>
+#include "command_async.h"
 #include "command_sensors.h"
+#include "input_parser.h"
 #include "sensor_readings.h"
 #include "uart_handler.h"
 
 LOG_MODULE_REGISTER(command_sensors, LOG_LEVEL_INF);
 
+/* Longest series and spacing accepted by `sensor sample` */
+#define COMMAND_SENSORS_SAMPLE_MAX 1000
+#define COMMAND_SENSORS_INTERVAL_MAX_MS 60000
+
+/* Progress of `sensor sample`, kept in the async command across waits */
+struct command_sensors_sample {
+	int64_t sum;
+	int32_t min;
+	int32_t max;
+	uint32_t interval_ms;
+	uint16_t count;
+	uint16_t taken;
+	uint8_t channel;
+};
+
+BUILD_ASSERT(sizeof(struct command_sensors_sample) <= COMMAND_ASYNC_DATA_SIZE,
+	     "sensor sample state does not fit in an async command");
+
 /**
  * @brief Execute a sensors-related command.
  *
@@ -52,39 +85,206 @@ void command_sensors_execute(int action_id)
 	LOG_INF("command_sensors_execute called with action_id=%d", action_id);
 
 	int ret;
+	int value;
 	char buf[64];
 
 	switch (action_id) {
 	case 0:
 		/* Example: Read a temperature sensor value */
-		ret = sensor_readings_get_temperature();
-		if (ret >= 0) {
-			snprintf(buf, sizeof(buf), "Temperature: %d C\r\n", ret);
-			uart_handler_write_string(buf);
-			LOG_INF("Temperature read successfully: %d C", ret);
+		ret = sensor_readings_get_temperature(&value);
+		if (ret == 0) {
+			int len = snprintf(buf, sizeof(buf), "Temperature: %d C\r\n", value);
+			uart_handler_write_formatted(buf, sizeof(buf), len);
+			LOG_INF("Temperature read successfully: %d C", value);
 		} else {
-			uart_handler_write_string("Failed to read temperature.\r\n");
+			uart_handler_write_literal("Failed to read temperature.\r\n");
 			LOG_ERR("Failed to read temperature, error code=%d", ret);
 		}
 		break;
 
 	case 1:
 		/* Example: Read a humidity sensor value */
-		ret = sensor_readings_get_humidity();
-		if (ret >= 0) {
-			snprintf(buf, sizeof(buf), "Humidity: %d%%\r\n", ret);
-			uart_handler_write_string(buf);
-			LOG_INF("Humidity read successfully: %d%%", ret);
+		ret = sensor_readings_get_humidity(&value);
+		if (ret == 0) {
+			int len = snprintf(buf, sizeof(buf), "Humidity: %d%%\r\n", value);
+			uart_handler_write_formatted(buf, sizeof(buf), len);
+			LOG_INF("Humidity read successfully: %d%%", value);
 		} else {
-			uart_handler_write_string("Failed to read humidity.\r\n");
+			uart_handler_write_literal("Failed to read humidity.\r\n");
 			LOG_ERR("Failed to read humidity, error code=%d", ret);
 		}
 		break;
 
+	case 2:
+		/* Read the ambient light sensor used by the lights regulator */
+		ret = sensor_readings_get_ambient_light(&value);
+		if (ret == 0) {
+			int len = snprintf(buf, sizeof(buf), "Ambient light: %d lx\r\n", value);
+			uart_handler_write_formatted(buf, sizeof(buf), len);
+			LOG_INF("Ambient light read successfully: %d lx", value);
+		} else {
+			uart_handler_write_literal("Failed to read ambient light.\r\n");
+			LOG_ERR("Failed to read ambient light, error code=%d", ret);
+		}
+		break;
+
 	default:
 		/* Invalid action_id */
-		uart_handler_write_string("Invalid sensors command.\r\n");
+		uart_handler_write_literal("Invalid sensors command.\r\n");
 		LOG_WRN("Invalid sensors action_id=%d provided to command_sensors_execute", action_id);
 		break;
 	}
 }
+
+/**
+ * @brief Print the filter chain of a channel, e.g. "OK FILTER humidity median 5".
+ */
+static void command_sensors_report_filters(enum sensor_readings_channel channel)
+{
+	struct sensor_filter_config configs[SENSOR_FILTER_STAGES_MAX];
+	char buf[96];
+	int count = sensor_readings_get_filters(channel, configs, ARRAY_SIZE(configs));
+	int len = snprintf(buf, sizeof(buf), "OK FILTER %s", sensor_readings_channel_name(channel));
+
+	if (count == 0) {
+		len += snprintf(buf + len, sizeof(buf) - len, " none");
+	}
+	for (int i = 0; i < count && len < (int)sizeof(buf); i++) {
+		len += snprintf(buf + len, sizeof(buf) - len, " %s %d",
+				sensor_filter_type_name(configs[i].type), configs[i].param);
+	}
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+	uart_handler_write_literal("\r\n");
+}
+
+/**
+ * @brief Handle `sensor filter <channel> [none | <type> <param> ...]`.
+ */
+static int command_sensors_filter(enum sensor_readings_channel channel, int argc, char **argv)
+{
+	struct sensor_filter_config configs[SENSOR_FILTER_STAGES_MAX];
+	size_t count = 0;
+
+	if (argc == 1 && strcmp(argv[0], "none") == 0) {
+		argc = 0;
+	} else if (argc % 2 != 0 || argc / 2 > SENSOR_FILTER_STAGES_MAX) {
+		return -EINVAL;
+	}
+
+	for (int i = 0; i < argc; i += 2) {
+		int type = sensor_filter_type_from_name(argv[i]);
+
+		if (type < 0 || input_parser_parse_int(argv[i + 1], &configs[count].param) < 0) {
+			return -EINVAL;
+		}
+		configs[count++].type = type;
+	}
+
+	return sensor_readings_set_filters(channel, configs, count);
+}
+
+/**
+ * @brief Take one reading of a `sensor sample` series, then wait for the next.
+ */
+static int command_sensors_sample_step(struct command_async *cmd)
+{
+	struct command_sensors_sample *sample = (struct command_sensors_sample *)cmd->data;
+	int32_t value;
+	char buf[96];
+
+	int ret = sensor_readings_get(sample->channel, &value, NULL);
+	if (ret < 0) {
+		uart_handler_write_literal("ERROR sensor read failed\r\n");
+		return ret;
+	}
+
+	sample->min = sample->taken == 0 ? value : MIN(sample->min, value);
+	sample->max = sample->taken == 0 ? value : MAX(sample->max, value);
+	sample->sum += value;
+	sample->taken++;
+
+	if (sample->taken < sample->count) {
+		return command_async_sleep(cmd, sample->interval_ms);
+	}
+
+	int len = snprintf(buf, sizeof(buf), "OK SAMPLE %s n=%u min=%d avg=%d max=%d\r\n",
+			   sensor_readings_channel_name(sample->channel), sample->taken, sample->min,
+			   (int32_t)(sample->sum / sample->taken), sample->max);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+	return 0;
+}
+
+/**
+ * @brief Handle `sensor sample <channel> <count> <interval_ms>`.
+ */
+static int command_sensors_sample(enum sensor_readings_channel channel, char **argv,
+				  struct command_async **out)
+{
+	int32_t count;
+	int32_t interval_ms;
+
+	if (input_parser_parse_int(argv[0], &count) < 0 || count < 1 ||
+	    count > COMMAND_SENSORS_SAMPLE_MAX ||
+	    input_parser_parse_int(argv[1], &interval_ms) < 0 || interval_ms < 1 ||
+	    interval_ms > COMMAND_SENSORS_INTERVAL_MAX_MS) {
+		return -EINVAL;
+	}
+
+	struct command_async *cmd = command_async_alloc();
+	if (!cmd) {
+		uart_handler_write_literal("ERROR busy\r\n");
+		return -EBUSY;
+	}
+
+	struct command_sensors_sample *sample = (struct command_sensors_sample *)cmd->data;
+
+	sample->channel = channel;
+	sample->count = count;
+	sample->interval_ms = interval_ms;
+	cmd->step = command_sensors_sample_step;
+	*out = cmd;
+	return COMMAND_ASYNC_PENDING;
+}
+
+int command_sensors_execute_args(int argc, char **argv, struct command_async **cmd)
+{
+	int ret = -EINVAL;
+	int channel = argc >= 3 ? sensor_readings_channel_from_name(argv[2]) : -EINVAL;
+	int32_t value;
+	char buf[64];
+
+	if (channel < 0) {
+		/* Fall through to the usage message */
+	} else if (argc == 3 && strcmp(argv[1], "read") == 0) {
+		uint32_t updates;
+
+		ret = sensor_readings_get(channel, &value, &updates);
+		if (ret == 0) {
+			int len = snprintf(buf, sizeof(buf), "OK SENSOR %s=%d updates=%u\r\n", argv[2],
+					   value, updates);
+			uart_handler_write_formatted(buf, sizeof(buf), len);
+			return 0;
+		}
+		uart_handler_write_literal("ERROR sensor read failed\r\n");
+		return ret;
+	} else if (argc == 5 && strcmp(argv[1], "sample") == 0) {
+		ret = command_sensors_sample(channel, &argv[3], cmd);
+		if (ret != -EINVAL) {
+			return ret;
+		}
+	} else if (strcmp(argv[1], "filter") == 0) {
+		ret = argc == 3 ? 0 : command_sensors_filter(channel, argc - 3, &argv[3]);
+		if (ret == 0) {
+			command_sensors_report_filters(channel);
+		}
+	}
+
+	if (ret < 0) {
+		uart_handler_write_literal("ERROR usage: sensor read <channel>"
+					   " | sensor filter <channel> [none | <type> <param> ...]"
+					   " | sensor sample <channel> <count> <interval_ms>\r\n");
+		LOG_WRN("Invalid sensor text command (argc=%d)", argc);
+	}
+
+	return ret;
+}
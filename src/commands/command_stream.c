@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_stream.c
+ * @brief Streaming, chunked command output.
+ *
+ * Description:
+ * ------------
+ * This file implements the engine side of `command_stream.h`. The engine owns
+ * a single chunk buffer on its stack. Before asking the producer for the next
+ * chunk it waits until the UART TX ring buffer can accept a full chunk, so a
+ * chunk is never produced before it can be queued, and the producer is never
+ * asked to buffer more than one chunk ahead of the wire.
+ *
+ * Author: Ameed Othman
+ * Date: 2024-12-21
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "app_config.h"
+#include "command_stream.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_stream, LOG_LEVEL_INF);
+
+int command_stream_run(struct command_stream *stream)
+{
+	char chunk[COMMAND_STREAM_CHUNK_SIZE];
+	unsigned int chunks = 0;
+
+	if (!stream || !stream->next) {
+		return -EINVAL;
+	}
+
+	while (true) {
+		if (uart_handler_abort_pending()) {
+			LOG_INF("Stream aborted after %u chunks", chunks);
+			return -ECANCELED;
+		}
+
+		int ret = uart_handler_tx_wait_space(sizeof(chunk),
+						     K_MSEC(COMMAND_STREAM_TX_TIMEOUT_MS));
+		if (ret < 0) {
+			LOG_WRN("Stream stopped after %u chunks waiting for TX (err %d)", chunks, ret);
+			return ret;
+		}
+
+		int len = stream->next(stream, chunk, sizeof(chunk));
+		if (len < 0) {
+			LOG_ERR("Stream producer failed after %u chunks (err %d)", chunks, len);
+			return len;
+		}
+
+		if (len == 0) {
+			break;
+		}
+
+		/* snprintf()-style producers report the untruncated length */
+		if ((size_t)len >= sizeof(chunk)) {
+			len = sizeof(chunk) - 1;
+		}
+
+		ret = uart_handler_write(chunk, len);
+		if (ret < 0) {
+			return ret;
+		}
+		chunks++;
+	}
+
+	LOG_DBG("Stream finished after %u chunks", chunks);
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_sync.c
+ * @brief Delta sync command logic.
+ *
+ * Description:
+ * ------------
+ * This file implements the `sync <since>` text command. Instead of pulling
+ * the full device state, a monitoring host sends the last global change
+ * sequence number it has seen and receives only the objects (lights
+ * channels, config keys, sensor channels) whose last change is newer:
+ *
+ *   SYNC DELTA <since> <upto>
+ *   LIGHTS 3 on=1 level=40 ver=7 seq=<n>
+ *   CONFIG brightness_step=10 ver=2 seq=<n>
+ *   SENSOR temperature=22000 seq=<n>
+ *   SYNC END <upto> <objects>
+ *
+ * The host stores <upto> and passes it as <since> next time. An object that
+ * changes while the reply is being sent may appear in this reply and again in
+ * the next one, but is never missed.
+ *
+ * Sensor channels carry no version since they cannot be written; a failing
+ * sensor is listed as `SENSOR <name> err=<code> seq=<n>`.
+ *
+ * If <since> is 0, lies before this boot's sequence floor (the host last
+ * synced before a reset or the sequence rolled over), lies in the future,
+ * or cannot be trusted because the boot counter wrapped (see
+ * change_seq_is_stale()), the reply starts with `SYNC SNAPSHOT <upto>` and
+ * lists every object instead.
+ *
+ * The reply is produced as a command stream, one object per chunk.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+
+#include "change_seq.h"
+#include "command_stream.h"
+#include "command_sync.h"
+#include "config_store.h"
+#include "input_parser.h"
+#include "lights_control.h"
+#include "sensor_readings.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_sync, LOG_LEVEL_INF);
+
+/* Cursor positions: header, lights channels, config keys, sensors, trailer */
+#define SYNC_POS_LIGHTS 1U
+#define SYNC_POS_CONFIG (SYNC_POS_LIGHTS + LIGHTS_CHANNEL_COUNT)
+#define SYNC_POS_SENSORS (SYNC_POS_CONFIG + CONFIG_KEY_COUNT)
+#define SYNC_POS_END (SYNC_POS_SENSORS + SENSOR_READINGS_COUNT)
+
+struct sync_cursor {
+	uint32_t since;
+	uint32_t upto;
+	bool snapshot;
+	unsigned int objects;
+};
+
+/**
+ * @brief Decide whether an object belongs in the reply.
+ */
+static bool command_sync_wanted(const struct sync_cursor *cursor, uint32_t change_seq)
+{
+	return cursor->snapshot || change_seq > cursor->since;
+}
+
+/**
+ * @brief Stream producer: one header, changed objects, one trailer.
+ */
+static int command_sync_next(struct command_stream *stream, char *buf, size_t len)
+{
+	struct sync_cursor *cursor = stream->ctx;
+
+	while (stream->position <= SYNC_POS_END) {
+		uint32_t pos = stream->position++;
+
+		if (pos == 0) {
+			if (cursor->snapshot) {
+				return snprintf(buf, len, "SYNC SNAPSHOT %u\r\n", cursor->upto);
+			}
+			return snprintf(buf, len, "SYNC DELTA %u %u\r\n", cursor->since, cursor->upto);
+		}
+
+		if (pos < SYNC_POS_CONFIG) {
+			struct lights_channel_state state;
+			unsigned int channel = pos - SYNC_POS_LIGHTS;
+
+			if (lights_control_get_channel(channel, &state) < 0 ||
+			    !command_sync_wanted(cursor, state.change_seq)) {
+				continue;
+			}
+
+			cursor->objects++;
+			return snprintf(buf, len, "LIGHTS %u on=%d level=%d ver=%u seq=%u\r\n", channel,
+					state.on ? 1 : 0, state.level, state.version, state.change_seq);
+		}
+
+		if (pos < SYNC_POS_SENSORS) {
+			enum config_key key = pos - SYNC_POS_CONFIG;
+			uint32_t change_seq = config_store_change_seq(key);
+			uint32_t version;
+			int32_t value;
+
+			if (!command_sync_wanted(cursor, change_seq) ||
+			    config_store_get(key, &value, &version) < 0) {
+				continue;
+			}
+
+			cursor->objects++;
+			return snprintf(buf, len, "CONFIG %s=%d ver=%u seq=%u\r\n",
+					config_store_key_name(key), value, version, change_seq);
+		}
+
+		if (pos < SYNC_POS_END) {
+			enum sensor_readings_channel channel = pos - SYNC_POS_SENSORS;
+			uint32_t change_seq = sensor_readings_change_seq(channel);
+			int32_t value;
+			int ret;
+
+			if (change_seq == 0 || !command_sync_wanted(cursor, change_seq)) {
+				continue;
+			}
+
+			cursor->objects++;
+			ret = sensor_readings_get(channel, &value, NULL);
+			if (ret < 0) {
+				return snprintf(buf, len, "SENSOR %s err=%d seq=%u\r\n",
+						sensor_readings_channel_name(channel), ret, change_seq);
+			}
+			return snprintf(buf, len, "SENSOR %s=%d seq=%u\r\n",
+					sensor_readings_channel_name(channel), value, change_seq);
+		}
+
+		return snprintf(buf, len, "SYNC END %u %u\r\n", cursor->upto, cursor->objects);
+	}
+
+	return 0;
+}
+
+int command_sync_execute_args(int argc, char **argv)
+{
+	uint32_t since;
+
+	if (argc != 2 || input_parser_parse_uint(argv[1], &since) < 0) {
+		uart_handler_write_literal("ERROR usage: sync <since>\r\n");
+		return -EINVAL;
+	}
+
+	struct sync_cursor cursor = {
+		.since = since,
+		.upto = change_seq_current(),
+	};
+
+	cursor.snapshot = (since == 0 || since > cursor.upto || change_seq_is_stale(since));
+
+	struct command_stream stream = {
+		.next = command_sync_next,
+		.ctx = &cursor,
+	};
+
+	LOG_INF("sync since=%u upto=%u snapshot=%d", since, cursor.upto, cursor.snapshot);
+	return command_stream_run(&stream);
+}
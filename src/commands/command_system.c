@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file command_system.c
+ * @brief System configuration command logic.
+ *
+ * Description:
+ * ------------
+ * This file bridges the commands subsystem and the config store. From the
+ * menu (category=3) it lists the configuration; as text commands it reads
+ * and writes single keys. Writes may be conditional on the key's version
+ * (`config cas`), in which case a stale version is answered with CONFLICT and
+ * the current value instead of applying the write.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "command_system.h"
+#include "config_store.h"
+#include "input_parser.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(command_system, LOG_LEVEL_INF);
+
+/**
+ * @brief Print one key in the text command reply format.
+ *
+ * @param status Reply status word ("OK", "CONFLICT"), or NULL for a plain read.
+ * @param key The key to print.
+ */
+static void command_system_report(const char *status, enum config_key key)
+{
+	char buf[64];
+	int32_t value;
+	uint32_t version;
+
+	if (config_store_get(key, &value, &version) < 0) {
+		return;
+	}
+
+	int len = snprintf(buf, sizeof(buf), "%s%sCONFIG %s=%d ver=%u\r\n", status ? status : "",
+			   status ? " " : "", config_store_key_name(key), value, version);
+	uart_handler_write_formatted(buf, sizeof(buf), len);
+}
+
+/**
+ * @brief Print every configuration key.
+ */
+static void command_system_list(void)
+{
+	for (int key = 0; key < CONFIG_KEY_COUNT; key++) {
+		command_system_report(NULL, key);
+	}
+}
+
+void command_system_execute(int action_id)
+{
+	LOG_INF("command_system_execute called with action_id=%d", action_id);
+
+	switch (action_id) {
+	case 0:
+		command_system_list();
+		break;
+	default:
+		uart_handler_write_literal("Invalid system command.\r\n");
+		LOG_WRN("Invalid system action_id=%d provided to command_system_execute", action_id);
+		break;
+	}
+}
+
+/**
+ * @brief Handle `config set` and `config cas`.
+ *
+ * @param argv Arguments after the sub-command: <name> [<version>] <value>.
+ * @param conditional True for `cas` (argv carries a version).
+ * @return 0 if a reply was sent, or -EINVAL for malformed arguments.
+ */
+static int command_system_write(char **argv, bool conditional)
+{
+	uint32_t version = CONFIG_STORE_VERSION_ANY;
+	int32_t value;
+	int i = 0;
+
+	int key = config_store_key_from_name(argv[i++]);
+	if (key < 0 ||
+	    (conditional && input_parser_parse_uint(argv[i++], &version) < 0) ||
+	    input_parser_parse_int(argv[i++], &value) < 0) {
+		return -EINVAL;
+	}
+
+	/* Version 0 would turn a conditional write into an unconditional one */
+	if (conditional && version == CONFIG_STORE_VERSION_ANY) {
+		return -EINVAL;
+	}
+
+	int ret = config_store_set(key, value, version, NULL, NULL);
+	if (ret == -EAGAIN) {
+		command_system_report("CONFLICT", key);
+		return 0;
+	} else if (ret < 0) {
+		return ret;
+	}
+
+	command_system_report("OK", key);
+	return 0;
+}
+
+int command_system_execute_args(int argc, char **argv)
+{
+	int ret = -EINVAL;
+
+	if (argc == 2 && strcmp(argv[1], "list") == 0) {
+		command_system_list();
+		ret = 0;
+	} else if (argc == 3 && strcmp(argv[1], "get") == 0) {
+		int key = config_store_key_from_name(argv[2]);
+		if (key >= 0) {
+			command_system_report(NULL, key);
+			ret = 0;
+		}
+	} else if (argc == 4 && strcmp(argv[1], "set") == 0) {
+		ret = command_system_write(&argv[2], false);
+	} else if (argc == 5 && strcmp(argv[1], "cas") == 0) {
+		ret = command_system_write(&argv[2], true);
+	}
+
+	if (ret < 0) {
+		uart_handler_write_literal("ERROR usage: config list | config get <name>"
+					   " | config set <name> <value> | config cas <name> <ver> <value>\r\n");
+		LOG_WRN("Invalid config text command (argc=%d)", argc);
+	}
+
+	return ret;
+}
@@ -18,8 +18,18 @@
  * --------
  * - Removed placeholder messages for lights commands.
  * - Integrated `command_lights_execute()` for the lights category to leverage real logic.
- * - For sensors, system, and diagnostics, we now print a "Not implemented yet" message 
- *   instead of generic placeholders, making it clear that these features are pending.
+ * - Sensors read the sensor driver through `command_sensors_execute()`.
+ * - Diagnostics list the event log through `command_events_execute()`.
+ * 
+ * Text commands:
+ * --------------
+ * commands_core_execute_line() accepts one-line text commands (e.g.,
+ * `lights cas 2 7 on 40`, `config get brightness_step`). The first word
+ * selects the handler from a table; the handler receives the tokenized line.
+ * Lines starting with `@` are addressed commands (see command_gateway.h).
+ * Commands that wait (e.g., `sensor sample`) run as async commands on the
+ * system workqueue; commands_core_execute_line_async() returns while they
+ * run, commands_core_execute_line() waits for them.
  * 
  * With these changes, selecting a lights option should now route through 
  * `command_lights_execute()` and subsequently `lights_control.c`, displaying 
@@ -32,12 +42,56 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include <string.h>
+
 #include "commands.h"
+#include "input_parser.h"
 #include "uart_handler.h"
+#include "command_async.h"
+#include "command_events.h"
+#include "command_gateway.h"
 #include "command_lights.h"  // Ensure this header provides `command_lights_execute()` prototype
+#include "command_regulator.h"
+#include "command_scene.h"
+#include "command_sensors.h"
+#include "command_sync.h"
+#include "command_system.h"
 
 LOG_MODULE_REGISTER(commands_core, LOG_LEVEL_INF);
 
+/* Maximum number of words in a text command */
+#define COMMANDS_MAX_ARGS 12
+
+/*
+ * Text command handler, selected by the first word of the line. Handlers of
+ * commands that wait have the async signature: they may set up an async
+ * command (see command_async.h), store it in *cmd and return
+ * COMMAND_ASYNC_PENDING; the dispatcher then runs it.
+ */
+struct commands_core_text_command {
+	const char *name;
+	int (*handler)(int argc, char **argv);
+	int (*async_handler)(int argc, char **argv, struct command_async **cmd);
+};
+
+static const struct commands_core_text_command text_commands[] = {
+	{ "lights", NULL, command_lights_execute_args },
+	{ "config", command_system_execute_args, NULL },
+	{ "sync", command_sync_execute_args, NULL },
+	{ "events", command_events_execute_args, NULL },
+	{ "gateway", command_gateway_execute_args, NULL },
+	{ "regulator", command_regulator_execute_args, NULL },
+	{ "scene", command_scene_execute_args, NULL },
+	{ "time", command_scene_time_execute_args, NULL },
+	{ "sensor", NULL, command_sensors_execute_args },
+};
+
+/* Completion of an async command run by commands_core_execute_line() */
+struct commands_core_wait {
+	struct k_sem done;
+	int status;
+};
+
 /**
  * @brief Execute a command for lights control.
  *
@@ -54,41 +108,40 @@ static void commands_core_execute_lights(int action_id)
 /**
  * @brief Execute a command for sensor operations.
  *
- * Since sensor commands are not yet implemented, we clearly state that 
- * this feature is pending rather than using placeholders.
+ * Routes to `command_sensors_execute()`, which reads the sensor driver.
  *
  * @param action_id Identifies which sensor action to execute.
  */
 static void commands_core_execute_sensors(int action_id)
 {
-	uart_handler_write_string("Sensor commands not implemented yet.\r\n");
-	LOG_WRN("Sensor command requested but not implemented. action_id=%d", action_id);
+	LOG_INF("commands_core_execute_sensors: action_id=%d", action_id);
+	command_sensors_execute(action_id);
 }
 
 /**
  * @brief Execute a system configuration command.
  *
- * Clearly indicate that system configuration commands are not yet implemented.
+ * Routes to `command_system_execute()`, which reads the config store.
  *
  * @param action_id Identifies which system config action to execute.
  */
 static void commands_core_execute_system(int action_id)
 {
-	uart_handler_write_string("System configuration commands not implemented yet.\r\n");
-	LOG_WRN("System config command requested but not implemented. action_id=%d", action_id);
+	LOG_INF("commands_core_execute_system: action_id=%d", action_id);
+	command_system_execute(action_id);
 }
 
 /**
  * @brief Execute a diagnostic or logging command.
  *
- * Clearly indicate that diagnostic commands are not yet implemented.
+ * Routes to `command_events_execute()`, which reads the event log.
  *
  * @param action_id Identifies which diagnostic action to execute.
  */
 static void commands_core_execute_diagnostics(int action_id)
 {
-	uart_handler_write_string("Diagnostics commands not implemented yet.\r\n");
-	LOG_WRN("Diagnostics command requested but not implemented. action_id=%d", action_id);
+	LOG_INF("commands_core_execute_diagnostics: action_id=%d", action_id);
+	command_events_execute(action_id);
 }
 
 /**
@@ -99,11 +152,17 @@ static void commands_core_execute_diagnostics(int action_id)
  *
  * @param category The command category (1=Lights, 2=Sensors, 3=System config, 4=Diagnostics)
  * @param action_id The specific action within that category.
+ * @return 0 once the command has run, or -ECANCELED if an abort is pending.
  */
 int commands_core_execute(int category, int action_id)
 {
 	LOG_INF("commands_core_execute: category=%d, action_id=%d", category, action_id);
 
+	if (uart_handler_abort_pending()) {
+		LOG_WRN("Abort pending, dropping command category=%d", category);
+		return -ECANCELED;
+	}
+
 	switch (category) {
 	case 1:
 		commands_core_execute_lights(action_id);
@@ -118,10 +177,102 @@ int commands_core_execute(int category, int action_id)
 		commands_core_execute_diagnostics(action_id);
 		break;
 	default:
-		uart_handler_write_string("Invalid command category.\r\n");
+		uart_handler_write_literal("Invalid command category.\r\n");
 		LOG_WRN("Unknown command category: %d", category);
 		break;
 	}
 
 	return 0;
 }
+
+/**
+ * @brief Public API to execute a one-line text command without waiting.
+ *
+ * Tokenizes the line in place and dispatches on the first word. Async
+ * commands are started and the function returns while they run.
+ *
+ * @param line The command line (modified by tokenization).
+ * @param done Completion callback for async commands.
+ * @param user_data Value passed to the callback in the command.
+ * @return The result of a command that completed, COMMAND_ASYNC_PENDING if
+ *         @p done will report it, -ENOENT if the first word is not a
+ *         command, -ECANCELED if an abort is pending, or the handler's error
+ *         code (-EBUSY if too many async commands are in flight).
+ */
+int commands_core_execute_line_async(char *line, command_async_done_fn done, void *user_data)
+{
+	char *argv[COMMANDS_MAX_ARGS];
+
+	if (!line) {
+		return -EINVAL;
+	}
+
+	/* "@<address> <id> <command>": run here or forward downstream */
+	if (line[0] == '@') {
+		return command_gateway_execute_line(line);
+	}
+
+	int argc = input_parser_tokenize(line, argv, ARRAY_SIZE(argv));
+	if (argc <= 0) {
+		return argc == 0 ? -ENOENT : argc;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(text_commands); i++) {
+		const struct commands_core_text_command *entry = &text_commands[i];
+
+		if (strcmp(argv[0], entry->name) != 0) {
+			continue;
+		}
+
+		if (uart_handler_abort_pending()) {
+			return -ECANCELED;
+		}
+
+		LOG_INF("commands_core_execute_line: %s (argc=%d)", argv[0], argc);
+		if (entry->handler) {
+			return entry->handler(argc, argv);
+		}
+
+		struct command_async *cmd = NULL;
+		int ret = entry->async_handler(argc, argv, &cmd);
+
+		if (ret == COMMAND_ASYNC_PENDING) {
+			ret = command_async_submit(cmd, done, user_data);
+		}
+		return ret;
+	}
+
+	return -ENOENT;
+}
+
+static void commands_core_wake(struct command_async *cmd, int status)
+{
+	struct commands_core_wait *wait = cmd->user_data;
+
+	wait->status = status;
+	k_sem_give(&wait->done);
+}
+
+/**
+ * @brief Public API to execute a one-line text command.
+ *
+ * Like commands_core_execute_line_async(), but waits for async commands to
+ * complete. Must not be called from the system workqueue, which runs them.
+ *
+ * @param line The command line (modified by tokenization).
+ * @return 0 if the command ran, -ENOENT if the first word is not a command,
+ *         -ECANCELED if an abort is pending, or the handler's error code.
+ */
+int commands_core_execute_line(char *line)
+{
+	struct commands_core_wait wait;
+
+	k_sem_init(&wait.done, 0, 1);
+
+	int ret = commands_core_execute_line_async(line, commands_core_wake, &wait);
+	if (ret == COMMAND_ASYNC_PENDING) {
+		k_sem_take(&wait.done, K_FOREVER);
+		ret = wait.status;
+	}
+	return ret;
+}
@@ -26,6 +26,52 @@
  * As the project evolves, these placeholders can be replaced with real drivers 
  * or board-specific configurations.
  *
+ * Channels and versions:
+ * ----------------------
+ * The driver manages LIGHTS_CHANNEL_COUNT independent channels. The original
+ * single-light functions (turn_on, increase_brightness, ...) operate on
+ * channel 0. Every channel carries a version counter that is incremented on
+ * each change, which lets hosts perform conditional (compare-and-set) writes
+ * with lights_control_set_channel().
+ *
+ * Coalescing:
+ * -----------
+ * With the `coalesce_ms` config key set, a change updates the channel state
+ * and version at once (so replies and compare-and-set stay exact), but the
+ * hardware output, journal record and event are deferred to a commit that
+ * runs once per window for all channels changed within it. A channel
+ * written several times within a window is committed once with its last
+ * value (last writer wins); the superseded writes are counted as coalesced.
+ *
+ * Commits are numbered by stats.commits. A caller that must not reply before
+ * its change is on the outputs and in the journal (deferred acks) takes a
+ * ticket with lights_control_commit_ticket() and waits for that commit, so
+ * the window still merges a burst of host writes into one commit.
+ *
+ * Multi-channel writes:
+ * ---------------------
+ * lights_control_set_channels() takes a channel bitmask and stages every
+ * selected channel before a single commit, so a write to many channels costs
+ * one lock and one commit instead of one per channel. Groups are named masks
+ * (LIGHTS_GROUP_COUNT of them) that channel selectors can refer to.
+ *
+ * Persistence:
+ * ------------
+ * Every state change is recorded in the state journal (state_journal.c), and
+ * lights_control_init() restores the last recorded state after a reset.
+ *
+ * Usage accounting:
+ * -----------------
+ * When a channel's output changes, the interval since its previous change is
+ * added to the channel's on-time, level-weighted duty and energy counters,
+ * and an off-to-on change counts a switch cycle. That is a few additions per
+ * commit; nothing runs while the outputs are steady. The counters are kept
+ * exact in RAM and journaled every LIGHTS_USAGE_PERSIST_S seconds (energy
+ * to the milliwatt-hour), so a reset loses at most that much usage. Energy
+ * is charged at `rating_w`, a copy of `rated_w` that only the config observer
+ * updates: it first charges the running intervals at the old rating, so no
+ * interval is ever charged at a rating set after it ran.
+ *
  * Future Improvements:
  * --------------------
  * - Integrate with actual GPIO or PWM drivers for LED control.
@@ -39,7 +85,12 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <string.h>
 #include <lights_control.h>
+#include "change_seq.h"
+#include "config_store.h"
+#include "event_log.h"
+#include "state_journal.h"
 
 // If needed, include additional Zephyr headers for GPIO, PWM, or device trees.
 // #include <zephyr/drivers/gpio.h>
@@ -47,44 +98,430 @@
 
 LOG_MODULE_REGISTER(lights_control, LOG_LEVEL_INF);
 
+BUILD_ASSERT(LIGHTS_CHANNEL_COUNT <= STATE_JOURNAL_LIGHTS_CHANNELS,
+	     "lights channels exceed the journal key layout");
+
 /*
  * Internal State Variables:
  * -------------------------
- * For demonstration purposes, we maintain a simple internal state of lights:
- *   - on_state: A boolean indicating if the lights are ON (true) or OFF (false).
- *   - brightness: An integer representing the current brightness level (0-100%).
+ * For demonstration purposes, we maintain a simple internal state per channel:
+ *   - on: A boolean indicating if the channel is ON (true) or OFF (false).
+ *   - level: An integer representing the current brightness level (0-100%).
+ *   - version: Incremented on every change, starting at
+ *     change_seq_first_version() so versions do not repeat across boots.
+ *   - change_seq: Global sequence number of the last change, for delta sync.
  *
  * These are placeholders and do not reflect actual hardware states yet.
+ * All access is serialized by lights_lock.
+ */
+static struct lights_channel_state channels[LIGHTS_CHANNEL_COUNT] = {
+	/* Start at 50% brightness as a default placeholder */
+	[0 ... LIGHTS_CHANNEL_COUNT - 1] = { .on = false, .level = 50, .version = 1 },
+};
+static K_MUTEX_DEFINE(lights_lock);
+
+/*
+ * Output stage:
+ *   - outputs: state last committed to the hardware (and journal).
+ *   - dirty: channels changed since the last commit.
+ *   - stats: write and commit counters.
+ */
+struct lights_output {
+	bool on;
+	int level;
+};
+
+static struct lights_output outputs[LIGHTS_CHANNEL_COUNT];
+static uint32_t dirty;
+static struct lights_control_stats stats;
+
+/* Raised/broadcast after every commit, for waiters on a commit ticket */
+static K_CONDVAR_DEFINE(commit_cv);
+static struct k_poll_signal commit_signal = K_POLL_SIGNAL_INITIALIZER(commit_signal);
+
+/*
+ * Usage accumulators, in units that need no division on update:
+ *   - since_ms: uptime when the output last changed (or was accounted).
+ *   - level_ms: sum of level (percent) times on-time.
+ *   - energy: sum of rated watts times level times on-time (W * % * ms).
+ */
+struct lights_usage_acc {
+	int64_t since_ms;
+	uint64_t on_ms;
+	uint64_t level_ms;
+	uint64_t energy;
+	uint32_t cycles;
+};
+
+static struct lights_usage_acc usage[LIGHTS_CHANNEL_COUNT];
+
+/* Rating the usage intervals are charged at, in watts (see rating_changed) */
+static int32_t rating_w;
+
+/* Channel groups, for selectors like "g1" */
+static uint32_t groups[LIGHTS_GROUP_COUNT];
+
+#define LIGHTS_ALL_CHANNELS GENMASK(LIGHTS_CHANNEL_COUNT - 1, 0)
+
+BUILD_ASSERT(LIGHTS_GROUP_COUNT <= STATE_JOURNAL_LIGHTS_GROUPS,
+	     "lights groups exceed the journal key layout");
+
+/* W * % * ms per mWh and per Wh */
+#define LIGHTS_USAGE_PER_MWH (100ULL * 3600ULL)
+#define LIGHTS_USAGE_PER_WH (1000ULL * LIGHTS_USAGE_PER_MWH)
+
+static void lights_control_commit_work_handler(struct k_work *work);
+static void lights_control_usage_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(commit_work, lights_control_commit_work_handler);
+static K_WORK_DELAYABLE_DEFINE(usage_work, lights_control_usage_work_handler);
+
+/**
+ * @brief Record a lights state change in the state journal.
+ *
+ * The journal commits in the background; callers that must acknowledge only
+ * durable changes wait with state_journal_wait_committed(). Running without
+ * an initialized journal (e.g., in unit tests) is not an error.
+ *
+ * @param key The journal key of the changed value.
+ * @param value The new value.
+ */
+static void lights_control_persist(uint16_t key, int32_t value)
+{
+	int ret = state_journal_append(key, value);
+	if (ret < 0 && ret != -ENODEV) {
+		LOG_WRN("Failed to journal lights state key=%u (err %d)", key, ret);
+	}
+}
+
+/**
+ * @brief Add the time since the last output change to a channel's usage.
+ *
+ * Must be called with lights_lock held, before the output or rating changes.
+ *
+ * @param channel Channel index.
+ * @param now Current uptime in milliseconds.
  */
-static bool on_state = false;
-static int brightness = 50; // Start at 50% brightness as a default placeholder
+static void lights_control_account(unsigned int channel, int64_t now)
+{
+	struct lights_usage_acc *acc = &usage[channel];
+	const struct lights_output *out = &outputs[channel];
+	int64_t elapsed = now - acc->since_ms;
+
+	if (out->on && elapsed > 0) {
+		uint64_t level_ms = (uint64_t)out->level * (uint64_t)elapsed;
+
+		acc->on_ms += elapsed;
+		acc->level_ms += level_ms;
+		acc->energy += level_ms * (uint64_t)rating_w;
+	}
+	acc->since_ms = now;
+}
+
+/**
+ * @brief Commit one channel's state to the hardware output.
+ *
+ * Journals the values that differ from the last committed output and
+ * records the change in the event log. Must be called with lights_lock held.
+ *
+ * @param channel Channel index.
+ */
+static void lights_control_commit_channel(unsigned int channel)
+{
+	struct lights_channel_state *ch = &channels[channel];
+	struct lights_output *out = &outputs[channel];
+
+	lights_control_account(channel, k_uptime_get());
+	if (!out->on && ch->on) {
+		usage[channel].cycles++;
+	}
+
+	// Placeholder: drive the channel's GPIO/PWM output here.
+	if (out->on != ch->on) {
+		lights_control_persist(STATE_KEY_LIGHTS_ON_CH(channel), ch->on ? 1 : 0);
+	}
+	if (out->level != ch->level) {
+		lights_control_persist(STATE_KEY_LIGHTS_LEVEL_CH(channel), ch->level);
+	}
+
+	out->on = ch->on;
+	out->level = ch->level;
+	ch->change_seq = event_log_record(EVENT_LIGHTS, channel, ch->level, ch->on);
+}
+
+/**
+ * @brief Commit all changed channels at once. Must be called with lights_lock held.
+ */
+static void lights_control_commit(void)
+{
+	uint32_t pending = dirty;
+
+	if (pending == 0) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+		if (pending & BIT(i)) {
+			lights_control_commit_channel(i);
+		}
+	}
+
+	dirty = 0;
+	stats.commits++;
+	k_condvar_broadcast(&commit_cv);
+	k_poll_signal_raise(&commit_signal, 0);
+	LOG_DBG("Committed lights outputs 0x%08x", pending);
+}
+
+static void lights_control_commit_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	lights_control_commit();
+	k_mutex_unlock(&lights_lock);
+}
+
+/**
+ * @brief Journal one usage counter if it changed since the last save.
+ */
+static void lights_control_persist_usage(uint16_t key, uint64_t value)
+{
+	int32_t saved;
+
+	if (state_journal_get(key, &saved) == 0 && (uint32_t)saved == (uint32_t)value) {
+		return;
+	}
+	lights_control_persist(key, (int32_t)(uint32_t)value);
+}
+
+/**
+ * @brief Journal a channel's energy if it changed since the last save.
+ *
+ * The whole Wh and the mWh remainder are two keys; they are appended as
+ * one batch so a commit (or a reset) never leaves a mismatched pair.
+ */
+static void lights_control_persist_energy(unsigned int channel, uint64_t energy_mwh)
+{
+	const struct state_journal_update updates[] = {
+		{ STATE_KEY_USAGE_CH(channel, STATE_USAGE_ENERGY_WH),
+		  (int32_t)(uint32_t)(energy_mwh / 1000U) },
+		{ STATE_KEY_USAGE_ENERGY_MWH_CH(channel), (int32_t)(energy_mwh % 1000U) },
+	};
+	bool changed = false;
+	int32_t saved;
+
+	for (size_t i = 0; i < ARRAY_SIZE(updates); i++) {
+		if (state_journal_get(updates[i].key, &saved) != 0 || saved != updates[i].value) {
+			changed = true;
+		}
+	}
+	if (!changed) {
+		return;
+	}
+
+	int ret = state_journal_append_batch(updates, ARRAY_SIZE(updates));
+	if (ret < 0 && ret != -ENODEV) {
+		LOG_WRN("Failed to journal lights energy ch=%u (err %d)", channel, ret);
+	}
+}
+
+/**
+ * @brief Restore the usage counters of one channel from the journal.
+ *
+ * Counters are saved in whole units (seconds, cycles, milliwatt-hours), so
+ * up to one unit per counter is lost across a reset. Must be called with
+ * lights_lock held.
+ */
+static void lights_control_restore_usage(unsigned int channel, int64_t now)
+{
+	struct lights_usage_acc *acc = &usage[channel];
+	int32_t value;
+
+	*acc = (struct lights_usage_acc){ .since_ms = now };
+	if (state_journal_get(STATE_KEY_USAGE_CH(channel, STATE_USAGE_ON_S), &value) == 0) {
+		acc->on_ms = (uint64_t)(uint32_t)value * 1000U;
+	}
+	if (state_journal_get(STATE_KEY_USAGE_CH(channel, STATE_USAGE_DUTY_S), &value) == 0) {
+		acc->level_ms = (uint64_t)(uint32_t)value * 100U * 1000U;
+	}
+	if (state_journal_get(STATE_KEY_USAGE_CH(channel, STATE_USAGE_CYCLES), &value) == 0) {
+		acc->cycles = (uint32_t)value;
+	}
+	if (state_journal_get(STATE_KEY_USAGE_CH(channel, STATE_USAGE_ENERGY_WH), &value) == 0) {
+		acc->energy = (uint64_t)(uint32_t)value * LIGHTS_USAGE_PER_WH;
+	}
+	if (state_journal_get(STATE_KEY_USAGE_ENERGY_MWH_CH(channel), &value) == 0) {
+		acc->energy += (uint64_t)CLAMP(value, 0, 999) * LIGHTS_USAGE_PER_MWH;
+	}
+}
+
+/**
+ * @brief Config observer: charge the running intervals, then take the new rating.
+ *
+ * The rating is re-read under lights_lock instead of taken from @p value:
+ * observers of two quick changes may run in either order, and the last one
+ * to run must leave the latest rating.
+ */
+static void lights_control_rating_changed(enum config_key key, int32_t old_value, int32_t value)
+{
+	int64_t now = k_uptime_get();
+
+	ARG_UNUSED(old_value);
+	ARG_UNUSED(value);
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+		lights_control_account(i, now);
+	}
+	rating_w = config_store_value(key);
+	k_mutex_unlock(&lights_lock);
+}
+
+static void lights_control_usage_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	lights_control_save_usage();
+	k_work_schedule(&usage_work, K_SECONDS(LIGHTS_USAGE_PERSIST_S));
+}
+
+/**
+ * @brief Update one channel's state and mark it for the next commit.
+ *
+ * Must be called with lights_lock held.
+ *
+ * @param channel Channel index (already validated).
+ * @param on New ON/OFF state.
+ * @param level New brightness level (already clamped).
+ * @return true if the channel changed.
+ */
+static bool lights_control_stage(unsigned int channel, bool on, int level)
+{
+	struct lights_channel_state *ch = &channels[channel];
+
+	if (ch->on == on && ch->level == level) {
+		return false;
+	}
+
+	ch->on = on;
+	ch->level = level;
+	ch->version++;
+	stats.writes++;
+
+	if (dirty & BIT(channel)) {
+		/* The staged value will never reach the output */
+		stats.coalesced++;
+	}
+	dirty |= BIT(channel);
+	return true;
+}
+
+/**
+ * @brief Commit staged changes at once, or at the end of the coalescing window.
+ *
+ * Must be called with lights_lock held.
+ */
+static void lights_control_schedule_commit(void)
+{
+	int window_ms = config_store_value(CONFIG_KEY_COALESCE_MS);
+
+	if (window_ms == 0) {
+		lights_control_commit();
+	} else {
+		/* The window starts with the first change; later ones join it */
+		k_work_schedule(&commit_work, K_MSEC(window_ms));
+	}
+}
+
+/**
+ * @brief Apply a new state to one channel.
+ *
+ * Updates the channel and bumps its version. The output is committed at
+ * once, or at the end of the coalescing window if one is configured. Must
+ * be called with lights_lock held.
+ *
+ * @param channel Channel index (already validated).
+ * @param on New ON/OFF state.
+ * @param level New brightness level (already clamped).
+ */
+static void lights_control_apply(unsigned int channel, bool on, int level)
+{
+	if (lights_control_stage(channel, on, level)) {
+		lights_control_schedule_commit();
+	}
+}
 
 /**
  * @brief Initialize the lights subsystem.
  *
  * In a real scenario, this might configure GPIO pins, PWM channels,
- * or other hardware resources. For now, it's a no-op returning success.
+ * or other hardware resources. The last journaled state, if any, is
+ * restored so the lights come back as they were before a reset. Channels
+ * without journaled state start at the configured default level.
  *
  * @return 0 on success, or a negative error code on failure.
  */
 int lights_control_init(void)
 {
+	int32_t value;
+	int default_level = config_store_value(CONFIG_KEY_DEFAULT_LEVEL);
+	int64_t now = k_uptime_get();
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+		channels[i].on = false;
+		channels[i].level = default_level;
+		channels[i].version = change_seq_first_version();
+		channels[i].change_seq = change_seq_floor();
+
+		if (state_journal_get(STATE_KEY_LIGHTS_ON_CH(i), &value) == 0) {
+			channels[i].on = (value != 0);
+		}
+		if (state_journal_get(STATE_KEY_LIGHTS_LEVEL_CH(i), &value) == 0) {
+			channels[i].level = CLAMP(value, 0, 100);
+		}
+
+		outputs[i].on = channels[i].on;
+		outputs[i].level = channels[i].level;
+		lights_control_restore_usage(i, now);
+	}
+	for (unsigned int i = 0; i < LIGHTS_GROUP_COUNT; i++) {
+		groups[i] = 0;
+		if (state_journal_get(STATE_KEY_LIGHTS_GROUP(i), &value) == 0) {
+			groups[i] = (uint32_t)value & LIGHTS_ALL_CHANNELS;
+		}
+	}
+	dirty = 0;
+	k_mutex_unlock(&lights_lock);
+
+	/* Observe before reading, so a change racing with init is not missed */
+	config_store_observe(CONFIG_KEY_RATED_W, lights_control_rating_changed);
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	rating_w = config_store_value(CONFIG_KEY_RATED_W);
+	k_mutex_unlock(&lights_lock);
+	k_work_schedule(&usage_work, K_SECONDS(LIGHTS_USAGE_PERSIST_S));
+
 	// Placeholder: If hardware initialization is needed, perform it here.
-	LOG_INF("Lights control initialized with default brightness: %d%%", brightness);
+	LOG_INF("Lights control initialized: %d channels, ON=%d, brightness: %d%%",
+		LIGHTS_CHANNEL_COUNT, channels[0].on, channels[0].level);
 	return 0;
 }
 
 /**
  * @brief Turn the lights ON.
  *
- * Placeholder logic sets the on_state to true. In the future, this might 
+ * Placeholder logic sets channel 0 ON. In the future, this might 
  * toggle a GPIO pin or enable a PWM signal.
  *
  * @return 0 on success, or a negative error code on failure.
  */
 int lights_control_turn_on(void)
 {
-	on_state = true;
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	lights_control_apply(0, true, channels[0].level);
+	k_mutex_unlock(&lights_lock);
+
 	LOG_INF("Lights turned ON (placeholder)");
 	return 0;
 }
@@ -92,13 +529,16 @@ int lights_control_turn_on(void)
 /**
  * @brief Turn the lights OFF.
  *
- * Placeholder logic sets the on_state to false.
+ * Placeholder logic sets channel 0 OFF.
  *
  * @return 0 on success, or a negative error code on failure.
  */
 int lights_control_turn_off(void)
 {
-	on_state = false;
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	lights_control_apply(0, false, channels[0].level);
+	k_mutex_unlock(&lights_lock);
+
 	LOG_INF("Lights turned OFF (placeholder)");
 	return 0;
 }
@@ -106,20 +546,27 @@ int lights_control_turn_off(void)
 /**
  * @brief Increase the brightness level.
  *
- * This function increments the brightness by a fixed step (e.g., 10%), 
- * ensuring it does not exceed 100%. In real hardware, it would adjust a PWM duty cycle.
+ * This function increments the brightness of channel 0 by the configured step
+ * (CONFIG_KEY_BRIGHTNESS_STEP), ensuring it does not exceed the configured
+ * maximum. In real hardware, it would adjust a PWM duty cycle.
  *
  * @return 0 on success, or a negative error code on failure.
  */
 int lights_control_increase_brightness(void)
 {
-	if (brightness <= 90) {
-		brightness += 10;
-		LOG_INF("Brightness increased to %d%% (placeholder)", brightness);
+	int step = config_store_value(CONFIG_KEY_BRIGHTNESS_STEP);
+	int max = config_store_value(CONFIG_KEY_BRIGHTNESS_MAX);
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	int level = channels[0].level;
+	if (level + step <= max) {
+		lights_control_apply(0, channels[0].on, level + step);
+		LOG_INF("Brightness increased to %d%% (placeholder)", channels[0].level);
 	} else {
-		brightness = 100;
-		LOG_INF("Brightness is already at maximum (100%%).");
+		lights_control_apply(0, channels[0].on, MAX(level, max));
+		LOG_INF("Brightness is already at maximum (%d%%).", channels[0].level);
 	}
+	k_mutex_unlock(&lights_lock);
 
 	return 0;
 }
@@ -127,20 +574,26 @@ int lights_control_increase_brightness(void)
 /**
  * @brief Decrease the brightness level.
  *
- * This function decreases the brightness by a fixed step (e.g., 10%), 
- * ensuring it does not go below 0%. In a real scenario, it would lower the PWM duty cycle.
+ * This function decreases the brightness of channel 0 by the configured step,
+ * ensuring it does not go below 0%. In a real scenario, it would lower the PWM
+ * duty cycle.
  *
  * @return 0 on success, or a negative error code on failure.
  */
 int lights_control_decrease_brightness(void)
 {
-	if (brightness >= 10) {
-		brightness -= 10;
-		LOG_INF("Brightness decreased to %d%% (placeholder)", brightness);
+	int step = config_store_value(CONFIG_KEY_BRIGHTNESS_STEP);
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	int level = channels[0].level;
+	if (level >= step) {
+		lights_control_apply(0, channels[0].on, level - step);
+		LOG_INF("Brightness decreased to %d%% (placeholder)", channels[0].level);
 	} else {
-		brightness = 0;
+		lights_control_apply(0, channels[0].on, 0);
 		LOG_INF("Brightness is already at minimum (0%%).");
 	}
+	k_mutex_unlock(&lights_lock);
 
 	return 0;
 }
@@ -149,7 +602,7 @@ int lights_control_decrease_brightness(void)
  * @brief Get the current lights state.
  *
  * Allows other parts of the application to query whether the lights are ON or OFF, 
- * and what the current brightness level is.
+ * and what the current brightness level is (channel 0).
  *
  * @param state Pointer to a bool that will receive the ON/OFF state.
  * @param level Pointer to an int that will receive the brightness level.
@@ -163,9 +616,263 @@ int lights_control_get_state(bool *state, int *level)
 		return -EINVAL;
 	}
 
-	*state = on_state;
-	*level = brightness;
-	LOG_INF("Queried lights state: ON=%d, Brightness=%d%%", on_state, brightness);
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	*state = channels[0].on;
+	*level = channels[0].level;
+	k_mutex_unlock(&lights_lock);
+	LOG_INF("Queried lights state: ON=%d, Brightness=%d%%", *state, *level);
+
+	return 0;
+}
+
+/**
+ * @brief Get the state and version of one channel.
+ *
+ * @param channel Channel index.
+ * @param state Pointer receiving a snapshot of the channel.
+ *
+ * @return 0 on success, or -EINVAL for an invalid channel or pointer.
+ */
+int lights_control_get_channel(unsigned int channel, struct lights_channel_state *state)
+{
+	if (channel >= LIGHTS_CHANNEL_COUNT || !state) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	*state = channels[channel];
+	k_mutex_unlock(&lights_lock);
+
+	return 0;
+}
+
+/**
+ * @brief Set one channel, optionally only if its version still matches.
+ *
+ * The version check and the update happen under the same lock, so two hosts
+ * racing on the same channel can never both succeed with the same version.
+ *
+ * @param channel Channel index.
+ * @param on New ON/OFF state.
+ * @param level New brightness level (0-100).
+ * @param expected_version Version the caller last saw, or LIGHTS_VERSION_ANY.
+ * @param current Optional pointer receiving the channel state after the call.
+ *
+ * @return 0 if applied, -EAGAIN on version mismatch, or -EINVAL for invalid
+ *         parameters.
+ */
+int lights_control_set_channel(unsigned int channel, bool on, int level,
+			       uint32_t expected_version, struct lights_channel_state *current)
+{
+	int ret = 0;
+
+	if (channel >= LIGHTS_CHANNEL_COUNT || level < 0 || level > 100) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+
+	if (expected_version != LIGHTS_VERSION_ANY &&
+	    expected_version != channels[channel].version) {
+		ret = -EAGAIN;
+	} else {
+		lights_control_apply(channel, on, MIN(level, config_store_value(CONFIG_KEY_BRIGHTNESS_MAX)));
+	}
+
+	uint32_t version = channels[channel].version;
+	if (current) {
+		*current = channels[channel];
+	}
+
+	k_mutex_unlock(&lights_lock);
+
+	if (ret == -EAGAIN) {
+		LOG_INF("Channel %u write rejected: expected version %u, current %u",
+			channel, expected_version, version);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Set all channels in a mask in one pass with a single commit.
+ *
+ * @param mask Channels to set.
+ * @param on New ON/OFF state.
+ * @param level New brightness level (0-100), or LIGHTS_LEVEL_KEEP.
+ * @return Number of channels that changed, or -EINVAL for invalid parameters.
+ */
+int lights_control_set_channels(uint32_t mask, bool on, int level)
+{
+	int changed = 0;
+
+	if ((mask & ~LIGHTS_ALL_CHANNELS) != 0 || level < LIGHTS_LEVEL_KEEP || level > 100) {
+		return -EINVAL;
+	}
+
+	int max = config_store_value(CONFIG_KEY_BRIGHTNESS_MAX);
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	for (uint32_t pending = mask; pending != 0; pending &= pending - 1) {
+		unsigned int channel = find_lsb_set(pending) - 1;
+		int new_level = level == LIGHTS_LEVEL_KEEP ? channels[channel].level : MIN(level, max);
+
+		changed += lights_control_stage(channel, on, new_level);
+	}
+	if (changed > 0) {
+		lights_control_schedule_commit();
+	}
+	k_mutex_unlock(&lights_lock);
+
+	LOG_DBG("Set channels 0x%08x: %d changed", mask, changed);
+	return changed;
+}
+
+/**
+ * @brief Define a channel group.
+ *
+ * @param group Group index.
+ * @param mask Channels in the group.
+ * @return 0 on success, or -EINVAL for an invalid group or channel.
+ */
+int lights_control_set_group(unsigned int group, uint32_t mask)
+{
+	if (group >= LIGHTS_GROUP_COUNT || (mask & ~LIGHTS_ALL_CHANNELS) != 0) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	groups[group] = mask;
+	lights_control_persist(STATE_KEY_LIGHTS_GROUP(group), (int32_t)mask);
+	k_mutex_unlock(&lights_lock);
 
 	return 0;
 }
+
+/**
+ * @brief Get the channel masks of all groups.
+ *
+ * @param out Array receiving LIGHTS_GROUP_COUNT masks.
+ */
+void lights_control_get_groups(uint32_t out[LIGHTS_GROUP_COUNT])
+{
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	memcpy(out, groups, sizeof(groups));
+	k_mutex_unlock(&lights_lock);
+}
+
+/**
+ * @brief Commit coalesced changes without waiting for the window to end.
+ */
+void lights_control_flush(void)
+{
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	lights_control_commit();
+	k_mutex_unlock(&lights_lock);
+}
+
+/**
+ * @brief Check a ticket against the commit counter. Must be called with lights_lock held.
+ */
+static bool lights_control_is_committed(uint32_t ticket)
+{
+	return (int32_t)(stats.commits - ticket) >= 0;
+}
+
+uint32_t lights_control_commit_ticket(void)
+{
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	/* Staged changes go out with the next commit, which commits them all */
+	uint32_t ticket = stats.commits + (dirty ? 1U : 0U);
+	k_mutex_unlock(&lights_lock);
+
+	return ticket;
+}
+
+bool lights_control_ticket_committed(uint32_t ticket)
+{
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	bool committed = lights_control_is_committed(ticket);
+	k_mutex_unlock(&lights_lock);
+
+	return committed;
+}
+
+int lights_control_wait_committed(uint32_t ticket, k_timeout_t timeout)
+{
+	int ret = 0;
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	while (!lights_control_is_committed(ticket)) {
+		if (k_condvar_wait(&commit_cv, &lights_lock, timeout) != 0) {
+			ret = -EAGAIN;
+			break;
+		}
+	}
+	k_mutex_unlock(&lights_lock);
+
+	return ret;
+}
+
+struct k_poll_signal *lights_control_commit_signal(void)
+{
+	return &commit_signal;
+}
+
+/**
+ * @brief Get the usage counters of one channel, including the current interval.
+ *
+ * @param channel Channel index.
+ * @param out Pointer receiving the counters.
+ * @return 0 on success, or -EINVAL for an invalid channel or pointer.
+ */
+int lights_control_get_usage(unsigned int channel, struct lights_channel_usage *out)
+{
+	if (channel >= LIGHTS_CHANNEL_COUNT || !out) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	lights_control_account(channel, k_uptime_get());
+	out->on_ms = usage[channel].on_ms;
+	out->duty_ms = usage[channel].level_ms / 100U;
+	out->energy_mwh = usage[channel].energy / LIGHTS_USAGE_PER_MWH;
+	out->cycles = usage[channel].cycles;
+	k_mutex_unlock(&lights_lock);
+
+	return 0;
+}
+
+/**
+ * @brief Journal the usage counters that changed since the last save.
+ */
+void lights_control_save_usage(void)
+{
+	int64_t now = k_uptime_get();
+
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+		const struct lights_usage_acc *acc = &usage[i];
+
+		lights_control_account(i, now);
+		lights_control_persist_usage(STATE_KEY_USAGE_CH(i, STATE_USAGE_ON_S), acc->on_ms / 1000U);
+		lights_control_persist_usage(STATE_KEY_USAGE_CH(i, STATE_USAGE_DUTY_S),
+					     acc->level_ms / (100U * 1000U));
+		lights_control_persist_usage(STATE_KEY_USAGE_CH(i, STATE_USAGE_CYCLES), acc->cycles);
+		lights_control_persist_energy(i, acc->energy / LIGHTS_USAGE_PER_MWH);
+	}
+	k_mutex_unlock(&lights_lock);
+}
+
+/**
+ * @brief Get the write and commit counters.
+ *
+ * @param out Pointer receiving the counters.
+ */
+void lights_control_get_stats(struct lights_control_stats *out)
+{
+	k_mutex_lock(&lights_lock, K_FOREVER);
+	*out = stats;
+	out->pending = POPCOUNT(dirty);
+	k_mutex_unlock(&lights_lock);
+}
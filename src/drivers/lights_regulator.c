@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file lights_regulator.c
+ * @brief Closed-loop constant-light control.
+ *
+ * Description:
+ * ------------
+ * This file implements the PI regulator from `lights_regulator.h`. A periodic
+ * kernel timer submits a work item every `reg_period_ms`; the work item reads
+ * the current (filtered) ambient light value, runs one controller step and
+ * applies the result through lights_control_set_channel(). If the sensor has
+ * not produced a new value since the last step (e.g., while its filters
+ * decimate), the step holds the output.
+ *
+ * Fixed-point arithmetic:
+ * -----------------------
+ * Measurements and errors are in milli-lux, the controller output and the
+ * integrator are brightness percent in Q16 (percent * 65536). Gains are
+ * integers in 1/1000 units, so with e the error in milli-lux and T the time
+ * in milliseconds since the previous measurement the regulator used:
+ *
+ *   P  = kp * e * 2^16 / 10^6
+ *   dI = ki * e * T / 10^3 * 2^16 / 10^6
+ *
+ * Products are computed in 64 bits. The integrator is clamped to the output
+ * limits and stops integrating while the output is saturated in the
+ * direction of the error (anti-windup). The output may change by at most
+ * `reg_slew` percent per second, and errors inside `reg_deadband` leave the
+ * output untouched so the light does not dither around the setpoint.
+ *
+ * T is at least `reg_period_ms` and at most LIGHTS_REGULATOR_DT_MAX_MS (or the
+ * period, if longer): a sensor that updates less often than the loop runs
+ * keeps the full integral gain and slew rate, and one that stalled does not
+ * make the output jump when it recovers.
+ *
+ * When the output reaches a limit and the error still points beyond it, the
+ * setpoint cannot be reached; an EVENT_ALARM is logged once on entering that
+ * state.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdlib.h>
+
+#include "app_config.h"
+#include "config_store.h"
+#include "event_log.h"
+#include "lights_control.h"
+#include "lights_regulator.h"
+#include "sensor_readings.h"
+
+LOG_MODULE_REGISTER(lights_regulator, LOG_LEVEL_INF);
+
+#define Q16_SHIFT 16
+#define Q16_ONE   (1 << Q16_SHIFT)
+
+/**
+ * @brief Regulator state, protected by regulator_lock.
+ *
+ * Fields:
+ *   - integrator, output: Q16 brightness percent.
+ *   - applied_level: Brightness last written to the lights channel.
+ *   - period_ms: Period the timer currently runs with.
+ *   - sensor_updates: Sensor update count the last step used.
+ *   - sensor_time: Uptime (ms) at which the last step used a measurement.
+ *   - saturated: Output held at a limit by the error (alarm raised).
+ */
+struct regulator_state {
+	bool enabled;
+	int32_t integrator;
+	int32_t output;
+	int applied_level;
+	int32_t lux_milli;
+	int32_t error_milli;
+	uint32_t steps;
+	int32_t period_ms;
+	uint32_t sensor_updates;
+	int64_t sensor_time;
+	bool saturated;
+};
+
+static struct regulator_state regulator;
+
+static K_MUTEX_DEFINE(regulator_lock);
+
+static void lights_regulator_work_handler(struct k_work *work);
+static void lights_regulator_timer_expiry(struct k_timer *timer);
+
+static K_WORK_DEFINE(regulator_work, lights_regulator_work_handler);
+static K_TIMER_DEFINE(regulator_timer, lights_regulator_timer_expiry, NULL);
+
+static void lights_regulator_timer_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+	/* Runs in interrupt context: the step takes mutexes */
+	k_work_submit(&regulator_work);
+}
+
+static void lights_regulator_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	(void)lights_regulator_step();
+}
+
+int lights_regulator_step(void)
+{
+	uint32_t updates;
+	int32_t lux;
+	int ret;
+
+	k_mutex_lock(&regulator_lock, K_FOREVER);
+
+	if (!regulator.enabled) {
+		k_mutex_unlock(&regulator_lock);
+		return -EAGAIN;
+	}
+
+	ret = sensor_readings_get(SENSOR_READINGS_AMBIENT_LIGHT, &lux, &updates);
+	if (ret < 0 || updates == regulator.sensor_updates) {
+		k_mutex_unlock(&regulator_lock);
+		/* No new measurement (or none at all): hold the output */
+		return ret;
+	}
+	regulator.sensor_updates = updates;
+
+	unsigned int channel = config_store_value(CONFIG_KEY_REG_CHANNEL);
+	int32_t period_ms = config_store_value(CONFIG_KEY_REG_PERIOD_MS);
+	int64_t now = k_uptime_get();
+	int64_t dt = CLAMP(now - regulator.sensor_time, period_ms,
+			   MAX(period_ms, LIGHTS_REGULATOR_DT_MAX_MS));
+	int32_t min = config_store_value(CONFIG_KEY_REG_MIN_LEVEL) * Q16_ONE;
+	int32_t max = config_store_value(CONFIG_KEY_REG_MAX_LEVEL) * Q16_ONE;
+	int32_t error = config_store_value(CONFIG_KEY_REG_SETPOINT) * 1000 - lux;
+
+	max = MAX(min, max);
+	regulator.sensor_time = now;
+	regulator.lux_milli = lux;
+	regulator.error_milli = error;
+	regulator.steps++;
+
+	if (abs(error) > config_store_value(CONFIG_KEY_REG_DEADBAND) * 1000) {
+		int64_t p = (int64_t)config_store_value(CONFIG_KEY_REG_KP) * error * Q16_ONE /
+			    1000000;
+		int64_t di = (int64_t)config_store_value(CONFIG_KEY_REG_KI) * error * dt /
+			     1000 * Q16_ONE / 1000000;
+		int64_t integrator = regulator.integrator + di;
+		int64_t unsaturated = p + integrator;
+
+		if (!((unsaturated > max && di > 0) || (unsaturated < min && di < 0))) {
+			regulator.integrator = CLAMP(integrator, min, max);
+		}
+
+		int32_t target = CLAMP(p + regulator.integrator, min, max);
+		int32_t slew = (int32_t)((int64_t)config_store_value(CONFIG_KEY_REG_SLEW) *
+					 dt * Q16_ONE / 1000);
+
+		regulator.output += CLAMP(target - regulator.output, -slew, slew);
+
+		bool saturated = (regulator.output >= max && error > 0) ||
+				 (regulator.output <= min && error < 0);
+
+		if (saturated && !regulator.saturated) {
+			LOG_WRN("Regulator saturated at %d lux", lux / 1000);
+			event_log_record(EVENT_ALARM, EVENT_ALARM_REG_SATURATED, lux,
+					 config_store_value(CONFIG_KEY_REG_SETPOINT) * 1000);
+		}
+		regulator.saturated = saturated;
+	}
+
+	int level = (regulator.output + Q16_ONE / 2) >> Q16_SHIFT;
+
+	if (level != regulator.applied_level) {
+		ret = lights_control_set_channel(channel, true, level, LIGHTS_VERSION_ANY, NULL);
+		if (ret == 0) {
+			regulator.applied_level = level;
+		}
+	}
+
+	if (period_ms != regulator.period_ms) {
+		/* Retuned period: restart the timer with the new rate */
+		regulator.period_ms = period_ms;
+		k_timer_start(&regulator_timer, K_MSEC(period_ms), K_MSEC(period_ms));
+	}
+
+	k_mutex_unlock(&regulator_lock);
+	return ret;
+}
+
+int lights_regulator_enable(void)
+{
+	struct lights_channel_state state;
+	int ret;
+
+	k_mutex_lock(&regulator_lock, K_FOREVER);
+
+	ret = lights_control_get_channel(config_store_value(CONFIG_KEY_REG_CHANNEL), &state);
+	if (ret == 0 && !regulator.enabled) {
+		int level = state.on ? state.level : 0;
+
+		regulator.integrator = level * Q16_ONE;
+		regulator.output = regulator.integrator;
+		regulator.applied_level = state.on ? level : -1;
+		regulator.steps = 0;
+		regulator.sensor_updates = 0;
+		regulator.sensor_time = k_uptime_get();
+		regulator.saturated = false;
+		regulator.period_ms = config_store_value(CONFIG_KEY_REG_PERIOD_MS);
+		regulator.enabled = true;
+
+		k_timer_start(&regulator_timer, K_MSEC(regulator.period_ms),
+			      K_MSEC(regulator.period_ms));
+		LOG_INF("Regulator enabled, starting from %d%%", level);
+	}
+
+	k_mutex_unlock(&regulator_lock);
+	return ret;
+}
+
+void lights_regulator_disable(void)
+{
+	k_mutex_lock(&regulator_lock, K_FOREVER);
+	if (regulator.enabled) {
+		regulator.enabled = false;
+		k_timer_stop(&regulator_timer);
+		LOG_INF("Regulator disabled at %d%%", regulator.applied_level);
+	}
+	k_mutex_unlock(&regulator_lock);
+}
+
+void lights_regulator_get_status(struct lights_regulator_status *status)
+{
+	k_mutex_lock(&regulator_lock, K_FOREVER);
+	status->enabled = regulator.enabled;
+	status->lux_milli = regulator.lux_milli;
+	status->error_milli = regulator.error_milli;
+	status->output_milli = (int32_t)(((int64_t)regulator.output * 1000) >> Q16_SHIFT);
+	status->level = regulator.applied_level;
+	status->steps = regulator.steps;
+	k_mutex_unlock(&regulator_lock);
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file lights_scene.c
+ * @brief Staged lights changes applied together at an absolute time.
+ *
+ * Description:
+ * ------------
+ * This file implements `lights_scene.h`. Staged changes are kept per channel
+ * with a bit mask of the staged channels.
+ *
+ * Timing:
+ * -------
+ * A kernel timer only has tick resolution and a tick-based absolute timeout
+ * can round up by a tick. Committing therefore arms a one-shot timer
+ * (K_TIMEOUT_ABS_US) one tick plus LIGHTS_SCENE_WAKE_MARGIN_US before the
+ * deadline. Its expiry function runs in interrupt context and only submits
+ * the apply work item to a dedicated cooperative workqueue, so the scene does
+ * not queue behind other system work. The work item busy-waits the remaining
+ * microseconds against the cycle-accurate device time, writes the channels
+ * through lights_control_set_channel() and then flushes the lights output
+ * stage, so a coalescing window does not delay the scene.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "device_time.h"
+#include "lights_control.h"
+#include "lights_scene.h"
+
+LOG_MODULE_REGISTER(lights_scene, LOG_LEVEL_INF);
+
+struct scene_change {
+	bool on;
+	int level;
+};
+
+static struct scene_change changes[LIGHTS_CHANNEL_COUNT];
+static struct lights_scene_status scene;
+
+static K_MUTEX_DEFINE(scene_lock);
+
+static K_KERNEL_STACK_DEFINE(scene_wq_stack, LIGHTS_SCENE_WQ_STACK_SIZE);
+static struct k_work_q scene_wq;
+
+static void lights_scene_work_handler(struct k_work *work);
+static void lights_scene_timer_expiry(struct k_timer *timer);
+
+static K_WORK_DEFINE(scene_work, lights_scene_work_handler);
+static K_TIMER_DEFINE(scene_timer, lights_scene_timer_expiry, NULL);
+
+static void lights_scene_timer_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+	/* Runs in interrupt context: applying takes the lights mutex */
+	k_work_submit_to_queue(&scene_wq, &scene_work);
+}
+
+static void lights_scene_work_handler(struct k_work *work)
+{
+	struct scene_change apply[LIGHTS_CHANNEL_COUNT];
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&scene_lock, K_FOREVER);
+	if (!scene.armed) {
+		/* Cleared after the timer fired */
+		k_mutex_unlock(&scene_lock);
+		return;
+	}
+
+	uint32_t staged = scene.staged;
+	int64_t deadline = scene.deadline_us;
+
+	memcpy(apply, changes, sizeof(apply));
+	scene.staged = 0;
+	scene.armed = false;
+	k_mutex_unlock(&scene_lock);
+
+	/* Woken early on purpose: finish the wait at cycle resolution */
+	int64_t remaining = deadline - device_time_now_us();
+
+	if (remaining > 0) {
+		k_busy_wait((uint32_t)remaining);
+	}
+
+	for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+		if (staged & BIT(i)) {
+			(void)lights_control_set_channel(i, apply[i].on, apply[i].level,
+							 LIGHTS_VERSION_ANY, NULL);
+		}
+	}
+	lights_control_flush();
+
+	int64_t late = device_time_now_us() - deadline;
+
+	k_mutex_lock(&scene_lock, K_FOREVER);
+	scene.commits++;
+	scene.last_late_us = late;
+	k_mutex_unlock(&scene_lock);
+
+	LOG_INF("Scene applied to channels 0x%02x, %lld us after the deadline", staged,
+		(long long)late);
+}
+
+void lights_scene_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "lights_scene",
+		.no_yield = true,
+	};
+
+	k_work_queue_init(&scene_wq);
+	k_work_queue_start(&scene_wq, scene_wq_stack, K_KERNEL_STACK_SIZEOF(scene_wq_stack),
+			   K_PRIO_COOP(LIGHTS_SCENE_WQ_PRIORITY), &cfg);
+}
+
+int lights_scene_stage(unsigned int channel, bool on, int level)
+{
+	int ret = 0;
+
+	if (channel >= LIGHTS_CHANNEL_COUNT || level < 0 || level > 100) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&scene_lock, K_FOREVER);
+	if (scene.armed) {
+		ret = -EBUSY;
+	} else {
+		changes[channel].on = on;
+		changes[channel].level = level;
+		scene.staged |= BIT(channel);
+	}
+	k_mutex_unlock(&scene_lock);
+
+	return ret;
+}
+
+void lights_scene_clear(void)
+{
+	k_mutex_lock(&scene_lock, K_FOREVER);
+	k_timer_stop(&scene_timer);
+	scene.staged = 0;
+	scene.armed = false;
+	k_mutex_unlock(&scene_lock);
+}
+
+int lights_scene_commit_at(int64_t deadline_us)
+{
+	k_mutex_lock(&scene_lock, K_FOREVER);
+
+	if (scene.staged == 0) {
+		k_mutex_unlock(&scene_lock);
+		return -ENODATA;
+	}
+
+	int64_t wake_us = deadline_us - (int64_t)k_ticks_to_us_ceil64(1) - LIGHTS_SCENE_WAKE_MARGIN_US;
+
+	scene.armed = true;
+	scene.deadline_us = deadline_us;
+	/* An absolute timeout in the past expires at the next tick */
+	k_timer_start(&scene_timer, K_TIMEOUT_ABS_US(MAX(wake_us, 0)), K_NO_WAIT);
+	k_mutex_unlock(&scene_lock);
+
+	LOG_INF("Scene commit at %lld us (in %lld us)", (long long)deadline_us,
+		(long long)(deadline_us - device_time_now_us()));
+	return 0;
+}
+
+void lights_scene_get_status(struct lights_scene_status *status)
+{
+	k_mutex_lock(&scene_lock, K_FOREVER);
+	*status = scene;
+	k_mutex_unlock(&scene_lock);
+}
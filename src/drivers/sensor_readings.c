@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file sensor_readings.c
+ * @brief Driver for reading the application's sensors.
+ *
+ * Description:
+ * ------------
+ * This file implements the sensor readings driver from `sensor_readings.h`.
+ * A static table maps each application channel to a Zephyr sensor device and
+ * sensor channel. Devices are taken from devicetree aliases:
+ *
+ *   ambient-temp0:  temperature and humidity (e.g., SHT3x, HTS221)
+ *   ambient-light0: ambient light (e.g., VEML7700, BH1750)
+ *
+ * Readings are converted to fixed-point milli-units so that consumers (the
+ * lights regulator, the sensors commands) never deal with floating point.
+ *
+ * Filtering:
+ * ----------
+ * Every channel has a chain of streaming filters (sensor_filter.h) that is
+ * configured at runtime and empty by default. A periodic sampler (a delayable
+ * work item, every SENSOR_SAMPLE_INTERVAL_MS) is the only producer: it feeds
+ * each raw sample through the chain, and a value the chain emits becomes the
+ * channel's current value. A sample withheld by the chain (decimation,
+ * deadband) leaves the current value unchanged.
+ *
+ * Consumers (the regulator, the menu, the sensor commands) only read the
+ * current value with sensor_readings_get(), which never advances a chain, so
+ * the filter state and the effective sample rate do not depend on who is
+ * polling. The update counter returned with the value tells a consumer
+ * whether the chain has emitted a new value since it last looked.
+ *
+ * A channel whose value or read status changes is stamped with a global
+ * change sequence number (change_seq.h), so `sync` can report sensors along
+ * with the other objects. A deadband stage keeps noise from stamping every
+ * sample. A channel that starts failing also logs an EVENT_ALARM.
+ *
+ * Emulation:
+ * ----------
+ * Channels whose alias is missing, or whose device is not ready, return an
+ * emulated value instead. The value starts at a plausible indoor default and
+ * is changed with sensor_readings_emul_set(), e.g., by tests on native_sim.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "change_seq.h"
+#include "event_log.h"
+#include "sensor_filter.h"
+#include "sensor_readings.h"
+
+LOG_MODULE_REGISTER(sensor_readings, LOG_LEVEL_INF);
+
+#if DT_HAS_ALIAS(ambient_temp0)
+#define SENSOR_READINGS_TEMP_DEV DEVICE_DT_GET(DT_ALIAS(ambient_temp0))
+#else
+#define SENSOR_READINGS_TEMP_DEV NULL
+#endif
+
+#if DT_HAS_ALIAS(ambient_light0)
+#define SENSOR_READINGS_LIGHT_DEV DEVICE_DT_GET(DT_ALIAS(ambient_light0))
+#else
+#define SENSOR_READINGS_LIGHT_DEV NULL
+#endif
+
+/**
+ * @brief Source of one application sensor channel.
+ *
+ * Fields:
+ *   - dev: Sensor device, or NULL if the channel is emulated.
+ *   - chan: Zephyr sensor channel read from dev.
+ *   - emul_value: Value returned while emulated, in milli-units.
+ *   - filters: Filter chain applied to every sample.
+ *   - value: Last value emitted by the filter chain.
+ *   - updates: Number of values the chain has emitted (0: no value yet).
+ *   - status: Result of the last sample taken from the device.
+ *   - change_seq: Global sequence number of the last value or status change.
+ */
+struct sensor_source {
+	const char *name;
+	const struct device *dev;
+	enum sensor_channel chan;
+	int32_t emul_value;
+	struct sensor_filter_chain filters;
+	int32_t value;
+	uint32_t updates;
+	int status;
+	uint32_t change_seq;
+};
+
+static struct sensor_source sources[SENSOR_READINGS_COUNT] = {
+	[SENSOR_READINGS_TEMPERATURE] = {
+		.name = "temperature",
+		.dev = SENSOR_READINGS_TEMP_DEV,
+		.chan = SENSOR_CHAN_AMBIENT_TEMP,
+		.emul_value = 22000,
+	},
+	[SENSOR_READINGS_HUMIDITY] = {
+		.name = "humidity",
+		.dev = SENSOR_READINGS_TEMP_DEV,
+		.chan = SENSOR_CHAN_HUMIDITY,
+		.emul_value = 45000,
+	},
+	[SENSOR_READINGS_AMBIENT_LIGHT] = {
+		.name = "ambient_light",
+		.dev = SENSOR_READINGS_LIGHT_DEV,
+		.chan = SENSOR_CHAN_LIGHT,
+		.emul_value = 300000,
+	},
+};
+
+static K_MUTEX_DEFINE(sensor_lock);
+
+static void sensor_readings_sample_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(sample_work, sensor_readings_sample_work_handler);
+
+static void sensor_readings_sample_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	sensor_readings_sample();
+	k_work_schedule(&sample_work, K_MSEC(SENSOR_SAMPLE_INTERVAL_MS));
+}
+
+int sensor_readings_init(void)
+{
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	for (int i = 0; i < SENSOR_READINGS_COUNT; i++) {
+		struct sensor_source *source = &sources[i];
+
+		if (source->dev && !device_is_ready(source->dev)) {
+			LOG_WRN("Sensor %s not ready, using emulated value", source->name);
+			source->dev = NULL;
+		}
+		LOG_INF("Sensor %s: %s", source->name, source->dev ? source->dev->name : "emulated");
+	}
+	k_mutex_unlock(&sensor_lock);
+
+	/* Consumers find a value right away, then the sampler keeps it fresh */
+	sensor_readings_sample();
+	k_work_schedule(&sample_work, K_MSEC(SENSOR_SAMPLE_INTERVAL_MS));
+
+	return 0;
+}
+
+/**
+ * @brief Take one raw sample of a channel and feed it to its filter chain.
+ *
+ * Must be called with sensor_lock held.
+ */
+static void sensor_readings_sample_channel(struct sensor_source *source)
+{
+	struct sensor_value raw;
+	int32_t sample = 0;
+	int ret = 0;
+
+	if (!source->dev) {
+		sample = source->emul_value;
+	} else {
+		ret = sensor_sample_fetch_chan(source->dev, source->chan);
+		if (ret == 0) {
+			ret = sensor_channel_get(source->dev, source->chan, &raw);
+		}
+		if (ret == 0) {
+			sample = raw.val1 * 1000 + raw.val2 / 1000;
+		}
+	}
+
+	if (ret < 0 && source->status >= 0) {
+		LOG_ERR("Failed to read sensor %s (err %d)", source->name, ret);
+		event_log_record(EVENT_ALARM, EVENT_ALARM_SENSOR_FAILED, ret, source - sources);
+	}
+	if (ret != source->status) {
+		source->change_seq = change_seq_next();
+	}
+	source->status = ret;
+
+	int32_t previous = source->value;
+
+	if (ret == 0 && sensor_filter_chain_process(&source->filters, sample, &source->value) == 0) {
+		if (source->updates == 0 || source->value != previous) {
+			source->change_seq = change_seq_next();
+		}
+		source->updates++;
+	}
+}
+
+void sensor_readings_sample(void)
+{
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	for (int i = 0; i < SENSOR_READINGS_COUNT; i++) {
+		sensor_readings_sample_channel(&sources[i]);
+	}
+	k_mutex_unlock(&sensor_lock);
+}
+
+int sensor_readings_get(enum sensor_readings_channel channel, int32_t *value, uint32_t *updates)
+{
+	int ret;
+
+	if ((unsigned int)channel >= SENSOR_READINGS_COUNT || !value) {
+		return -EINVAL;
+	}
+
+	const struct sensor_source *source = &sources[channel];
+
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	if (source->status < 0) {
+		ret = source->status;
+	} else if (source->updates == 0) {
+		ret = -ENODATA;
+	} else {
+		*value = source->value;
+		if (updates) {
+			*updates = source->updates;
+		}
+		ret = 0;
+	}
+	k_mutex_unlock(&sensor_lock);
+
+	return ret;
+}
+
+uint32_t sensor_readings_change_seq(enum sensor_readings_channel channel)
+{
+	uint32_t change_seq;
+
+	if ((unsigned int)channel >= SENSOR_READINGS_COUNT) {
+		return 0;
+	}
+
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	change_seq = sources[channel].change_seq;
+	k_mutex_unlock(&sensor_lock);
+
+	return change_seq;
+}
+
+int sensor_readings_set_filters(enum sensor_readings_channel channel,
+				const struct sensor_filter_config *configs, size_t count)
+{
+	int ret;
+
+	if ((unsigned int)channel >= SENSOR_READINGS_COUNT) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	ret = sensor_filter_chain_set(&sources[channel].filters, configs, count);
+	k_mutex_unlock(&sensor_lock);
+
+	if (ret == 0) {
+		LOG_INF("Sensor %s: %u filter stages", sources[channel].name, (unsigned int)count);
+	}
+	return ret;
+}
+
+int sensor_readings_get_filters(enum sensor_readings_channel channel,
+				struct sensor_filter_config *configs, size_t max)
+{
+	size_t count;
+
+	if ((unsigned int)channel >= SENSOR_READINGS_COUNT) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	const struct sensor_filter_chain *chain = &sources[channel].filters;
+
+	count = MIN(chain->count, max);
+	for (size_t i = 0; i < count; i++) {
+		configs[i] = chain->stages[i].config;
+	}
+	k_mutex_unlock(&sensor_lock);
+
+	return (int)count;
+}
+
+const char *sensor_readings_channel_name(enum sensor_readings_channel channel)
+{
+	if ((unsigned int)channel >= SENSOR_READINGS_COUNT) {
+		return NULL;
+	}
+	return sources[channel].name;
+}
+
+int sensor_readings_channel_from_name(const char *name)
+{
+	for (int channel = 0; channel < SENSOR_READINGS_COUNT; channel++) {
+		if (strcmp(name, sources[channel].name) == 0) {
+			return channel;
+		}
+	}
+	return -EINVAL;
+}
+
+bool sensor_readings_is_emulated(enum sensor_readings_channel channel)
+{
+	return (unsigned int)channel < SENSOR_READINGS_COUNT && !sources[channel].dev;
+}
+
+int sensor_readings_emul_set(enum sensor_readings_channel channel, int32_t value)
+{
+	int ret = 0;
+
+	if ((unsigned int)channel >= SENSOR_READINGS_COUNT) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&sensor_lock, K_FOREVER);
+	if (sources[channel].dev) {
+		ret = -ENOTSUP;
+	} else {
+		sources[channel].emul_value = value;
+	}
+	k_mutex_unlock(&sensor_lock);
+
+	return ret;
+}
+
+/**
+ * @brief Get the current value of a channel rounded to whole units.
+ *
+ * The value is returned separately from the status: a reading below zero
+ * (e.g., -22 degrees) is valid and must not be mistaken for an error code.
+ */
+static int sensor_readings_get_whole(enum sensor_readings_channel channel, int *whole)
+{
+	int32_t value;
+	int ret = sensor_readings_get(channel, &value, NULL);
+
+	if (ret < 0) {
+		return ret;
+	}
+	*whole = (value + (value >= 0 ? 500 : -500)) / 1000;
+	return 0;
+}
+
+int sensor_readings_get_temperature(int *celsius)
+{
+	return sensor_readings_get_whole(SENSOR_READINGS_TEMPERATURE, celsius);
+}
+
+int sensor_readings_get_humidity(int *percent)
+{
+	return sensor_readings_get_whole(SENSOR_READINGS_HUMIDITY, percent);
+}
+
+int sensor_readings_get_ambient_light(int *lux)
+{
+	return sensor_readings_get_whole(SENSOR_READINGS_AMBIENT_LIGHT, lux);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file uart_link.c
+ * @brief Line-oriented link to a downstream unit on a second UART.
+ *
+ * Description:
+ * ------------
+ * This file implements the downstream link from `uart_link.h`. It mirrors
+ * the interrupt-driven design of uart_handler.c: output is staged in a TX
+ * ring buffer drained by the TX interrupt, and the RX interrupt assembles
+ * lines into a message queue. Unlike the console, the link has no abort
+ * handling and never blocks: a line that does not fit is refused.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/ring_buffer.h>
+
+#include "app_config.h"
+#include "uart_link.h"
+
+LOG_MODULE_REGISTER(uart_link, LOG_LEVEL_INF);
+
+#if DT_HAS_ALIAS(downstream_uart)
+static const struct device *link_dev = DEVICE_DT_GET(DT_ALIAS(downstream_uart));
+#else
+static const struct device *link_dev;
+#endif
+
+K_MSGQ_DEFINE(uart_link_msgq, UART_MSG_SIZE, UART_MSGQ_LEN, 4);
+
+RING_BUF_DECLARE(link_tx_ringbuf, UART_LINK_TX_BUF_SIZE);
+static struct k_spinlock link_tx_lock;
+
+static char link_rx_buf[UART_MSG_SIZE];
+static size_t link_rx_pos;
+
+static uart_link_rx_cb_t link_rx_cb;
+static bool link_ready;
+
+static void uart_link_irq_handler(const struct device *dev, void *user_data)
+{
+	ARG_UNUSED(user_data);
+	uint8_t *data;
+	uint8_t c;
+
+	if (!uart_irq_update(dev)) {
+		return;
+	}
+
+	if (uart_irq_tx_ready(dev)) {
+		k_spinlock_key_t key = k_spin_lock(&link_tx_lock);
+		uint32_t len = ring_buf_get_claim(&link_tx_ringbuf, &data, UART_LINK_TX_BUF_SIZE);
+
+		if (len == 0) {
+			uart_irq_tx_disable(dev);
+		} else {
+			int sent = uart_fifo_fill(dev, data, len);
+			ring_buf_get_finish(&link_tx_ringbuf, sent > 0 ? sent : 0);
+		}
+		k_spin_unlock(&link_tx_lock, key);
+	}
+
+	if (!uart_irq_rx_ready(dev)) {
+		return;
+	}
+
+	while (uart_fifo_read(dev, &c, 1) == 1) {
+		if ((c == '\n' || c == '\r') && link_rx_pos > 0) {
+			link_rx_buf[link_rx_pos] = '\0';
+			link_rx_pos = 0;
+			if (k_msgq_put(&uart_link_msgq, link_rx_buf, K_NO_WAIT) < 0) {
+				LOG_WRN("Link RX queue full, dropping line");
+			} else if (link_rx_cb) {
+				link_rx_cb();
+			}
+		} else if (c != '\n' && c != '\r' && link_rx_pos < UART_MSG_SIZE - 1) {
+			link_rx_buf[link_rx_pos++] = (char)c;
+		}
+	}
+}
+
+int uart_link_init(uart_link_rx_cb_t rx_cb)
+{
+	if (!link_dev || !device_is_ready(link_dev)) {
+		LOG_INF("No downstream UART, gateway forwarding unavailable");
+		return -ENODEV;
+	}
+
+	link_rx_cb = rx_cb;
+
+	int ret = uart_irq_callback_user_data_set(link_dev, uart_link_irq_handler, NULL);
+	if (ret < 0) {
+		LOG_ERR("Failed to set link UART callback (err %d)", ret);
+		return ret;
+	}
+
+	link_ready = true;
+	uart_irq_rx_enable(link_dev);
+	LOG_INF("Downstream link on %s", link_dev->name);
+	return 0;
+}
+
+bool uart_link_ready(void)
+{
+	return link_ready;
+}
+
+int uart_link_send(const char *line, size_t len)
+{
+	int ret = 0;
+
+	if (!link_ready) {
+		return -ENODEV;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&link_tx_lock);
+	if (ring_buf_space_get(&link_tx_ringbuf) < len) {
+		ret = -ENOBUFS;
+	} else {
+		ring_buf_put(&link_tx_ringbuf, (const uint8_t *)line, len);
+	}
+	k_spin_unlock(&link_tx_lock, key);
+
+	if (ret == 0) {
+		uart_irq_tx_enable(link_dev);
+	}
+	return ret;
+}
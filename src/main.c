@@ -1,5 +1,12 @@
 #include "uart_handler.h"
+#include "change_seq.h"
+#include "command_gateway.h"
+#include "config_store.h"
+#include "lights_control.h"
+#include "lights_scene.h"
+#include "state_journal.h"
 #include "menu.h"
+#include "sensor_readings.h"
 
 int main(void)
 {
@@ -9,13 +16,25 @@ int main(void)
         return 0;
     }
 
+    // Restore persisted state before the modules that own it start
+    ret = state_journal_init();
+    if (ret < 0) {
+        printk("State journal unavailable (err %d), running without persistence\n", ret);
+    }
+    change_seq_init();
+    config_store_init();
+    lights_control_init();
+    lights_scene_init();
+    sensor_readings_init();
+    command_gateway_init();
+
     // Optionally print a welcome message
-    uart_handler_write_string("Welcome! Starting the menu...\r\n");
+    uart_handler_write_literal("Welcome! Starting the menu...\r\n");
 
     // Run the main menu loop
     menu_core_run();
 
     // If the user exits the menu:
-    uart_handler_write_string("Menu exited. Shutting down.\r\n");
+    uart_handler_write_literal("Menu exited. Shutting down.\r\n");
     return 0;
 }
@@ -23,12 +23,24 @@
  * input from the lights sub-menu is processed similarly to the main menu, 
  * calling `menu_actions_execute()` with different action_ids for each lights action.
  *
+ * Menus are only rendered when no further input is already queued. An
+ * operator (or script) typing ahead through several menus therefore only
+ * sees the screen for the last selection instead of every intermediate one.
+ *
+ * Output is corked while a selection is handled, so the progress messages,
+ * the result and the next menu leave as one TX transfer once the menu waits
+ * for input again.
+ *
+ * An empty input line is the UART handler's abort marker (Ctrl-C or break).
+ * It leaves any sub-menu and redisplays the main menu prompt.
+ *
  * Author: Ameed Othman
  * Date: 2024-12-19
  */
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "app_config.h"
@@ -37,14 +49,52 @@
 #include "menu_actions.h"
 #include "uart_handler.h"
 #include "commands.h"
+#include "event_log.h"
+#include "menu_list.h"
 
 LOG_MODULE_REGISTER(menu_core, LOG_LEVEL_INF);
 
-static const int menu_input_max_len = 32;
-
-static char input_buffer[32];
+/* Input lines are copied out of uart_msgq, so they must hold a full message */
+static char input_buffer[UART_MSG_SIZE];
 static bool run = true;
 
+/**
+ * @brief Check whether more input lines are already waiting.
+ *
+ * Used to skip rendering a menu that the next queued selection would
+ * immediately replace.
+ *
+ * @return true if at least one line is queued in uart_msgq.
+ */
+static bool menu_core_input_pending(void)
+{
+	return k_msgq_num_used_get(&uart_msgq) > 0;
+}
+
+/**
+ * @brief Check whether a received line is the abort marker.
+ *
+ * @param input A null-terminated line from uart_msgq.
+ * @return true if the line signals an out-of-band abort.
+ */
+static bool menu_core_is_abort(const char *input)
+{
+	return input[0] == '\0';
+}
+
+/**
+ * @brief Acknowledge an abort and tell the user about it.
+ *
+ * Output is discarded until the abort is cleared, so this must happen before
+ * anything else is printed.
+ */
+static void menu_core_handle_abort(void)
+{
+	uart_handler_abort_clear();
+	uart_handler_write_literal("^C\r\n");
+	LOG_INF("Abort received, returning to main menu");
+}
+
 /**
  * @brief Display the lights sub-menu options to the user.
  *
@@ -53,13 +103,13 @@ static bool run = true;
  */
 static void menu_core_display_lights_menu(void)
 {
-	menu_display_message("Lights Control Menu:");
-	menu_display_message("[1] Turn ON");
-	menu_display_message("[2] Turn OFF");
-	menu_display_message("[3] Increase Brightness");
-	menu_display_message("[4] Decrease Brightness");
-	menu_display_message("[0] Return to Main Menu");
-	menu_display_message("Enter your choice:");
+	menu_display_message_literal("Lights Control Menu:");
+	menu_display_message_literal("[1] Turn ON");
+	menu_display_message_literal("[2] Turn OFF");
+	menu_display_message_literal("[3] Increase Brightness");
+	menu_display_message_literal("[4] Decrease Brightness");
+	menu_display_message_literal("[0] Return to Main Menu");
+	menu_display_message_literal("Enter your choice:");
 }
 
 /**
@@ -76,22 +126,22 @@ static void menu_core_display_lights_menu(void)
 static bool menu_core_handle_lights_input(const char *input)
 {
 	if (strcmp(input, "1") == 0) {
-		uart_handler_write_string("Turning lights ON...\r\n");
+		uart_handler_write_literal("Turning lights ON...\r\n");
 		menu_actions_execute(1, 0);  // action_id=0: Turn ON
 	} else if (strcmp(input, "2") == 0) {
-		uart_handler_write_string("Turning lights OFF...\r\n");
+		uart_handler_write_literal("Turning lights OFF...\r\n");
 		menu_actions_execute(1, 1);  // action_id=1: Turn OFF
 	} else if (strcmp(input, "3") == 0) {
-		uart_handler_write_string("Increasing brightness...\r\n");
+		uart_handler_write_literal("Increasing brightness...\r\n");
 		menu_actions_execute(1, 2);  // action_id=2: Increase Brightness
 	} else if (strcmp(input, "4") == 0) {
-		uart_handler_write_string("Decreasing brightness...\r\n");
+		uart_handler_write_literal("Decreasing brightness...\r\n");
 		menu_actions_execute(1, 3);  // action_id=3: Decrease Brightness
 	} else if (strcmp(input, "0") == 0) {
-		uart_handler_write_string("Returning to main menu...\r\n");
+		uart_handler_write_literal("Returning to main menu...\r\n");
 		return false;  // Go back to main menu
 	} else {
-		menu_display_error("Invalid choice. Please try again.");
+		menu_display_error_literal("Invalid choice. Please try again.");
 	}
 
 	return true; // Continue lights sub-menu loop
@@ -106,17 +156,22 @@ static bool menu_core_handle_lights_input(const char *input)
 static void menu_core_run_lights_menu(void)
 {
 	while (run) {
-		menu_core_display_lights_menu();
+		if (!menu_core_input_pending()) {
+			menu_core_display_lights_menu();
+		}
 
 		memset(input_buffer, 0, sizeof(input_buffer));
+		uart_handler_tx_uncork();
 		int ret = k_msgq_get(&uart_msgq, input_buffer, K_FOREVER);
-		if (ret == 0) {
+		uart_handler_tx_cork();
+		if (ret == 0 && menu_core_is_abort(input_buffer)) {
+			menu_core_handle_abort();
+			break;
+		} else if (ret == 0) {
 			run = menu_core_handle_lights_input(input_buffer);
 		} else {
-			menu_display_error("Failed to read input.");
+			menu_display_error_literal("Failed to read input.");
 		}
-
-		k_sleep(K_MSEC(10));
 	}
 }
 
@@ -131,12 +186,37 @@ static void menu_core_display_main_menu(void)
 	menu_display_show_main_menu();
 }
 
+static size_t menu_core_event_count(void *ctx)
+{
+	ARG_UNUSED(ctx);
+	return event_log_count();
+}
+
+static int menu_core_event_format(size_t index, char *buf, size_t len, void *ctx)
+{
+	struct event_record event;
+
+	ARG_UNUSED(ctx);
+	if (event_log_get(index, &event) < 0) {
+		return snprintf(buf, len, "(expired)");
+	}
+	return event_log_format(&event, buf, len);
+}
+
+/* Diagnostics: page through the event log, oldest event first */
+static const struct menu_list event_log_list = {
+	.title = "Event Log",
+	.count = menu_core_event_count,
+	.format = menu_core_event_format,
+};
+
 /**
  * @brief Process the user's input from the main menu.
  *
  * If the user selects "[1] Control Lights," we now run the lights sub-menu 
  * instead of directly executing a single action. Other menu choices 
- * function as before.
+ * function as before. Input that is not a menu choice is tried as a text
+ * command (see commands_core_execute_line()).
  *
  * @param input A null-terminated string containing the user's choice.
  * @return true if we should continue the main menu loop, false if the user requests exit.
@@ -144,24 +224,31 @@ static void menu_core_display_main_menu(void)
 static bool menu_core_handle_input(const char *input)
 {
 	if (strcmp(input, "1") == 0) {
-		uart_handler_write_string("Lights control selected.\r\n");
+		uart_handler_write_literal("Lights control selected.\r\n");
 		menu_core_run_lights_menu(); // Enter the lights sub-menu
 		run = true;
 		LOG_INF("Returned from lights sub-menu, now resuming main menu loop...");
 	} else if (strcmp(input, "2") == 0) {
-		uart_handler_write_string("Sensor readings selected.\r\n");
+		uart_handler_write_literal("Sensor readings selected.\r\n");
 		menu_actions_execute(2, 0);  // Example: Sensor action
 	} else if (strcmp(input, "3") == 0) {
-		uart_handler_write_string("System configuration selected.\r\n");
+		uart_handler_write_literal("System configuration selected.\r\n");
 		menu_actions_execute(3, 0);  // Example: System config action
 	} else if (strcmp(input, "4") == 0) {
-		uart_handler_write_string("Diagnostics and logs selected.\r\n");
-		menu_actions_execute(4, 0);  // Example: Diagnostics action
+		uart_handler_write_literal("Diagnostics and logs selected.\r\n");
+		menu_list_run(&event_log_list);
 	} else if (strcmp(input, "0") == 0) {
-		uart_handler_write_string("Exiting menu.\r\n");
+		uart_handler_write_literal("Exiting menu.\r\n");
 		return false;  // Stop the main menu loop
 	} else {
-		menu_display_error("Invalid choice. Please try again.");
+		/* Not a menu choice: try it as a text command (tokenized in place) */
+		char line[UART_MSG_SIZE];
+
+		strncpy(line, input, sizeof(line) - 1);
+		line[sizeof(line) - 1] = '\0';
+		if (commands_core_execute_line(line) == -ENOENT) {
+			menu_display_error_literal("Invalid choice. Please try again.");
+		}
 	}
 
 	return true; // Continue main menu loop
@@ -177,24 +264,32 @@ static bool menu_core_handle_input(const char *input)
  */
 void menu_core_run(void)
 {
-	char input_buffer[menu_input_max_len];
+	char input_buffer[UART_MSG_SIZE];
 
 	LOG_INF("Starting main menu loop");
 
+	/* Corked except while waiting for input */
+	uart_handler_tx_cork();
+
 	bool run = true;
 	while (run) {
-		menu_core_display_main_menu();
+		if (!menu_core_input_pending()) {
+			menu_core_display_main_menu();
+		}
 
 		memset(input_buffer, 0, sizeof(input_buffer));
+		uart_handler_tx_uncork();
 		int ret = k_msgq_get(&uart_msgq, input_buffer, K_FOREVER);
-		if (ret == 0) {
+		uart_handler_tx_cork();
+		if (ret == 0 && menu_core_is_abort(input_buffer)) {
+			menu_core_handle_abort();
+		} else if (ret == 0) {
 			run = menu_core_handle_input(input_buffer);
 		} else {
-			menu_display_error("Failed to read input.");
+			menu_display_error_literal("Failed to read input.");
 		}
-
-		k_sleep(K_MSEC(10));
 	}
 
+	uart_handler_tx_uncork();
 	LOG_INF("Exiting main menu loop");
 }
@@ -41,7 +41,7 @@ LOG_MODULE_REGISTER(menu_display, LOG_LEVEL_INF);
 /* 
  * A header template for the main menu.
  */
-static const char *main_menu_header =
+static const char main_menu_header[] =
 	"\r\n"
 	"--------------------------------------\r\n"
 	"      UART Command Center Menu\r\n"
@@ -54,13 +54,31 @@ static const char *main_menu_header =
  */
 void menu_display_show_main_menu(void)
 {
-	uart_handler_write_string(main_menu_header);
-	uart_handler_write_string("[1] Control Lights\r\n");
-	uart_handler_write_string("[2] View Sensor Readings\r\n");
-	uart_handler_write_string("[3] System Configuration\r\n");
-	uart_handler_write_string("[4] Diagnostics and Logs\r\n");
-	uart_handler_write_string("[0] Exit\r\n");
-	uart_handler_write_string("Enter your choice: ");
+	uart_handler_write(main_menu_header, sizeof(main_menu_header) - 1);
+	uart_handler_write_literal("[1] Control Lights\r\n");
+	uart_handler_write_literal("[2] View Sensor Readings\r\n");
+	uart_handler_write_literal("[3] System Configuration\r\n");
+	uart_handler_write_literal("[4] Diagnostics and Logs\r\n");
+	uart_handler_write_literal("[0] Exit\r\n");
+	uart_handler_write_literal("Enter your choice: ");
+}
+
+/**
+ * @brief Print a message of known length, followed by a line break.
+ *
+ * @param msg The message (need not be null-terminated).
+ * @param len Length of the message in bytes.
+ */
+void menu_display_write_message(const char *msg, size_t len)
+{
+	if (!msg) {
+		LOG_WRN("Tried to display a NULL message.");
+		return;
+	}
+
+	uart_handler_write(msg, len);
+	uart_handler_write_literal("\r\n");
+	LOG_DBG("Displayed %u-byte message", (unsigned int)len);
 }
 
 /**
@@ -78,11 +96,28 @@ void menu_display_message(const char *msg)
 		return;
 	}
 
-	uart_handler_write_string(msg);
-	uart_handler_write_string("\r\n");
+	menu_display_write_message(msg, strlen(msg));
 	LOG_INF("Displayed message: %s", msg);
 }
 
+/**
+ * @brief Print an error message of known length.
+ *
+ * @param err_msg The message (need not be null-terminated).
+ * @param len Length of the message in bytes.
+ */
+void menu_display_write_error(const char *err_msg, size_t len)
+{
+	if (!err_msg) {
+		err_msg = "Unknown error.";
+		len = sizeof("Unknown error.") - 1;
+	}
+	uart_handler_write_literal("Error: ");
+	uart_handler_write(err_msg, len);
+	uart_handler_write_literal("\r\n");
+	LOG_WRN("Displayed %u-byte error message", (unsigned int)len);
+}
+
 /**
  * @brief Print an error message indicating invalid input or a similar condition.
  *
@@ -96,8 +131,5 @@ void menu_display_error(const char *err_msg)
 	if (!err_msg) {
 		err_msg = "Unknown error.";
 	}
-	uart_handler_write_string("Error: ");
-	uart_handler_write_string(err_msg);
-	uart_handler_write_string("\r\n");
-	LOG_WRN("Displayed error message: %s", err_msg);
+	menu_display_write_error(err_msg, strlen(err_msg));
 }
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file menu_list.c
+ * @brief Lazily generated, paged list menus.
+ * 
+ * Description:
+ * ------------
+ * This file implements the dynamic list node of the menu system. A list is
+ * described by a `struct menu_list` holding iterator callbacks rather than
+ * the entries themselves. Rendering a page asks the list for its count, then
+ * streams the page through `command_stream.h`: each entry of the page is
+ * formatted only when the UART TX path has room for it, so neither the list
+ * nor the page is ever held in memory as a whole.
+ *
+ * The interactive loop follows the same conventions as menu_core.c: pages are
+ * not redrawn while further input is already queued, and an empty line (the
+ * UART handler's abort marker) leaves the list immediately.
+ * 
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "command_stream.h"
+#include "menu_list.h"
+#include "menu_display.h"
+#include "uart_handler.h"
+
+LOG_MODULE_REGISTER(menu_list, LOG_LEVEL_INF);
+
+/* Cursor of a page being streamed */
+struct menu_list_cursor {
+	const struct menu_list *list;
+	size_t next;
+	size_t last;
+	int rendered;
+};
+
+static size_t menu_list_page_size(const struct menu_list *list)
+{
+	return list->page_size > 0 ? list->page_size : MENU_LIST_PAGE_SIZE;
+}
+
+size_t menu_list_page_count(const struct menu_list *list)
+{
+	if (!list || !list->count) {
+		return 1;
+	}
+
+	size_t count = list->count(list->ctx);
+	size_t pages = (count + menu_list_page_size(list) - 1) / menu_list_page_size(list);
+
+	return pages > 0 ? pages : 1;
+}
+
+/**
+ * @brief Stream producer yielding one formatted list entry per chunk.
+ *
+ * Entries whose format callback fails are skipped.
+ */
+static int menu_list_next_entry(struct command_stream *stream, char *buf, size_t len)
+{
+	struct menu_list_cursor *cursor = stream->ctx;
+	const struct menu_list *list = cursor->list;
+
+	while (cursor->next < cursor->last) {
+		size_t index = cursor->next++;
+		int prefix = snprintf(buf, len, "[%u] ", (unsigned int)(index + 1));
+
+		/* Leave room for the line ending */
+		if (list->format(index, buf + prefix, len - prefix - 2, list->ctx) < 0) {
+			continue;
+		}
+
+		size_t used = strlen(buf);
+		buf[used++] = '\r';
+		buf[used++] = '\n';
+		buf[used] = '\0';
+		cursor->rendered++;
+		return (int)used;
+	}
+
+	return 0;
+}
+
+int menu_list_render_page(const struct menu_list *list, size_t page)
+{
+	if (!list || !list->count || !list->format) {
+		return -EINVAL;
+	}
+
+	char header[MENU_LIST_LINE_MAX];
+	size_t count = list->count(list->ctx);
+	size_t per_page = menu_list_page_size(list);
+	size_t pages = menu_list_page_count(list);
+
+	if (page >= pages) {
+		page = pages - 1;
+	}
+
+	int len = snprintf(header, sizeof(header), "\r\n%s (page %u/%u, %u entries)\r\n",
+			   list->title ? list->title : "List", (unsigned int)(page + 1),
+			   (unsigned int)pages, (unsigned int)count);
+	uart_handler_write_formatted(header, sizeof(header), len);
+
+	struct menu_list_cursor cursor = {
+		.list = list,
+		.next = page * per_page,
+		.last = MIN(page * per_page + per_page, count),
+	};
+	struct command_stream stream = {
+		.next = menu_list_next_entry,
+		.ctx = &cursor,
+	};
+
+	int ret = command_stream_run(&stream);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (list->select) {
+		uart_handler_write_literal("n/p/j <page>, <number> to select, 0 to return: ");
+	} else {
+		uart_handler_write_literal("n/p/j <page>, 0 to return: ");
+	}
+
+	return cursor.rendered;
+}
+
+/**
+ * @brief Process one line of input inside a list menu.
+ *
+ * @param list The list being browsed.
+ * @param input A null-terminated line entered by the user.
+ * @param page In/out current page index.
+ * @return true to stay in the list, false to return to the caller.
+ */
+static bool menu_list_handle_input(const struct menu_list *list, const char *input, size_t *page)
+{
+	size_t pages = menu_list_page_count(list);
+	char *end;
+
+	if (strcmp(input, "0") == 0) {
+		return false;
+	} else if (strcmp(input, "n") == 0) {
+		if (*page + 1 < pages) {
+			(*page)++;
+		}
+	} else if (strcmp(input, "p") == 0) {
+		if (*page > 0) {
+			(*page)--;
+		}
+	} else if (input[0] == 'j' && input[1] == ' ') {
+		long target = strtol(&input[2], &end, 10);
+		if (*end != '\0' || target < 1 || (size_t)target > pages) {
+			menu_display_error_literal("Invalid page number.");
+		} else {
+			*page = (size_t)target - 1;
+		}
+	} else {
+		long choice = strtol(input, &end, 10);
+		if (!list->select || *end != '\0' || choice < 1 ||
+		    (size_t)choice > list->count(list->ctx)) {
+			menu_display_error_literal("Invalid choice. Please try again.");
+		} else {
+			list->select((size_t)choice - 1, list->ctx);
+		}
+	}
+
+	return true;
+}
+
+void menu_list_run(const struct menu_list *list)
+{
+	char input_buffer[UART_MSG_SIZE];
+	size_t page = 0;
+	bool stay = true;
+
+	if (!list) {
+		return;
+	}
+
+	LOG_INF("Entering list menu: %s", list->title ? list->title : "List");
+
+	while (stay) {
+		if (k_msgq_num_used_get(&uart_msgq) == 0) {
+			menu_list_render_page(list, page);
+		}
+
+		/* The caller may have corked output; the page must not wait for that */
+		uart_handler_tx_flush();
+		if (k_msgq_get(&uart_msgq, input_buffer, K_FOREVER) != 0) {
+			menu_display_error_literal("Failed to read input.");
+			continue;
+		}
+
+		if (input_buffer[0] == '\0') {
+			/* Abort marker: the caller's menu loop acknowledges it */
+			(void)k_msgq_put(&uart_msgq, input_buffer, K_NO_WAIT);
+			break;
+		}
+
+		stay = menu_list_handle_input(list, input_buffer, &page);
+	}
+}
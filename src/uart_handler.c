@@ -12,6 +12,24 @@
  * over UART. The UART handler uses a message queue to store incoming lines,
  * making them available for higher-level logic such as command parsing
  * and menu navigation.
+ *
+ * Output is staged in a TX ring buffer and drained by the TX interrupt, so
+ * pending output can be discarded at any time. Receiving Ctrl-C or a break
+ * condition triggers an out-of-band abort: queued TX and queued input are
+ * dropped, writers are released with -ECANCELED, and an empty line is posted
+ * to the message queue so the menu returns to a prompt. The abort signal
+ * (uart_handler_abort_signal()) is raised as well, so commands parked on a
+ * k_poll wait are woken and can end with -ECANCELED.
+ *
+ * Small writes are coalesced: output queued on an idle transmitter starts a
+ * transfer only once UART_TX_COALESCE_BYTES are pending or UART_TX_COALESCE_US
+ * have passed, and a corked response (see uart_handler_tx_cork()) goes out
+ * as a single transfer at uncork. This trades a few hundred microseconds of
+ * latency for far fewer TX interrupt bursts per response.
+ *
+ * A thread can set a reply tag (e.g., "#17 ") that is inserted at the start of
+ * every line it writes, which lets a gateway route the reply of an addressed
+ * command back to the request it belongs to.
  * 
  * @author Ameed Othman
  * @date 2024-12-19
@@ -21,6 +39,7 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/uart.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/ring_buffer.h>
 #include <string.h>
 
 #include "app_config.h"
@@ -38,16 +57,14 @@ static const struct device *uart_dev = DEVICE_DT_GET(UART_DEVICE_NODE);
 
 /* 
  * Buffer for incoming characters before a newline is received.
- * MSG_SIZE and related constants could be defined in app_config.h
- * for consistency and flexibility.
+ * UART_MSG_SIZE and UART_MSGQ_LEN are defined in app_config.h.
  */
-#ifndef UART_MSG_SIZE
-#define UART_MSG_SIZE 64
+#ifndef UART_TX_BUF_SIZE
+#define UART_TX_BUF_SIZE 256
 #endif
 
-#ifndef UART_MSGQ_LEN
-#define UART_MSGQ_LEN 10
-#endif
+/* Control character that requests an out-of-band abort (Ctrl-C) */
+#define UART_ABORT_CHAR 0x03
 
 /* Message queue to hold complete lines received via UART */
 K_MSGQ_DEFINE(uart_msgq, UART_MSG_SIZE, UART_MSGQ_LEN, 4);
@@ -56,6 +73,46 @@ K_MSGQ_DEFINE(uart_msgq, UART_MSG_SIZE, UART_MSGQ_LEN, 4);
 static char rx_buf[UART_MSG_SIZE];
 static size_t rx_buf_pos = 0;
 
+/*
+ * Pending output. Producers append under tx_lock, the TX interrupt drains it
+ * into the hardware FIFO. tx_space_sem is given whenever room is freed (or an
+ * abort releases blocked writers).
+ */
+RING_BUF_DECLARE(tx_ringbuf, UART_TX_BUF_SIZE);
+static struct k_spinlock tx_lock;
+static K_SEM_DEFINE(tx_space_sem, 0, 1);
+static bool tx_irq_driven;
+
+/*
+ * Coalescing state, under tx_lock: whether the TX interrupt is draining the
+ * ring buffer, whether tx_flush_timer will start a transfer, and the cork
+ * nesting depth.
+ */
+static void uart_handler_tx_deadline(struct k_timer *timer);
+static K_TIMER_DEFINE(tx_flush_timer, uart_handler_tx_deadline, NULL);
+static bool tx_active;
+static bool tx_flush_armed;
+static unsigned int tx_cork_depth;
+static struct uart_handler_tx_stats tx_stats;
+
+/* Set from the ISR when an abort is requested, cleared by the menu */
+static atomic_t abort_pending;
+static struct k_poll_signal abort_signal = K_POLL_SIGNAL_INITIALIZER(abort_signal);
+
+/* Empty line posted to uart_msgq to wake the reader after an abort */
+static const char abort_line[UART_MSG_SIZE];
+
+/* Reply tag of a thread, and whether its next write starts a line */
+struct uart_handler_reply_tag {
+	k_tid_t owner;
+	const char *tag;
+	size_t tag_len;
+	bool line_start;
+};
+
+static struct uart_handler_reply_tag reply_tags[UART_REPLY_TAG_SLOTS];
+static struct k_spinlock reply_tag_lock;
+
 /* Forward declaration of the interrupt callback */
 static void uart_irq_handler(const struct device *dev, void *user_data);
 
@@ -81,33 +138,380 @@ int uart_handler_init(void)
 		return ret;
 	}
 
+	tx_irq_driven = true;
 	uart_irq_rx_enable(uart_dev);
+	uart_irq_err_enable(uart_dev);
 	LOG_INF("UART initialized and RX interrupt enabled");
 
 	return 0;
 }
 
+/*
+ * Start a transfer of the pending output unless one is already running.
+ */
+static void uart_handler_tx_start(bool deadline)
+{
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+	bool start = !tx_active && !ring_buf_is_empty(&tx_ringbuf);
+
+	if (tx_flush_armed && !deadline) {
+		k_timer_stop(&tx_flush_timer);
+	}
+	tx_flush_armed = false;
+	if (start) {
+		tx_active = true;
+		tx_stats.transfers++;
+		tx_stats.deadline_flushes += deadline;
+	}
+	k_spin_unlock(&tx_lock, key);
+
+	/* Outside the lock: the TX interrupt may run right away */
+	if (start) {
+		uart_irq_tx_enable(uart_dev);
+	}
+}
+
+/*
+ * Coalescing or cork deadline expired: send whatever has collected.
+ */
+static void uart_handler_tx_deadline(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+	uart_handler_tx_start(true);
+}
+
+/*
+ * Queue raw bytes for transmission, blocking while the ring buffer is full.
+ * Output for an idle transmitter is held back for coalescing; a full ring
+ * buffer always starts a transfer, corked or not.
+ */
+static int uart_handler_put(const char *str, size_t len)
+{
+	if (!tx_irq_driven) {
+		for (size_t i = 0; i < len; i++) {
+			uart_poll_out(uart_dev, str[i]);
+		}
+		return 0;
+	}
+
+	while (len > 0) {
+		if (atomic_get(&abort_pending)) {
+			return -ECANCELED;
+		}
+
+		k_spinlock_key_t key = k_spin_lock(&tx_lock);
+		uint32_t written = ring_buf_put(&tx_ringbuf, (const uint8_t *)str, len);
+		bool start = (written == 0);
+
+		if (written > 0) {
+			tx_stats.writes++;
+		}
+		if (written > 0 && !tx_active) {
+			if (tx_cork_depth == 0 && (UART_TX_COALESCE_US == 0 ||
+						   ring_buf_size_get(&tx_ringbuf) >=
+							   UART_TX_COALESCE_BYTES)) {
+				start = true;
+			} else if (!tx_flush_armed) {
+				tx_flush_armed = true;
+				k_timer_start(&tx_flush_timer,
+					      K_USEC(tx_cork_depth > 0 ? UART_TX_CORK_MAX_US
+								       : UART_TX_COALESCE_US),
+					      K_NO_WAIT);
+			}
+		}
+		k_spin_unlock(&tx_lock, key);
+
+		if (start) {
+			uart_handler_tx_start(false);
+		}
+
+		if (written > 0) {
+			str += written;
+			len -= written;
+		} else {
+			/* Ring buffer full: wait for the ISR (or an abort) to free space */
+			k_sem_take(&tx_space_sem, K_FOREVER);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Find the reply tag slot of a thread, optionally claiming a free one.
+ */
+static struct uart_handler_reply_tag *uart_handler_reply_tag_slot(k_tid_t thread, bool claim)
+{
+	struct uart_handler_reply_tag *free_slot = NULL;
+
+	for (size_t i = 0; i < ARRAY_SIZE(reply_tags); i++) {
+		if (reply_tags[i].owner == thread) {
+			return &reply_tags[i];
+		}
+		if (!free_slot && !reply_tags[i].owner) {
+			free_slot = &reply_tags[i];
+		}
+	}
+
+	if (claim && free_slot) {
+		free_slot->owner = thread;
+		return free_slot;
+	}
+	return NULL;
+}
+
+/*
+ * Queue output of a thread that has a reply tag, inserting the tag at every line start.
+ */
+static int uart_handler_put_tagged(struct uart_handler_reply_tag *slot, const char *str,
+				   size_t len)
+{
+	int ret = 0;
+
+	while (len > 0 && ret == 0) {
+		const char *eol = memchr(str, '\n', len);
+		size_t line_len = eol ? (size_t)(eol - str) + 1 : len;
+
+		if (slot->line_start) {
+			ret = uart_handler_put(slot->tag, slot->tag_len);
+		}
+		if (ret == 0) {
+			ret = uart_handler_put(str, line_len);
+		}
+		slot->line_start = (eol != NULL);
+		str += line_len;
+		len -= line_len;
+	}
+
+	return ret;
+}
+
 /**
- * @brief Write a string to the UART output.
+ * @brief Write bytes to the UART output.
  *
- * This function sends a null-terminated string via UART using polling mode.
- * It should be used sparingly for short messages (e.g., prompts, logs).
+ * The data is copied into the TX ring buffer and sent by the TX interrupt.
+ * If the ring buffer is full the caller blocks until the ISR frees space.
+ * Before uart_handler_init() has run, output falls back to polling mode.
+ *
+ * @param data Bytes to send (may contain NUL bytes).
+ * @param len Number of bytes.
+ * @return 0 on success, -ECANCELED if an abort is pending, or -EINVAL on
+ *         invalid parameters.
+ */
+int uart_handler_write(const void *data, size_t len)
+{
+	if (!uart_dev || !data) {
+		return -EINVAL;
+	}
+
+	struct uart_handler_reply_tag *slot = uart_handler_reply_tag_slot(k_current_get(), false);
+
+	if (slot) {
+		return uart_handler_put_tagged(slot, data, len);
+	}
+
+	return uart_handler_put(data, len);
+}
+
+/**
+ * @brief Write a null-terminated string to the UART output.
  *
  * @param str A null-terminated string to send.
- * @return 0 on success, or a negative error code on failure.
+ * @return As for uart_handler_write().
  */
 int uart_handler_write_string(const char *str)
 {
-	if (!uart_dev || !str) {
+	if (!str) {
 		return -EINVAL;
 	}
 
-	size_t len = strlen(str);
-	for (size_t i = 0; i < len; i++) {
-		uart_poll_out(uart_dev, str[i]);
+	return uart_handler_write(str, strlen(str));
+}
+
+/**
+ * @brief Tag every line the calling thread writes.
+ *
+ * @param tag Text inserted at the start of each line (must stay valid until
+ *            cleared), or NULL to stop tagging.
+ */
+void uart_handler_reply_tag_set(const char *tag)
+{
+	k_spinlock_key_t key = k_spin_lock(&reply_tag_lock);
+	struct uart_handler_reply_tag *slot = uart_handler_reply_tag_slot(k_current_get(), tag != NULL);
+
+	if (!slot) {
+		k_spin_unlock(&reply_tag_lock, key);
+		if (tag) {
+			LOG_WRN("No reply tag slot free, output stays untagged");
+		}
+		return;
 	}
 
-	return 0;
+	if (tag) {
+		slot->tag = tag;
+		slot->tag_len = strlen(tag);
+		slot->line_start = true;
+	} else {
+		slot->owner = NULL;
+		slot->tag = NULL;
+	}
+	k_spin_unlock(&reply_tag_lock, key);
+}
+
+/**
+ * @brief Get the reply tag of the calling thread.
+ *
+ * @return The tag, or NULL if the thread has none.
+ */
+const char *uart_handler_reply_tag_get(void)
+{
+	struct uart_handler_reply_tag *slot = uart_handler_reply_tag_slot(k_current_get(), false);
+
+	return slot ? slot->tag : NULL;
+}
+
+/**
+ * @brief Hold back output until the matching uncork.
+ */
+void uart_handler_tx_cork(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+	tx_cork_depth++;
+	k_spin_unlock(&tx_lock, key);
+}
+
+/**
+ * @brief Release a cork; the outermost one sends the collected output.
+ */
+void uart_handler_tx_uncork(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+	bool last = (tx_cork_depth == 1);
+
+	if (tx_cork_depth > 0) {
+		tx_cork_depth--;
+	}
+	k_spin_unlock(&tx_lock, key);
+
+	if (last && tx_irq_driven) {
+		uart_handler_tx_start(false);
+	}
+}
+
+/**
+ * @brief Send collected output now, corked or not.
+ */
+void uart_handler_tx_flush(void)
+{
+	if (tx_irq_driven) {
+		uart_handler_tx_start(false);
+	}
+}
+
+/**
+ * @brief Get the TX transfer counters.
+ *
+ * @param stats Pointer receiving the counters.
+ */
+void uart_handler_tx_get_stats(struct uart_handler_tx_stats *stats)
+{
+	if (!stats) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+	*stats = tx_stats;
+	k_spin_unlock(&tx_lock, key);
+}
+
+/**
+ * @brief Wait for room in the TX ring buffer.
+ *
+ * Woken by the TX interrupt each time it frees space, or by an abort.
+ *
+ * @param len Number of bytes the caller intends to write.
+ * @param timeout Maximum time to wait for space (per wake-up).
+ * @return 0 when space is available, or a negative error code.
+ */
+int uart_handler_tx_wait_space(size_t len, k_timeout_t timeout)
+{
+	if (len > UART_TX_BUF_SIZE) {
+		return -EINVAL;
+	}
+
+	if (!tx_irq_driven) {
+		return 0;
+	}
+
+	while (true) {
+		if (atomic_get(&abort_pending)) {
+			return -ECANCELED;
+		}
+
+		k_spinlock_key_t key = k_spin_lock(&tx_lock);
+		uint32_t space = ring_buf_space_get(&tx_ringbuf);
+		k_spin_unlock(&tx_lock, key);
+
+		if (space >= len) {
+			return 0;
+		}
+
+		/* Space is only freed by a running transfer, so don't hold output back */
+		uart_handler_tx_start(false);
+
+		if (k_sem_take(&tx_space_sem, timeout) != 0) {
+			return -EAGAIN;
+		}
+	}
+}
+
+/**
+ * @brief Check whether an out-of-band abort is pending.
+ *
+ * @return true between an abort request and uart_handler_abort_clear().
+ */
+bool uart_handler_abort_pending(void)
+{
+	return atomic_get(&abort_pending) != 0;
+}
+
+/**
+ * @brief Acknowledge a pending abort so that output is accepted again.
+ */
+void uart_handler_abort_clear(void)
+{
+	atomic_clear(&abort_pending);
+	k_poll_signal_reset(&abort_signal);
+}
+
+/**
+ * @brief Get the signal raised on every abort.
+ *
+ * @return The signal, reset by uart_handler_abort_clear().
+ */
+struct k_poll_signal *uart_handler_abort_signal(void)
+{
+	return &abort_signal;
+}
+
+/*
+ * Out-of-band abort, called from the ISR on Ctrl-C or a break condition.
+ * Discards pending TX and any partially received or queued input, releases
+ * blocked writers and posts an empty line so a waiting reader wakes up.
+ * Only bytes already in the hardware FIFO are still transmitted.
+ */
+static void uart_handler_abort_from_isr(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+	ring_buf_reset(&tx_ringbuf);
+	k_spin_unlock(&tx_lock, key);
+
+	atomic_set(&abort_pending, 1);
+	rx_buf_pos = 0;
+	k_msgq_purge(&uart_msgq);
+	(void)k_msgq_put(&uart_msgq, abort_line, K_NO_WAIT);
+	k_sem_give(&tx_space_sem);
+	k_poll_signal_raise(&abort_signal, -ECANCELED);
 }
 
 /**
@@ -130,10 +534,34 @@ static int uart_handler_read_line(char *buffer, k_timeout_t timeout)
 	return k_msgq_get(&uart_msgq, buffer, timeout);
 }
 
+/*
+ * TX half of the interrupt: move as much pending output as the hardware FIFO
+ * accepts. When nothing is left the TX interrupt is disabled until the next
+ * write re-enables it.
+ */
+static void uart_irq_tx_drain(const struct device *dev)
+{
+	uint8_t *data;
+
+	k_spinlock_key_t key = k_spin_lock(&tx_lock);
+	uint32_t len = ring_buf_get_claim(&tx_ringbuf, &data, UART_TX_BUF_SIZE);
+	if (len == 0) {
+		uart_irq_tx_disable(dev);
+		tx_active = false;
+	} else {
+		int sent = uart_fifo_fill(dev, data, len);
+		ring_buf_get_finish(&tx_ringbuf, sent > 0 ? sent : 0);
+	}
+	k_spin_unlock(&tx_lock, key);
+
+	k_sem_give(&tx_space_sem);
+}
+
 /* 
  * UART interrupt callback:
- * Reads characters from the UART hardware until FIFO is empty.
- * If a newline is encountered, the accumulated line is pushed onto the message queue.
+ * Drains pending output, then reads characters from the UART hardware until
+ * the FIFO is empty. If a newline is encountered, the accumulated line is
+ * pushed onto the message queue. Ctrl-C or a break condition aborts instead.
  * Characters beyond the buffer size are dropped to prevent overflow.
  */
 static void uart_irq_handler(const struct device *dev, void *user_data)
@@ -144,12 +572,26 @@ static void uart_irq_handler(const struct device *dev, void *user_data)
 		return;
 	}
 
+	if (uart_irq_tx_ready(uart_dev)) {
+		uart_irq_tx_drain(uart_dev);
+	}
+
+	int err = uart_err_check(uart_dev);
+	if (err > 0 && (err & UART_BREAK)) {
+		uart_handler_abort_from_isr();
+	}
+
 	if (!uart_irq_rx_ready(uart_dev)) {
 		return;
 	}
 
 	uint8_t c;
 	while (uart_fifo_read(uart_dev, &c, 1) == 1) {
+		if (c == UART_ABORT_CHAR) {
+			uart_handler_abort_from_isr();
+			continue;
+		}
+
 		/* Check for end-of-line */
 		if ((c == '\n' || c == '\r') && rx_buf_pos > 0) {
 			rx_buf[rx_buf_pos] = '\0';
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file change_seq.c
+ * @brief Global change sequence numbers.
+ *
+ * Description:
+ * ------------
+ * This file implements the global change sequence from `change_seq.h` as a
+ * single atomic counter. Each boot gets a range of 2^CHANGE_SEQ_BOOT_SHIFT
+ * numbers starting at (boot count << CHANGE_SEQ_BOOT_SHIFT), so sequence
+ * numbers from different boots never overlap as long as the boot counter is
+ * persisted. Without a journal every boot reuses the range of boot 1.
+ *
+ * Two limits are guarded. A boot that uses up its 2^24 numbers continues in
+ * the next epoch, exactly as if it had rebooted. When the 8-bit epoch wraps,
+ * a cursor from 255 epochs ago can look current, so every cursor is treated
+ * as stale for the rest of that boot. Cursors older than 255 epochs within
+ * one boot are not detected.
+ *
+ * Object versions start at the floor plus one, in the same per-boot range.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "change_seq.h"
+#include "state_journal.h"
+
+LOG_MODULE_REGISTER(change_seq, LOG_LEVEL_INF);
+
+/* Sequence numbers available per boot: 2^24 changes */
+#define CHANGE_SEQ_BOOT_SHIFT 24
+#define CHANGE_SEQ_EPOCH_MASK BIT_MASK(32 - CHANGE_SEQ_BOOT_SHIFT)
+
+static struct k_spinlock seq_lock;
+static uint32_t seq;
+static uint32_t floor_seq;
+static int32_t epoch;
+static bool wrapped;
+
+static void change_seq_persist(struct k_work *work)
+{
+	k_spinlock_key_t key = k_spin_lock(&seq_lock);
+	int32_t boots = epoch;
+	k_spin_unlock(&seq_lock, key);
+
+	(void)state_journal_append(STATE_KEY_BOOT_COUNT, boots);
+}
+
+static K_WORK_DEFINE(persist_work, change_seq_persist);
+
+/* Move to the next epoch. Epoch 0 is skipped: its floor would be 0, which
+ * hosts use to ask for a snapshot. Must be called with seq_lock held.
+ */
+static void change_seq_advance_epoch(void)
+{
+	epoch = (epoch + 1) & (int32_t)CHANGE_SEQ_EPOCH_MASK;
+	if (epoch == 0) {
+		epoch = 1;
+		wrapped = true;
+	}
+
+	floor_seq = (uint32_t)epoch << CHANGE_SEQ_BOOT_SHIFT;
+	seq = floor_seq;
+}
+
+void change_seq_init(void)
+{
+	int32_t boots = 0;
+	uint32_t floor;
+	bool rolled_over;
+
+	/* The journal takes a mutex: read it before taking the spinlock */
+	(void)state_journal_get(STATE_KEY_BOOT_COUNT, &boots);
+
+	k_spinlock_key_t key = k_spin_lock(&seq_lock);
+
+	epoch = boots;
+	wrapped = false;
+	change_seq_advance_epoch();
+	boots = epoch;
+	floor = floor_seq;
+	rolled_over = wrapped;
+
+	k_spin_unlock(&seq_lock, key);
+
+	(void)state_journal_append(STATE_KEY_BOOT_COUNT, boots);
+
+	LOG_INF("Boot %d, change sequence starts at %u%s", boots, floor,
+		rolled_over ? " (boot counter wrapped)" : "");
+}
+
+uint32_t change_seq_next(void)
+{
+	bool rolled = false;
+	k_spinlock_key_t key = k_spin_lock(&seq_lock);
+
+	if (seq - floor_seq == (uint32_t)BIT_MASK(CHANGE_SEQ_BOOT_SHIFT)) {
+		/* This boot's range is used up: continue in a fresh epoch as if
+		 * the device had rebooted, so every cursor handed out so far is
+		 * below the new floor and forces a snapshot.
+		 */
+		change_seq_advance_epoch();
+		rolled = true;
+	}
+
+	uint32_t next = ++seq;
+
+	k_spin_unlock(&seq_lock, key);
+
+	if (rolled) {
+		/* May be called under other spinlocks: journal from a work item */
+		k_work_submit(&persist_work);
+		LOG_WRN("Change sequence exhausted, continuing at %u", next);
+	}
+
+	return next;
+}
+
+uint32_t change_seq_current(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&seq_lock);
+	uint32_t current = seq;
+	k_spin_unlock(&seq_lock, key);
+
+	return current;
+}
+
+uint32_t change_seq_floor(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&seq_lock);
+	uint32_t floor = floor_seq;
+	k_spin_unlock(&seq_lock, key);
+
+	return floor;
+}
+
+uint32_t change_seq_first_version(void)
+{
+	return change_seq_floor() + 1;
+}
+
+bool change_seq_is_stale(uint32_t since)
+{
+	k_spinlock_key_t key = k_spin_lock(&seq_lock);
+	bool stale = wrapped || since < floor_seq || since > seq;
+	k_spin_unlock(&seq_lock, key);
+
+	return stale;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file config_store.c
+ * @brief Versioned runtime configuration values.
+ *
+ * Description:
+ * ------------
+ * This file implements the config store declared in `config_store.h`. The
+ * keys live in a static table holding each key's name, range, default,
+ * current value and version. All access goes through a single mutex, so a
+ * compare-and-set is atomic with respect to other hosts' writes.
+ *
+ * Versions start at change_seq_first_version(), which differs on every boot,
+ * and increase by one per applied change. Each change is
+ * also stamped with a global change sequence number for delta sync. Writing the
+ * value a key already has is accepted but does not bump its version.
+ *
+ * A module that keeps state derived from a key (e.g., lights energy metering
+ * from `rated_w`) registers an observer, which is called after each change
+ * with the old and the new value. The observer runs after the new value is
+ * published, so such a module works from its own copy of the value, updated
+ * by the observer.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "change_seq.h"
+#include "config_store.h"
+#include "event_log.h"
+#include "state_journal.h"
+
+LOG_MODULE_REGISTER(config_store, LOG_LEVEL_INF);
+
+BUILD_ASSERT(CONFIG_KEY_COUNT <= STATE_JOURNAL_CONFIG_KEYS,
+	     "config keys exceed the journal key layout");
+
+struct config_entry {
+	const char *name;
+	int32_t min;
+	int32_t max;
+	int32_t def;
+	int32_t value;
+	uint32_t version;
+	uint32_t change_seq;
+};
+
+static struct config_entry config_entries[CONFIG_KEY_COUNT] = {
+	[CONFIG_KEY_BRIGHTNESS_STEP] = {
+		.name = "brightness_step", .min = 1, .max = 50, .def = 10, .value = 10, .version = 1,
+	},
+	[CONFIG_KEY_BRIGHTNESS_MAX] = {
+		.name = "brightness_max", .min = 0, .max = 100, .def = 100, .value = 100, .version = 1,
+	},
+	[CONFIG_KEY_DEFAULT_LEVEL] = {
+		.name = "default_level", .min = 0, .max = 100, .def = 50, .value = 50, .version = 1,
+	},
+	[CONFIG_KEY_REG_CHANNEL] = {
+		.name = "reg_channel", .min = 0, .max = LIGHTS_CHANNEL_COUNT - 1, .def = 0, .value = 0,
+		.version = 1,
+	},
+	[CONFIG_KEY_REG_SETPOINT] = {
+		.name = "reg_setpoint", .min = 0, .max = 100000, .def = 300, .value = 300, .version = 1,
+	},
+	[CONFIG_KEY_REG_KP] = {
+		.name = "reg_kp", .min = 0, .max = 100000, .def = 20, .value = 20, .version = 1,
+	},
+	[CONFIG_KEY_REG_KI] = {
+		.name = "reg_ki", .min = 0, .max = 100000, .def = 50, .value = 50, .version = 1,
+	},
+	[CONFIG_KEY_REG_MIN_LEVEL] = {
+		.name = "reg_min_level", .min = 0, .max = 100, .def = 0, .value = 0, .version = 1,
+	},
+	[CONFIG_KEY_REG_MAX_LEVEL] = {
+		.name = "reg_max_level", .min = 0, .max = 100, .def = 100, .value = 100, .version = 1,
+	},
+	[CONFIG_KEY_REG_SLEW] = {
+		.name = "reg_slew", .min = 1, .max = 1000, .def = 20, .value = 20, .version = 1,
+	},
+	[CONFIG_KEY_REG_PERIOD_MS] = {
+		.name = "reg_period_ms", .min = 10, .max = 10000, .def = 100, .value = 100,
+		.version = 1,
+	},
+	[CONFIG_KEY_REG_DEADBAND] = {
+		.name = "reg_deadband", .min = 0, .max = 10000, .def = 5, .value = 5, .version = 1,
+	},
+	[CONFIG_KEY_UNIT_ADDRESS] = {
+		.name = "unit_address", .min = 1, .max = 254, .def = 1, .value = 1, .version = 1,
+	},
+	[CONFIG_KEY_GATEWAY] = {
+		.name = "gateway", .min = 0, .max = 1, .def = 0, .value = 0, .version = 1,
+	},
+	[CONFIG_KEY_COALESCE_MS] = {
+		.name = "coalesce_ms", .min = 0, .max = 1000, .def = 0, .value = 0, .version = 1,
+	},
+	[CONFIG_KEY_RATED_W] = {
+		.name = "rated_w", .min = 0, .max = 1000, .def = 10, .value = 10, .version = 1,
+	},
+};
+
+static K_MUTEX_DEFINE(config_lock);
+static config_store_observer_fn observers[CONFIG_KEY_COUNT];
+
+void config_store_init(void)
+{
+	int32_t value;
+
+	k_mutex_lock(&config_lock, K_FOREVER);
+	for (int key = 0; key < CONFIG_KEY_COUNT; key++) {
+		struct config_entry *entry = &config_entries[key];
+
+		entry->value = entry->def;
+		entry->version = change_seq_first_version();
+		entry->change_seq = change_seq_floor();
+
+		if (state_journal_get(STATE_KEY_CONFIG(key), &value) == 0 &&
+		    value >= entry->min && value <= entry->max) {
+			entry->value = value;
+		}
+	}
+	k_mutex_unlock(&config_lock);
+
+	LOG_INF("Config store initialized with %d keys", CONFIG_KEY_COUNT);
+}
+
+int config_store_get(enum config_key key, int32_t *value, uint32_t *version)
+{
+	if ((unsigned int)key >= CONFIG_KEY_COUNT || !value) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&config_lock, K_FOREVER);
+	*value = config_entries[key].value;
+	if (version) {
+		*version = config_entries[key].version;
+	}
+	k_mutex_unlock(&config_lock);
+
+	return 0;
+}
+
+int32_t config_store_value(enum config_key key)
+{
+	int32_t value = 0;
+
+	(void)config_store_get(key, &value, NULL);
+	return value;
+}
+
+int config_store_set(enum config_key key, int32_t value, uint32_t expected_version,
+		     int32_t *current_value, uint32_t *current_version)
+{
+	config_store_observer_fn observer = NULL;
+	int32_t old_value;
+	int ret = 0;
+
+	if ((unsigned int)key >= CONFIG_KEY_COUNT) {
+		return -EINVAL;
+	}
+
+	struct config_entry *entry = &config_entries[key];
+
+	k_mutex_lock(&config_lock, K_FOREVER);
+	old_value = entry->value;
+
+	if (value < entry->min || value > entry->max) {
+		ret = -EINVAL;
+	} else if (expected_version != CONFIG_STORE_VERSION_ANY &&
+		   expected_version != entry->version) {
+		ret = -EAGAIN;
+	} else if (value != entry->value) {
+		entry->value = value;
+		entry->version++;
+		entry->change_seq = event_log_record(EVENT_CONFIG, key, value, entry->version);
+		(void)state_journal_append(STATE_KEY_CONFIG(key), value);
+		LOG_INF("Config %s set to %d (version %u)", entry->name, value, entry->version);
+		observer = observers[key];
+	}
+
+	if (current_value) {
+		*current_value = entry->value;
+	}
+	if (current_version) {
+		*current_version = entry->version;
+	}
+
+	k_mutex_unlock(&config_lock);
+
+	if (observer) {
+		observer(key, old_value, value);
+	}
+	return ret;
+}
+
+int config_store_observe(enum config_key key, config_store_observer_fn fn)
+{
+	if ((unsigned int)key >= CONFIG_KEY_COUNT) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&config_lock, K_FOREVER);
+	observers[key] = fn;
+	k_mutex_unlock(&config_lock);
+
+	return 0;
+}
+
+uint32_t config_store_change_seq(enum config_key key)
+{
+	uint32_t change_seq = 0;
+
+	if ((unsigned int)key >= CONFIG_KEY_COUNT) {
+		return 0;
+	}
+
+	k_mutex_lock(&config_lock, K_FOREVER);
+	change_seq = config_entries[key].change_seq;
+	k_mutex_unlock(&config_lock);
+
+	return change_seq;
+}
+
+const char *config_store_key_name(enum config_key key)
+{
+	if ((unsigned int)key >= CONFIG_KEY_COUNT) {
+		return NULL;
+	}
+
+	return config_entries[key].name;
+}
+
+int config_store_key_from_name(const char *name)
+{
+	if (!name) {
+		return -EINVAL;
+	}
+
+	for (int key = 0; key < CONFIG_KEY_COUNT; key++) {
+		if (strcmp(config_entries[key].name, name) == 0) {
+			return key;
+		}
+	}
+
+	return -ENOENT;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file device_time.c
+ * @brief Device time and its offset to the host's time base.
+ *
+ * Description:
+ * ------------
+ * This file implements `device_time.h`. Device time comes from the 64-bit
+ * hardware cycle counter, so its resolution is well below one system tick;
+ * the cycle counter drives the system timer, so device time and absolute
+ * kernel timeouts share one time base. Targets without a 64-bit cycle
+ * counter fall back to the tick counter. The offset is a
+ * 64-bit value shared between threads and read from the lights scene
+ * timer path, so it is guarded by a spinlock.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-23
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "device_time.h"
+
+LOG_MODULE_REGISTER(device_time, LOG_LEVEL_INF);
+
+static int64_t offset_us;
+static struct k_spinlock offset_lock;
+
+int64_t device_time_now_us(void)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+	return (int64_t)k_cyc_to_us_floor64(k_cycle_get_64());
+#else
+	return (int64_t)k_ticks_to_us_floor64(k_uptime_ticks());
+#endif
+}
+
+void device_time_set_offset(int64_t offset)
+{
+	k_spinlock_key_t key = k_spin_lock(&offset_lock);
+
+	offset_us = offset;
+	k_spin_unlock(&offset_lock, key);
+	LOG_INF("Host time offset set to %lld us", (long long)offset);
+}
+
+int64_t device_time_get_offset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&offset_lock);
+	int64_t offset = offset_us;
+
+	k_spin_unlock(&offset_lock, key);
+	return offset;
+}
+
+int64_t device_time_from_host(int64_t host_us)
+{
+	return host_us - device_time_get_offset();
+}
+
+int64_t device_time_to_host(int64_t device_us)
+{
+	return device_us + device_time_get_offset();
+}
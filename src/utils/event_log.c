@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file event_log.c
+ * @brief Bounded in-RAM log of state change and alarm events.
+ *
+ * Description:
+ * ------------
+ * This file implements the event ring buffer from `event_log.h`. Events are
+ * stored in sequence order; when the ring is full the oldest event is
+ * overwritten and its sequence number is remembered in `lost_seq`. A reader
+ * that has seen everything up to `seq` missed events exactly when
+ * `lost_seq > seq`, which is how gaps are detected without requiring the
+ * sequence numbers of events to be contiguous (they share the global change
+ * sequence with other stamped changes).
+ *
+ * A spinlock protects the ring so that alarms can be recorded from ISRs.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <stdio.h>
+
+#include "app_config.h"
+#include "change_seq.h"
+#include "event_log.h"
+
+static struct event_record events[EVENT_LOG_SIZE];
+static size_t head;  /* Index of the oldest event */
+static size_t count;
+static uint32_t lost_seq;
+static struct k_spinlock event_lock;
+
+uint32_t event_log_record(enum event_type type, uint16_t id, int32_t value, int32_t aux)
+{
+	k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+	/* Allocated under the lock so the ring stays in sequence order */
+	uint32_t seq = change_seq_next();
+	struct event_record *event;
+
+	if (count == EVENT_LOG_SIZE) {
+		lost_seq = events[head].seq;
+		event = &events[head];
+		head = (head + 1) % EVENT_LOG_SIZE;
+	} else {
+		event = &events[(head + count) % EVENT_LOG_SIZE];
+		count++;
+	}
+
+	event->seq = seq;
+	event->timestamp_ms = k_uptime_get_32();
+	event->type = type;
+	event->id = id;
+	event->value = value;
+	event->aux = aux;
+
+	k_spin_unlock(&event_lock, key);
+	return seq;
+}
+
+int event_log_next_after(uint32_t seq, struct event_record *event)
+{
+	int ret = -ENOENT;
+	k_spinlock_key_t key = k_spin_lock(&event_lock);
+	uint32_t floor = change_seq_floor();
+	uint32_t current = change_seq_current();
+
+	for (size_t i = 0; i < count; i++) {
+		const struct event_record *candidate = &events[(head + i) % EVENT_LOG_SIZE];
+
+		/* Entries from before a sequence rollover are not replayed */
+		if (candidate->seq > seq && candidate->seq >= floor && candidate->seq <= current) {
+			*event = *candidate;
+			ret = 0;
+			break;
+		}
+	}
+
+	k_spin_unlock(&event_lock, key);
+	return ret;
+}
+
+bool event_log_has_gap(uint32_t seq)
+{
+	k_spinlock_key_t key = k_spin_lock(&event_lock);
+	bool gap = lost_seq > seq;
+	k_spin_unlock(&event_lock, key);
+
+	return gap || change_seq_is_stale(seq);
+}
+
+size_t event_log_count(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&event_lock);
+	size_t n = count;
+	k_spin_unlock(&event_lock, key);
+
+	return n;
+}
+
+int event_log_get(size_t index, struct event_record *event)
+{
+	int ret = -ENOENT;
+	k_spinlock_key_t key = k_spin_lock(&event_lock);
+
+	if (index < count) {
+		*event = events[(head + index) % EVENT_LOG_SIZE];
+		ret = 0;
+	}
+
+	k_spin_unlock(&event_lock, key);
+	return ret;
+}
+
+int event_log_format(const struct event_record *event, char *buf, size_t len)
+{
+	switch (event->type) {
+	case EVENT_LIGHTS:
+		return snprintf(buf, len, "EVENT %u t=%u LIGHTS ch=%u on=%d level=%d", event->seq,
+				event->timestamp_ms, event->id, event->aux, event->value);
+	case EVENT_CONFIG:
+		return snprintf(buf, len, "EVENT %u t=%u CONFIG key=%u value=%d ver=%d", event->seq,
+				event->timestamp_ms, event->id, event->value, event->aux);
+	case EVENT_ALARM:
+		if (event->id == EVENT_ALARM_SENSOR_FAILED) {
+			return snprintf(buf, len, "EVENT %u t=%u ALARM src=%u err=%d ch=%d", event->seq,
+					event->timestamp_ms, event->id, event->value, event->aux);
+		}
+		return snprintf(buf, len, "EVENT %u t=%u ALARM src=%u value=%d limit=%d", event->seq,
+				event->timestamp_ms, event->id, event->value, event->aux);
+	default:
+		return snprintf(buf, len, "EVENT %u t=%u UNKNOWN type=%u", event->seq,
+				event->timestamp_ms, event->type);
+	}
+}
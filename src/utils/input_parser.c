@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file input_parser.c
+ * @brief Parsing helpers for text commands.
+ *
+ * Description:
+ * ------------
+ * This file implements the tokenizer and number parsers declared in
+ * `input_parser.h`. Everything works in place on the caller's line buffer,
+ * so parsing a command needs no memory beyond the argv array.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "input_parser.h"
+
+static bool input_parser_is_space(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+static bool input_parser_is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+int input_parser_tokenize(char *line, char *argv[], int max_args)
+{
+	int argc = 0;
+
+	if (!line || !argv) {
+		return -EINVAL;
+	}
+
+	while (*line != '\0') {
+		while (input_parser_is_space(*line)) {
+			*line++ = '\0';
+		}
+
+		if (*line == '\0') {
+			break;
+		}
+
+		if (argc == max_args) {
+			return -E2BIG;
+		}
+		argv[argc++] = line;
+
+		while (*line != '\0' && !input_parser_is_space(*line)) {
+			line++;
+		}
+	}
+
+	return argc;
+}
+
+int input_parser_parse_int(const char *str, int32_t *value)
+{
+	char *end;
+
+	if (!str || !value || *str == '\0') {
+		return -EINVAL;
+	}
+
+	errno = 0;
+	long parsed = strtol(str, &end, 10);
+	if (*end != '\0' || errno == ERANGE || parsed < INT32_MIN || parsed > INT32_MAX) {
+		return -EINVAL;
+	}
+
+	*value = (int32_t)parsed;
+	return 0;
+}
+
+int input_parser_parse_int64(const char *str, int64_t *value)
+{
+	char *end;
+
+	if (!str || !value || *str == '\0') {
+		return -EINVAL;
+	}
+
+	errno = 0;
+	long long parsed = strtoll(str, &end, 10);
+	if (*end != '\0' || errno == ERANGE) {
+		return -EINVAL;
+	}
+
+	*value = (int64_t)parsed;
+	return 0;
+}
+
+int input_parser_parse_uint(const char *str, uint32_t *value)
+{
+	char *end;
+
+	if (!str || !value || *str == '\0' || *str == '-') {
+		return -EINVAL;
+	}
+
+	errno = 0;
+	unsigned long parsed = strtoul(str, &end, 10);
+	if (*end != '\0' || errno == ERANGE || parsed > UINT32_MAX) {
+		return -EINVAL;
+	}
+
+	*value = (uint32_t)parsed;
+	return 0;
+}
+
+int input_parser_parse_on_off(const char *str, bool *on)
+{
+	if (!str || !on) {
+		return -EINVAL;
+	}
+
+	if (strcmp(str, "on") == 0 || strcmp(str, "1") == 0) {
+		*on = true;
+	} else if (strcmp(str, "off") == 0 || strcmp(str, "0") == 0) {
+		*on = false;
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int input_parser_parse_channels(const char *str, unsigned int count, const uint32_t *groups,
+				size_t group_count, uint32_t *mask)
+{
+	uint32_t selected = 0;
+
+	if (!str || !mask || count == 0 || count > 32 || (group_count > 0 && !groups)) {
+		return -EINVAL;
+	}
+
+	uint32_t all = GENMASK(count - 1, 0);
+	const char *item = str;
+
+	while (true) {
+		char *end = (char *)item;
+		unsigned long first;
+		unsigned long last;
+
+		if (*item == '*') {
+			selected |= all;
+			end++;
+		} else if (*item == 'g' && input_parser_is_digit(item[1])) {
+			first = strtoul(item + 1, &end, 10);
+			if (first >= group_count) {
+				return -EINVAL;
+			}
+			selected |= groups[first] & all;
+		} else if (input_parser_is_digit(*item)) {
+			first = strtoul(item, &end, 10);
+			last = first;
+			if (*end == '-' && input_parser_is_digit(end[1])) {
+				last = strtoul(end + 1, &end, 10);
+			}
+			if (first > last || last >= count) {
+				return -EINVAL;
+			}
+			selected |= GENMASK(last, first);
+		} else {
+			return -EINVAL;
+		}
+
+		if (*end == '\0') {
+			break;
+		}
+		if (*end != ',') {
+			return -EINVAL;
+		}
+		item = end + 1;
+	}
+
+	*mask = selected;
+	return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file sensor_filter.c
+ * @brief Fixed-point streaming filters for sensor samples.
+ *
+ * Description:
+ * ------------
+ * This file implements the filters from `sensor_filter.h` using integer
+ * arithmetic only. Filters hold no locks; the owner of a chain (the sensor
+ * readings driver) serializes access to it.
+ *
+ * The median keeps a sorted copy of its window: each sample removes the
+ * oldest value from the sorted array and inserts the new one, which costs
+ * O(N) moves instead of sorting the window per sample.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/kernel.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sensor_filter.h"
+
+static const char *const type_names[SENSOR_FILTER_TYPE_COUNT] = {
+	[SENSOR_FILTER_NONE] = "none",
+	[SENSOR_FILTER_MEDIAN] = "median",
+	[SENSOR_FILTER_EWMA] = "ewma",
+	[SENSOR_FILTER_AVERAGE] = "average",
+	[SENSOR_FILTER_DECIMATE] = "decimate",
+	[SENSOR_FILTER_DEADBAND] = "deadband",
+};
+
+int sensor_filter_init(struct sensor_filter *filter, const struct sensor_filter_config *config)
+{
+	int32_t param = config->param;
+	bool valid;
+
+	switch (config->type) {
+	case SENSOR_FILTER_MEDIAN:
+	case SENSOR_FILTER_AVERAGE:
+		valid = param >= 1 && param <= SENSOR_FILTER_WINDOW_MAX;
+		break;
+	case SENSOR_FILTER_EWMA:
+		valid = param >= 1 && param <= 256;
+		break;
+	case SENSOR_FILTER_DECIMATE:
+		valid = param >= 1 && param <= 10000;
+		break;
+	case SENSOR_FILTER_DEADBAND:
+		valid = param >= 0;
+		break;
+	default:
+		valid = false;
+		break;
+	}
+
+	if (!valid) {
+		return -EINVAL;
+	}
+
+	memset(filter, 0, sizeof(*filter));
+	filter->config = *config;
+	return 0;
+}
+
+/**
+ * @brief Median: replace the oldest sample in the sorted window by the new one.
+ */
+static int32_t sensor_filter_median(struct sensor_filter *filter, int32_t in)
+{
+	size_t n = filter->config.param;
+	size_t i;
+
+	if (filter->count == n) {
+		/* Remove the oldest sample from the sorted array */
+		int32_t oldest = filter->window[filter->pos];
+
+		for (i = 0; filter->sorted[i] != oldest; i++) {
+		}
+		memmove(&filter->sorted[i], &filter->sorted[i + 1],
+			(filter->count - i - 1) * sizeof(int32_t));
+		filter->count--;
+	}
+
+	filter->window[filter->pos] = in;
+	filter->pos = (filter->pos + 1) % n;
+
+	/* Insert the new sample, shifting larger values up */
+	for (i = filter->count; i > 0 && filter->sorted[i - 1] > in; i--) {
+		filter->sorted[i] = filter->sorted[i - 1];
+	}
+	filter->sorted[i] = in;
+	filter->count++;
+
+	return filter->sorted[(filter->count - 1) / 2];
+}
+
+/**
+ * @brief Moving average: keep a running sum of the window.
+ */
+static int32_t sensor_filter_average(struct sensor_filter *filter, int32_t in)
+{
+	size_t n = filter->config.param;
+
+	if (filter->count == n) {
+		filter->acc -= filter->window[filter->pos];
+	} else {
+		filter->count++;
+	}
+
+	filter->window[filter->pos] = in;
+	filter->pos = (filter->pos + 1) % n;
+	filter->acc += in;
+
+	return (int32_t)(filter->acc / filter->count);
+}
+
+/**
+ * @brief EWMA with the value kept in Q8 to avoid losing small steps.
+ */
+static int32_t sensor_filter_ewma(struct sensor_filter *filter, int32_t in)
+{
+	int64_t x = (int64_t)in * 256;
+
+	if (!filter->primed) {
+		filter->acc = x;
+		filter->primed = true;
+	} else {
+		filter->acc += (x - filter->acc) * filter->config.param / 256;
+	}
+
+	return (int32_t)((filter->acc + (filter->acc >= 0 ? 128 : -128)) / 256);
+}
+
+int sensor_filter_process(struct sensor_filter *filter, int32_t in, int32_t *out)
+{
+	switch (filter->config.type) {
+	case SENSOR_FILTER_MEDIAN:
+		*out = sensor_filter_median(filter, in);
+		return 0;
+	case SENSOR_FILTER_AVERAGE:
+		*out = sensor_filter_average(filter, in);
+		return 0;
+	case SENSOR_FILTER_EWMA:
+		*out = sensor_filter_ewma(filter, in);
+		return 0;
+	case SENSOR_FILTER_DECIMATE:
+		if (filter->counter++ % filter->config.param != 0) {
+			return -EAGAIN;
+		}
+		filter->counter %= filter->config.param;
+		*out = in;
+		return 0;
+	case SENSOR_FILTER_DEADBAND:
+		if (filter->primed && abs(in - filter->last) <= filter->config.param) {
+			return -EAGAIN;
+		}
+		filter->primed = true;
+		filter->last = in;
+		*out = in;
+		return 0;
+	default:
+		*out = in;
+		return 0;
+	}
+}
+
+int sensor_filter_chain_set(struct sensor_filter_chain *chain,
+			    const struct sensor_filter_config *configs, size_t count)
+{
+	struct sensor_filter stage;
+
+	if (count > SENSOR_FILTER_STAGES_MAX) {
+		return -EINVAL;
+	}
+
+	/* Validate everything first so a bad stage leaves the chain as it was */
+	for (size_t i = 0; i < count; i++) {
+		if (sensor_filter_init(&stage, &configs[i]) < 0) {
+			return -EINVAL;
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		(void)sensor_filter_init(&chain->stages[i], &configs[i]);
+	}
+	chain->count = count;
+	return 0;
+}
+
+int sensor_filter_chain_process(struct sensor_filter_chain *chain, int32_t in, int32_t *out)
+{
+	int32_t value = in;
+
+	for (size_t i = 0; i < chain->count; i++) {
+		if (sensor_filter_process(&chain->stages[i], value, &value) < 0) {
+			return -EAGAIN;
+		}
+	}
+
+	*out = value;
+	return 0;
+}
+
+const char *sensor_filter_type_name(enum sensor_filter_type type)
+{
+	if ((unsigned int)type >= SENSOR_FILTER_TYPE_COUNT) {
+		return NULL;
+	}
+	return type_names[type];
+}
+
+int sensor_filter_type_from_name(const char *name)
+{
+	for (int type = SENSOR_FILTER_MEDIAN; type < SENSOR_FILTER_TYPE_COUNT; type++) {
+		if (strcmp(name, type_names[type]) == 0) {
+			return type;
+		}
+	}
+	return -EINVAL;
+}
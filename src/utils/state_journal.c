@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2024 UARTCommandCenter
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file state_journal.c
+ * @brief Write-ahead journal of persistent application state.
+ *
+ * Description:
+ * ------------
+ * This file implements an append-only journal on the `storage_partition`
+ * flash area. The partition is split into two halves; exactly one of them is
+ * active at any time. An active half starts with a header carrying a
+ * generation number, followed by fixed-size records:
+ *
+ *   [header gen=N][rec][rec][rec]...[erased]
+ *
+ * Group commit:
+ * -------------
+ * state_journal_append() only updates the RAM copy and queues a record. The
+ * queued records are written with a single flash write when either the
+ * commit window (STATE_JOURNAL_COMMIT_MS) expires or STATE_JOURNAL_BATCH_MAX
+ * records are pending. Writers that need durability wait on a condition
+ * variable that is broadcast after each commit. Code that must not block
+ * (async commands) takes a ticket with state_journal_ticket() instead and
+ * polls it whenever the commit signal is raised.
+ *
+ * Checkpoints and replay:
+ * -----------------------
+ * When a commit would not fit, or the active half is more than
+ * STATE_JOURNAL_COMPACT_PCT full after a commit, the current value of every
+ * key is written into the other half as a checkpoint. Its header is written
+ * last, so an interrupted compaction leaves the previous half authoritative.
+ * At boot the half with the newest valid header is replayed record by record
+ * until the first erased slot; a torn record ends the replay and triggers a
+ * compaction so the tail is never written over.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "state_journal.h"
+
+LOG_MODULE_REGISTER(state_journal, LOG_LEVEL_INF);
+
+#define JOURNAL_PARTITION storage_partition
+#define JOURNAL_HEADER_MAGIC 0x4C4E524AU /* "JRNL" */
+#define JOURNAL_RECORD_MAGIC 0x4A52U     /* "RJ" */
+
+/* On-flash header at the start of the active half */
+struct journal_header {
+	uint32_t magic;
+	uint32_t generation;
+	uint32_t reserved;
+	uint32_t crc;
+};
+
+/* On-flash record of a single key update */
+struct journal_record {
+	uint16_t magic;
+	uint16_t key;
+	int32_t value;
+	uint32_t seq;
+	uint32_t crc;
+};
+
+BUILD_ASSERT(sizeof(struct journal_header) == 16, "journal header must stay 16 bytes");
+BUILD_ASSERT(sizeof(struct journal_record) == 16, "journal record must stay 16 bytes");
+
+/*
+ * RAM state, protected by journal_lock:
+ *   values/value_seq: current value of every key (value_seq == 0: never set)
+ *   pending: records waiting for the next group commit
+ */
+static K_MUTEX_DEFINE(journal_lock);
+static K_CONDVAR_DEFINE(journal_commit_cv);
+static struct k_poll_signal journal_commit_signal =
+	K_POLL_SIGNAL_INITIALIZER(journal_commit_signal);
+static bool initialized;
+static int32_t values[STATE_KEY_COUNT];
+static uint32_t value_seq[STATE_KEY_COUNT];
+static struct journal_record pending[STATE_JOURNAL_BATCH_MAX];
+static size_t pending_count;
+static uint32_t next_seq = 1;
+static uint32_t committed_seq;
+static int commit_err;
+
+/*
+ * Flash state, protected by journal_io_lock. Taken before journal_lock when
+ * both are needed, so flash writes never block appends.
+ */
+static K_MUTEX_DEFINE(journal_io_lock);
+static const struct flash_area *journal_fa;
+static size_t half_size;
+static uint8_t active_half;
+static uint32_t generation;
+static size_t write_off;
+static struct journal_record io_batch[MAX(STATE_JOURNAL_BATCH_MAX, STATE_KEY_COUNT)];
+
+static void journal_commit_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(journal_commit_work, journal_commit_work_handler);
+
+static uint32_t journal_header_crc(const struct journal_header *hdr)
+{
+	return crc32_ieee((const uint8_t *)hdr, offsetof(struct journal_header, crc));
+}
+
+static uint32_t journal_record_crc(const struct journal_record *rec)
+{
+	return crc32_ieee((const uint8_t *)rec, offsetof(struct journal_record, crc));
+}
+
+static off_t journal_half_offset(uint8_t half)
+{
+	return (off_t)half * half_size;
+}
+
+static void journal_record_fill(struct journal_record *rec, uint16_t key, int32_t value, uint32_t seq)
+{
+	rec->magic = JOURNAL_RECORD_MAGIC;
+	rec->key = key;
+	rec->value = value;
+	rec->seq = seq;
+	rec->crc = journal_record_crc(rec);
+}
+
+/*
+ * Read the header of one half.
+ * Returns the generation, or 0 if the half holds no valid header.
+ */
+static uint32_t journal_read_generation(uint8_t half)
+{
+	struct journal_header hdr;
+
+	if (flash_area_read(journal_fa, journal_half_offset(half), &hdr, sizeof(hdr)) != 0) {
+		return 0;
+	}
+
+	if (hdr.magic != JOURNAL_HEADER_MAGIC || hdr.crc != journal_header_crc(&hdr)) {
+		return 0;
+	}
+
+	return hdr.generation;
+}
+
+/*
+ * Write a checkpoint of every known key into the inactive half and make it
+ * the active one. Caller holds journal_io_lock.
+ */
+static int journal_compact_locked(void)
+{
+	uint8_t target = !active_half;
+	off_t base = journal_half_offset(target);
+	struct journal_header hdr = { .magic = JOURNAL_HEADER_MAGIC, .generation = generation + 1 };
+	size_t count = 0;
+
+	int ret = flash_area_erase(journal_fa, base, half_size);
+	if (ret < 0) {
+		LOG_ERR("Failed to erase journal half %u (err %d)", target, ret);
+		return ret;
+	}
+
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	for (uint16_t key = 0; key < STATE_KEY_COUNT; key++) {
+		if (value_seq[key] != 0) {
+			journal_record_fill(&io_batch[count++], key, values[key], value_seq[key]);
+		}
+	}
+	k_mutex_unlock(&journal_lock);
+
+	if (count > 0) {
+		ret = flash_area_write(journal_fa, base + sizeof(hdr), io_batch,
+				       count * sizeof(struct journal_record));
+		if (ret < 0) {
+			LOG_ERR("Failed to write journal checkpoint (err %d)", ret);
+			return ret;
+		}
+	}
+
+	/* The header goes last: until it is on flash the old half stays valid */
+	hdr.crc = journal_header_crc(&hdr);
+	ret = flash_area_write(journal_fa, base, &hdr, sizeof(hdr));
+	if (ret < 0) {
+		LOG_ERR("Failed to write journal header (err %d)", ret);
+		return ret;
+	}
+
+	ret = flash_area_erase(journal_fa, journal_half_offset(active_half), half_size);
+	if (ret < 0) {
+		LOG_WRN("Failed to erase old journal half %u (err %d)", active_half, ret);
+	}
+
+	active_half = target;
+	generation = hdr.generation;
+	write_off = sizeof(hdr) + count * sizeof(struct journal_record);
+	LOG_INF("Journal compacted: generation %u, %u keys", generation, (unsigned int)count);
+
+	return 0;
+}
+
+/*
+ * Replay the records of the active half into the RAM table.
+ * Caller holds journal_io_lock; the journal is not yet marked initialized.
+ */
+static int journal_replay_locked(bool *torn)
+{
+	off_t base = journal_half_offset(active_half);
+	uint8_t erased = flash_area_erased_val(journal_fa);
+	uint16_t erased_magic = (uint16_t)(erased | (erased << 8));
+	struct journal_record rec;
+	size_t off = sizeof(struct journal_header);
+
+	*torn = false;
+
+	while (off + sizeof(rec) <= half_size) {
+		int ret = flash_area_read(journal_fa, base + off, &rec, sizeof(rec));
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (rec.magic == erased_magic) {
+			break;
+		}
+
+		if (rec.magic != JOURNAL_RECORD_MAGIC || rec.crc != journal_record_crc(&rec)) {
+			LOG_WRN("Torn journal record at offset %u", (unsigned int)off);
+			*torn = true;
+			break;
+		}
+
+		/* Keys unknown to this firmware are skipped, not treated as corruption */
+		if (rec.key < STATE_KEY_COUNT) {
+			values[rec.key] = rec.value;
+			value_seq[rec.key] = rec.seq;
+		}
+		next_seq = MAX(next_seq, rec.seq + 1);
+		off += sizeof(rec);
+	}
+
+	write_off = off;
+	return 0;
+}
+
+int state_journal_init(void)
+{
+	bool torn = false;
+	int ret = 0;
+
+	k_work_cancel_delayable(&journal_commit_work);
+
+	k_mutex_lock(&journal_io_lock, K_FOREVER);
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	initialized = false;
+	pending_count = 0;
+	memset(values, 0, sizeof(values));
+	memset(value_seq, 0, sizeof(value_seq));
+	next_seq = 1;
+	commit_err = 0;
+	k_mutex_unlock(&journal_lock);
+
+	if (!journal_fa) {
+		ret = flash_area_open(FIXED_PARTITION_ID(JOURNAL_PARTITION), &journal_fa);
+		if (ret < 0) {
+			LOG_ERR("Failed to open journal flash area (err %d)", ret);
+			journal_fa = NULL;
+			goto out;
+		}
+	}
+	half_size = journal_fa->fa_size / 2;
+
+	uint32_t gen0 = journal_read_generation(0);
+	uint32_t gen1 = journal_read_generation(1);
+
+	if (gen0 == 0 && gen1 == 0) {
+		/* Blank or foreign partition: start an empty journal in half 0 */
+		LOG_INF("No journal found, formatting");
+		active_half = 1;
+		generation = 0;
+		ret = journal_compact_locked();
+		goto out;
+	}
+
+	active_half = (gen1 > gen0) ? 1 : 0;
+	generation = MAX(gen0, gen1);
+	ret = journal_replay_locked(&torn);
+	if (ret == 0 && torn) {
+		ret = journal_compact_locked();
+	}
+
+	LOG_INF("Journal replayed: generation %u, next seq %u", generation, next_seq);
+
+out:
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	committed_seq = next_seq - 1;
+	initialized = (ret == 0);
+	k_mutex_unlock(&journal_lock);
+	k_mutex_unlock(&journal_io_lock);
+
+	return ret;
+}
+
+int state_journal_get(uint16_t key, int32_t *value)
+{
+	int ret = 0;
+
+	if (!value || key >= STATE_KEY_COUNT) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	if (!initialized) {
+		ret = -ENODEV;
+	} else if (value_seq[key] == 0) {
+		ret = -ENOENT;
+	} else {
+		*value = values[key];
+	}
+	k_mutex_unlock(&journal_lock);
+
+	return ret;
+}
+
+int state_journal_append(uint16_t key, int32_t value)
+{
+	const struct state_journal_update update = { .key = key, .value = value };
+
+	return state_journal_append_batch(&update, 1);
+}
+
+int state_journal_append_batch(const struct state_journal_update *updates, size_t count)
+{
+	if (count == 0 || count > STATE_JOURNAL_BATCH_MAX) {
+		return -EINVAL;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (updates[i].key >= STATE_KEY_COUNT) {
+			return -EINVAL;
+		}
+	}
+
+	k_mutex_lock(&journal_lock, K_FOREVER);
+
+	/* Batch too full and the commit work has not caught up yet: commit inline */
+	while (initialized && pending_count + count > STATE_JOURNAL_BATCH_MAX) {
+		k_mutex_unlock(&journal_lock);
+		state_journal_commit();
+		k_mutex_lock(&journal_lock, K_FOREVER);
+	}
+
+	if (!initialized) {
+		k_mutex_unlock(&journal_lock);
+		return -ENODEV;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		uint16_t key = updates[i].key;
+		uint32_t seq = next_seq++;
+
+		journal_record_fill(&pending[pending_count++], key, updates[i].value, seq);
+		values[key] = updates[i].value;
+		value_seq[key] = seq;
+	}
+
+	if (pending_count >= STATE_JOURNAL_BATCH_MAX) {
+		k_work_reschedule(&journal_commit_work, K_NO_WAIT);
+	} else {
+		/* Does not move an already running window: the first record sets the deadline */
+		k_work_schedule(&journal_commit_work, K_MSEC(STATE_JOURNAL_COMMIT_MS));
+	}
+
+	k_mutex_unlock(&journal_lock);
+	return 0;
+}
+
+int state_journal_commit(void)
+{
+	int ret = 0;
+
+	k_mutex_lock(&journal_io_lock, K_FOREVER);
+	k_mutex_lock(&journal_lock, K_FOREVER);
+
+	if (!initialized) {
+		k_mutex_unlock(&journal_lock);
+		k_mutex_unlock(&journal_io_lock);
+		return -ENODEV;
+	}
+
+	size_t count = pending_count;
+	size_t len = count * sizeof(struct journal_record);
+	uint32_t last_seq = next_seq - 1;
+
+	memcpy(io_batch, pending, len);
+	pending_count = 0;
+	k_mutex_unlock(&journal_lock);
+
+	if (write_off + len > half_size) {
+		/* The checkpoint already contains the values of this batch */
+		ret = journal_compact_locked();
+	} else if (count > 0) {
+		ret = flash_area_write(journal_fa, journal_half_offset(active_half) + write_off,
+				       io_batch, len);
+		if (ret == 0) {
+			write_off += len;
+		} else {
+			LOG_ERR("Journal commit of %u records failed (err %d)", (unsigned int)count, ret);
+		}
+	}
+
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	commit_err = ret;
+	if (ret == 0 && last_seq > committed_seq) {
+		committed_seq = last_seq;
+	}
+	k_condvar_broadcast(&journal_commit_cv);
+	k_poll_signal_raise(&journal_commit_signal, ret);
+	k_mutex_unlock(&journal_lock);
+
+	k_mutex_unlock(&journal_io_lock);
+	return ret;
+}
+
+int state_journal_compact(void)
+{
+	k_mutex_lock(&journal_io_lock, K_FOREVER);
+	int ret = initialized ? journal_compact_locked() : -ENODEV;
+	k_mutex_unlock(&journal_io_lock);
+
+	return ret;
+}
+
+int state_journal_wait_committed(k_timeout_t timeout)
+{
+	int ret = 0;
+
+	k_mutex_lock(&journal_lock, K_FOREVER);
+
+	if (!initialized) {
+		k_mutex_unlock(&journal_lock);
+		return -ENODEV;
+	}
+
+	uint32_t target = next_seq - 1;
+
+	while (committed_seq < target && commit_err == 0) {
+		if (k_condvar_wait(&journal_commit_cv, &journal_lock, timeout) != 0) {
+			ret = -EAGAIN;
+			break;
+		}
+	}
+
+	if (ret == 0 && committed_seq < target) {
+		ret = commit_err;
+	}
+
+	k_mutex_unlock(&journal_lock);
+	return ret;
+}
+
+uint32_t state_journal_ticket(void)
+{
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	uint32_t ticket = next_seq - 1;
+	k_mutex_unlock(&journal_lock);
+
+	return ticket;
+}
+
+int state_journal_ticket_committed(uint32_t ticket)
+{
+	int ret = 0;
+
+	k_mutex_lock(&journal_lock, K_FOREVER);
+	if (!initialized) {
+		ret = -ENODEV;
+	} else if (committed_seq < ticket) {
+		ret = commit_err ? commit_err : -EAGAIN;
+	}
+	k_mutex_unlock(&journal_lock);
+
+	return ret;
+}
+
+struct k_poll_signal *state_journal_commit_signal(void)
+{
+	return &journal_commit_signal;
+}
+
+/*
+ * Commit window expired (or the batch filled up). Compaction is done here as
+ * well, so it never runs on a command's path.
+ */
+static void journal_commit_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	if (state_journal_commit() != 0) {
+		return;
+	}
+
+	k_mutex_lock(&journal_io_lock, K_FOREVER);
+	if (write_off * 100 > half_size * STATE_JOURNAL_COMPACT_PCT) {
+		journal_compact_locked();
+	}
+	k_mutex_unlock(&journal_io_lock);
+}
@@ -24,8 +24,19 @@
 
 #include <zephyr/ztest.h>
 #include <zephyr/kernel.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+
+#include <stdio.h>
+#include <string.h>
 
 #include "commands.h"
+#include "command_async.h"
+#include "command_stream.h"
+#include "config_store.h"
+#include "lights_control.h"
+#include "sensor_readings.h"
+#include "state_journal.h"
+#include "uart_handler.h"
 
 /* 
  * Optionally, consider adding extern variables or mock functions here if
@@ -41,6 +52,9 @@
 /* Test setup fixture: runs once before each test suite */
 static void *test_commands_setup(void)
 {
+    /* Sensor commands read the values of the sampler started here */
+    sensor_readings_init();
+
     /* If you have global counters or states, reset them here:
      * lights_command_count = 0; 
      * sensors_command_count = 0;
@@ -131,6 +145,433 @@ ZTEST(commands, test_unknown_category)
                  "Should handle unknown category gracefully without a crash");
 }
 
+/*
+ * Text commands, one test per command family:
+ * Known commands run, unknown first words are reported as -ENOENT, and
+ * malformed arguments as -EINVAL.
+ */
+
+/* Check every lights channel against the expected ON mask and levels */
+static void test_expect_channels(uint32_t on_mask, const int levels[LIGHTS_CHANNEL_COUNT])
+{
+    struct lights_channel_state state;
+
+    for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+        zassert_ok(lights_control_get_channel(i, &state), "Read of channel %u failed", i);
+        zassert_equal(state.on, (on_mask & BIT(i)) != 0, "Channel %u has the wrong ON state", i);
+        zassert_equal(state.level, levels[i], "Channel %u has the wrong level", i);
+    }
+}
+
+ZTEST(commands, test_text_lights)
+{
+    struct lights_channel_state state;
+    char line[64];
+
+    strcpy(line, "lights get 0");
+    zassert_equal(commands_core_execute_line(line), 0, "lights get should succeed");
+
+    strcpy(line, "lights set 2 on 30");
+    zassert_equal(commands_core_execute_line(line), 0, "lights set should succeed");
+    zassert_ok(lights_control_get_channel(2, &state), "Read failed");
+    zassert_true(state.on && state.level == 30, "lights set did not change channel 2");
+
+    strcpy(line, "lights cas 2 0 on 30");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "cas with version 0 should be rejected");
+
+    strcpy(line, "lights usage 2");
+    zassert_equal(commands_core_execute_line(line), 0, "lights usage should succeed");
+
+    strcpy(line, "lights usage");
+    zassert_equal(commands_core_execute_line(line), 0, "lights usage for all channels should succeed");
+
+    strcpy(line, "lights usage 99");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Invalid channel should be rejected");
+}
+
+/* Selector writes change exactly the selected channels */
+ZTEST(commands, test_text_lights_selectors)
+{
+    int levels[LIGHTS_CHANNEL_COUNT];
+    char line[64];
+
+    lights_control_set_channels(GENMASK(LIGHTS_CHANNEL_COUNT - 1, 0), false, 10);
+    for (unsigned int i = 0; i < LIGHTS_CHANNEL_COUNT; i++) {
+        levels[i] = 10;
+    }
+
+    strcpy(line, "lights set 0,2,4-5 on 40");
+    zassert_equal(commands_core_execute_line(line), 0, "lights set with a selector should succeed");
+    levels[0] = levels[2] = levels[4] = levels[5] = 40;
+    test_expect_channels(BIT(0) | BIT(2) | BIT(4) | BIT(5), levels);
+
+    strcpy(line, "lights group 1 4-7");
+    zassert_equal(commands_core_execute_line(line), 0, "lights group should succeed");
+
+    /* on/off keep each channel's level */
+    strcpy(line, "lights off g1");
+    zassert_equal(commands_core_execute_line(line), 0, "lights off for a group should succeed");
+    test_expect_channels(BIT(0) | BIT(2), levels);
+
+    strcpy(line, "lights on *");
+    zassert_equal(commands_core_execute_line(line), 0, "lights on for all channels should succeed");
+    test_expect_channels(GENMASK(LIGHTS_CHANNEL_COUNT - 1, 0), levels);
+
+    strcpy(line, "lights off 3-1");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Reversed range should be rejected");
+    test_expect_channels(GENMASK(LIGHTS_CHANNEL_COUNT - 1, 0), levels);
+
+    strcpy(line, "lights group 99 0");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Invalid group should be rejected");
+
+    lights_control_set_group(1, 0);
+}
+
+ZTEST(commands, test_text_config)
+{
+    char line[64];
+
+    strcpy(line, "config get brightness_step");
+    zassert_equal(commands_core_execute_line(line), 0, "config get should succeed");
+
+    strcpy(line, "config get no_such_key");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Unknown config key should be rejected");
+}
+
+ZTEST(commands, test_text_sync_events)
+{
+    char line[64];
+
+    strcpy(line, "sync 0");
+    zassert_equal(commands_core_execute_line(line), 0, "sync snapshot should succeed");
+
+    strcpy(line, "sync");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "sync without argument should be rejected");
+
+    strcpy(line, "events 0");
+    zassert_equal(commands_core_execute_line(line), 0, "events replay should succeed");
+
+    strcpy(line, "events x");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Non-numeric events argument should be rejected");
+}
+
+ZTEST(commands, test_text_regulator)
+{
+    char line[64];
+
+    strcpy(line, "regulator status");
+    zassert_equal(commands_core_execute_line(line), 0, "regulator status should succeed");
+
+    strcpy(line, "regulator on bright");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Non-numeric setpoint should be rejected");
+}
+
+ZTEST(commands, test_text_sensor)
+{
+    char line[64];
+
+    strcpy(line, "sensor filter ambient_light median 3 ewma 64");
+    zassert_equal(commands_core_execute_line(line), 0, "sensor filter should succeed");
+
+    strcpy(line, "sensor filter ambient_light median 99");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Oversized median should be rejected");
+
+    strcpy(line, "sensor read ambient_light");
+    zassert_equal(commands_core_execute_line(line), 0, "sensor read should succeed");
+
+    strcpy(line, "sensor filter ambient_light none");
+    zassert_equal(commands_core_execute_line(line), 0, "Clearing the filters should succeed");
+}
+
+ZTEST(commands, test_text_time_scene)
+{
+    char line[64];
+
+    strcpy(line, "time sync 123456789");
+    zassert_equal(commands_core_execute_line(line), 0, "time sync should succeed");
+
+    strcpy(line, "time offset -1000000");
+    zassert_equal(commands_core_execute_line(line), 0, "time offset should succeed");
+
+    strcpy(line, "time offset soon");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Non-numeric offset should be rejected");
+
+    strcpy(line, "scene clear");
+    zassert_equal(commands_core_execute_line(line), 0, "scene clear should succeed");
+
+    strcpy(line, "scene commit 0");
+    zassert_equal(commands_core_execute_line(line), -ENODATA, "Empty scene commit should be refused");
+
+    strcpy(line, "scene stage 7 on 101");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Out-of-range level should be rejected");
+
+    strcpy(line, "time offset 0");
+    zassert_equal(commands_core_execute_line(line), 0, "Resetting the offset should succeed");
+}
+
+ZTEST(commands, test_text_unknown)
+{
+    char line[64];
+
+    strcpy(line, "unknown command");
+    zassert_equal(commands_core_execute_line(line), -ENOENT, "Unknown command should return -ENOENT");
+}
+
+/*
+ * Async commands:
+ * Completion callback recording the status and counting completions.
+ */
+static atomic_t test_async_done_count;
+static int test_async_status;
+
+static void test_async_done(struct command_async *cmd, int status)
+{
+    test_async_status = status;
+    atomic_inc(&test_async_done_count);
+}
+
+ZTEST(commands, test_async_sample_command)
+{
+    char line[64];
+
+    strcpy(line, "sensor sample ambient_light 3 10");
+    zassert_equal(commands_core_execute_line(line), 0, "sensor sample should complete");
+
+    strcpy(line, "sensor sample ambient_light 0 10");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Empty series should be rejected");
+
+    strcpy(line, "sensor sample ambient_light 3");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Missing interval should be rejected");
+    zassert_equal(command_async_in_flight(), 0, "No async command should be left over");
+}
+
+/* Many slow commands wait concurrently instead of one after another */
+ZTEST(commands, test_async_commands_overlap)
+{
+    char line[64];
+    const int commands = 4;
+
+    atomic_set(&test_async_done_count, 0);
+    int64_t start = k_uptime_get();
+
+    for (int i = 0; i < commands; i++) {
+        strcpy(line, "sensor sample temperature 5 50");
+        zassert_equal(commands_core_execute_line_async(line, test_async_done, NULL),
+                      COMMAND_ASYNC_PENDING, "sensor sample should go async");
+    }
+    zassert_equal(command_async_in_flight(), commands, "All commands should be in flight");
+
+    while (atomic_get(&test_async_done_count) < commands && k_uptime_get() - start < 2000) {
+        k_sleep(K_MSEC(10));
+    }
+
+    zassert_equal(atomic_get(&test_async_done_count), commands, "All commands should complete");
+    zassert_equal(test_async_status, 0, "Sampling should succeed");
+    /* 4 x 4 waits of 50 ms would take 800 ms one after another */
+    zassert_true(k_uptime_get() - start < 500, "Commands should wait concurrently");
+    zassert_equal(command_async_in_flight(), 0, "Commands should be released");
+}
+
+/* A lights write is acknowledged by an async command once it is committed */
+ZTEST(commands, test_async_lights_ack)
+{
+    char line[64];
+
+    zassert_ok(state_journal_init(), "Journal initialization failed");
+    atomic_set(&test_async_done_count, 0);
+
+    strcpy(line, "lights set 3 on 60");
+    zassert_equal(commands_core_execute_line_async(line, test_async_done, NULL),
+                  COMMAND_ASYNC_PENDING, "lights set should wait for the commit asynchronously");
+    zassert_equal(atomic_get(&test_async_done_count), 0, "Ack must wait for the commit window");
+    zassert_equal(state_journal_ticket_committed(state_journal_ticket()), -EAGAIN,
+                  "Change should not be committed yet");
+
+    k_sleep(K_MSEC(STATE_JOURNAL_COMMIT_MS * 3));
+    zassert_equal(atomic_get(&test_async_done_count), 1, "Ack should follow the commit");
+    zassert_equal(test_async_status, 0, "Write should succeed");
+    zassert_ok(state_journal_ticket_committed(state_journal_ticket()), "Change should be durable");
+    zassert_equal(command_async_in_flight(), 0, "Command should be released");
+}
+
+/* Durable acks of a burst wait for the one commit that ends its window */
+#define TEST_BURST_WINDOW_MS 200
+#define TEST_BURST_WRITES 3
+
+static uint32_t test_burst_commits[TEST_BURST_WRITES];
+
+static void test_burst_done(struct command_async *cmd, int status)
+{
+    struct lights_control_stats stats;
+    atomic_val_t n = atomic_inc(&test_async_done_count);
+
+    lights_control_get_stats(&stats);
+    if (n < TEST_BURST_WRITES) {
+        test_burst_commits[n] = stats.commits;
+    }
+    test_async_status = status;
+}
+
+ZTEST(commands, test_async_lights_ack_coalesced)
+{
+    struct lights_control_stats before;
+    struct lights_control_stats stats;
+    char line[64];
+
+    zassert_ok(state_journal_init(), "Journal initialization failed");
+    /* Every write of the burst must be a change */
+    lights_control_set_channel(4, false, 0, LIGHTS_VERSION_ANY, NULL);
+    zassert_ok(config_store_set(CONFIG_KEY_COALESCE_MS, TEST_BURST_WINDOW_MS,
+                                CONFIG_STORE_VERSION_ANY, NULL, NULL),
+               "Setting the coalescing window failed");
+    atomic_set(&test_async_done_count, 0);
+    lights_control_get_stats(&before);
+
+    for (int i = 0; i < TEST_BURST_WRITES; i++) {
+        snprintf(line, sizeof(line), "lights set 4 on %d", 70 + i);
+        zassert_equal(commands_core_execute_line_async(line, test_burst_done, NULL),
+                      COMMAND_ASYNC_PENDING, "lights set should wait for the commit asynchronously");
+    }
+    lights_control_get_stats(&stats);
+    zassert_equal(stats.pending, 1, "The burst should stay staged in its window");
+    zassert_equal(stats.coalesced - before.coalesced, TEST_BURST_WRITES - 1,
+                  "Superseded writes should be counted as coalesced");
+
+    k_sleep(K_MSEC(TEST_BURST_WINDOW_MS / 2));
+    zassert_equal(atomic_get(&test_async_done_count), 0, "Acks must wait for the window");
+
+    k_sleep(K_MSEC(TEST_BURST_WINDOW_MS / 2 + STATE_JOURNAL_COMMIT_MS * 3));
+    zassert_equal(atomic_get(&test_async_done_count), TEST_BURST_WRITES,
+                  "Every write should get its own reply");
+    zassert_equal(test_async_status, 0, "Writes should succeed");
+    lights_control_get_stats(&stats);
+    zassert_equal(stats.commits - before.commits, 1, "The burst should be one commit");
+    for (int i = 0; i < TEST_BURST_WRITES; i++) {
+        zassert_equal(test_burst_commits[i], before.commits + 1,
+                      "Reply %d should follow the burst's commit", i);
+    }
+    zassert_ok(state_journal_ticket_committed(state_journal_ticket()), "Change should be durable");
+    zassert_equal(command_async_in_flight(), 0, "Commands should be released");
+
+    config_store_set(CONFIG_KEY_COALESCE_MS, 0, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* An abort cancels a waiting async command without waiting for its wake-up */
+ZTEST(commands, test_async_abort)
+{
+    const struct device *uart = DEVICE_DT_GET(DT_CHOSEN(zephyr_shell_uart));
+    static const uint8_t ctrl_c = 0x03;
+    char line[64];
+
+    zassert_ok(uart_handler_init(), "UART initialization failed");
+    atomic_set(&test_async_done_count, 0);
+
+    strcpy(line, "sensor sample temperature 5 500");
+    zassert_equal(commands_core_execute_line_async(line, test_async_done, NULL),
+                  COMMAND_ASYNC_PENDING, "sensor sample should go async");
+    k_sleep(K_MSEC(20));
+    zassert_equal(atomic_get(&test_async_done_count), 0, "Command should be waiting");
+
+    uart_emul_put_rx_data(uart, &ctrl_c, 1);
+    k_sleep(K_MSEC(20));
+    zassert_equal(atomic_get(&test_async_done_count), 1, "Abort should end the command");
+    zassert_equal(test_async_status, -ECANCELED, "Command should report the abort");
+    zassert_equal(command_async_in_flight(), 0, "Command should be released");
+
+    strcpy(line, "sync 0");
+    zassert_equal(commands_core_execute_line(line), -ECANCELED,
+                  "No command should run while the abort is pending");
+
+    uart_handler_abort_clear();
+    k_msgq_purge(&uart_msgq);
+}
+
+/* Step waiting for a signal: state 0 waits, state 1 reports the wake result */
+static struct k_poll_signal test_async_signal;
+static int test_async_wake_result;
+
+static int test_async_signal_step(struct command_async *cmd)
+{
+    if (cmd->state == 0) {
+        cmd->state = 1;
+        return command_async_wait_signal(cmd, &test_async_signal, 100);
+    }
+
+    test_async_wake_result = cmd->wake_result;
+    return 0;
+}
+
+ZTEST(commands, test_async_wait_signal)
+{
+    struct command_async *cmd;
+
+    k_poll_signal_init(&test_async_signal);
+    atomic_set(&test_async_done_count, 0);
+
+    /* Raised signal wakes the command */
+    cmd = command_async_alloc();
+    zassert_not_null(cmd, "A command should be free");
+    cmd->step = test_async_signal_step;
+    command_async_submit(cmd, test_async_done, NULL);
+    k_sleep(K_MSEC(10));
+    zassert_equal(atomic_get(&test_async_done_count), 0, "Command should be waiting");
+    k_poll_signal_raise(&test_async_signal, 0);
+    k_sleep(K_MSEC(10));
+    zassert_equal(atomic_get(&test_async_done_count), 1, "Signal should resume the command");
+    zassert_equal(test_async_wake_result, 0, "Wake should report the signal");
+
+    /* Without the signal, the timeout resumes it */
+    cmd = command_async_alloc();
+    cmd->step = test_async_signal_step;
+    command_async_submit(cmd, test_async_done, NULL);
+    k_sleep(K_MSEC(150));
+    zassert_equal(atomic_get(&test_async_done_count), 2, "Timeout should resume the command");
+    zassert_equal(test_async_wake_result, -EAGAIN, "Wake should report the timeout");
+}
+
+/* 
+ * Streaming output:
+ * A producer yielding a fixed number of chunks, counting how often it is
+ * pulled. Position 0xFFFF makes it fail instead.
+ */
+#define TEST_STREAM_CHUNKS 50
+
+static int test_stream_calls;
+
+static int test_stream_next(struct command_stream *stream, char *buf, size_t len)
+{
+    test_stream_calls++;
+
+    if (stream->position == 0xFFFF) {
+        return -EIO;
+    }
+
+    if (stream->position == TEST_STREAM_CHUNKS) {
+        return 0;
+    }
+
+    return snprintf(buf, len, "Chunk %u\r\n", (unsigned int)stream->position++);
+}
+
+ZTEST(commands, test_stream_runs_to_completion)
+{
+    struct command_stream stream = { .next = test_stream_next };
+
+    test_stream_calls = 0;
+    zassert_equal(command_stream_run(&stream), 0, "Stream should complete");
+    zassert_equal(stream.position, TEST_STREAM_CHUNKS, "All chunks should be produced");
+    zassert_equal(test_stream_calls, TEST_STREAM_CHUNKS + 1,
+                  "Producer should be pulled once per chunk plus the final call");
+}
+
+ZTEST(commands, test_stream_producer_error)
+{
+    struct command_stream stream = { .next = test_stream_next, .position = 0xFFFF };
+
+    zassert_equal(command_stream_run(&stream), -EIO, "Producer error should be returned");
+    zassert_equal(command_stream_run(NULL), -EINVAL, "NULL stream should be rejected");
+}
+
 /* 
  * Test Suite Definition:
  * Groups all command-related tests into a single suite.
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2024
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file test_gateway.c
+ * @brief Test suite for addressed commands and gateway forwarding.
+ *
+ * Description:
+ * ------------
+ * This file uses ZTest to verify `command_gateway.c` on native_sim with two
+ * emulated UARTs (see boards/native_sim.overlay): euart0 is the host link
+ * the replies go to, euart1 the downstream link. The tests play the
+ * downstream unit by reading what the gateway forwards from euart1 and
+ * injecting replies into it. GATEWAY_TIMEOUT_MS is set to 100 ms by the
+ * test build.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "command_gateway.h"
+#include "commands.h"
+#include "config_store.h"
+#include "uart_handler.h"
+
+static const struct device *host_uart = DEVICE_DT_GET(DT_NODELABEL(euart0));
+static const struct device *downstream_uart = DEVICE_DT_GET(DT_NODELABEL(euart1));
+
+/* Collect what was sent on an emulated UART since the last call */
+static void uart_collect(const struct device *dev, char *buf, size_t len)
+{
+    k_sleep(K_MSEC(20));
+    uint32_t n = uart_emul_get_tx_data(dev, (uint8_t *)buf, len - 1);
+    buf[n] = '\0';
+}
+
+static void downstream_reply(const char *reply)
+{
+    uart_emul_put_rx_data(downstream_uart, (const uint8_t *)reply, strlen(reply));
+}
+
+/* Send an addressed request and return the ID the gateway used downstream */
+static unsigned int gateway_request(const char *request, int dest)
+{
+    char line[64];
+    char sent[128];
+    unsigned int addr = 0;
+    unsigned int gid = 0;
+
+    strcpy(line, request);
+    zassert_ok(commands_core_execute_line(line), "Request not accepted: %s", request);
+    uart_collect(downstream_uart, sent, sizeof(sent));
+    zassert_equal(sscanf(sent, "@%u %u ", &addr, &gid), 2, "Not forwarded: '%s'", sent);
+    zassert_equal(addr, dest, "Forwarded to the wrong address");
+    return gid;
+}
+
+static void *test_gateway_setup(void)
+{
+    uart_handler_init();
+    command_gateway_init();
+    return NULL;
+}
+
+static void test_gateway_before(void *fixture)
+{
+    config_store_set(CONFIG_KEY_UNIT_ADDRESS, 1, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    config_store_set(CONFIG_KEY_GATEWAY, 1, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    uart_emul_flush_tx_data(host_uart);
+    uart_emul_flush_tx_data(downstream_uart);
+}
+
+static void test_gateway_after(void *fixture)
+{
+    /* Let unanswered requests time out so the next test starts empty */
+    k_sleep(K_MSEC(150));
+    config_store_set(CONFIG_KEY_GATEWAY, 0, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* A request for this unit runs locally with every reply line tagged */
+ZTEST(gateway, test_local_request)
+{
+    char line[64] = "@1 44 config get brightness_step";
+    char out[256];
+
+    zassert_ok(commands_core_execute_line(line), "Local request failed");
+    uart_collect(host_uart, out, sizeof(out));
+    zassert_not_null(strstr(out, "#44 CONFIG brightness_step="), "Untagged reply: '%s'", out);
+    zassert_not_null(strstr(out, "#44 END 0\r\n"), "Missing END line: '%s'", out);
+}
+
+/* Replies from downstream are mapped back to the host's request ID */
+ZTEST(gateway, test_forward_and_remap)
+{
+    struct command_gateway_stats stats;
+    char reply[64];
+    char out[256];
+
+    unsigned int gid = gateway_request("@7 42 lights get 0", 7);
+
+    zassert_not_equal(gid, 42, "Request ID should be remapped");
+
+    snprintf(reply, sizeof(reply), "menu noise\r\n#%u OK LIGHTS ch=0\r\n#%u END 0\r\n", gid, gid);
+    downstream_reply(reply);
+    uart_collect(host_uart, out, sizeof(out));
+    zassert_not_null(strstr(out, "#42 OK LIGHTS ch=0\r\n#42 END 0\r\n"), "Bad reply: '%s'", out);
+    zassert_is_null(strstr(out, "menu noise"), "Untagged downstream output must be dropped");
+
+    command_gateway_get_stats(&stats);
+    zassert_equal(stats.inflight, 0, "Request should be complete");
+}
+
+/* Requests beyond the destination window wait in its queue */
+ZTEST(gateway, test_destination_queue)
+{
+    struct command_gateway_stats stats;
+    char line[64];
+    char sent[256];
+    char reply[32];
+
+    unsigned int first = gateway_request("@8 1 lights get 0", 8);
+    gateway_request("@8 2 lights get 1", 8);
+
+    strcpy(line, "@8 3 lights get 2");
+    zassert_ok(commands_core_execute_line(line), "Request not accepted");
+    uart_collect(downstream_uart, sent, sizeof(sent));
+    zassert_equal(strlen(sent), 0, "Window of 2 exceeded: '%s'", sent);
+
+    command_gateway_get_stats(&stats);
+    zassert_equal(stats.inflight, 2, "Two requests should be outstanding");
+    zassert_equal(stats.queued, 1, "One request should be queued");
+
+    snprintf(reply, sizeof(reply), "#%u END 0\r\n", first);
+    downstream_reply(reply);
+    uart_collect(downstream_uart, sent, sizeof(sent));
+    zassert_not_null(strstr(sent, "lights get 2"), "Queued request not forwarded: '%s'", sent);
+}
+
+/* Unanswered requests time out; late replies are dropped */
+ZTEST(gateway, test_timeout)
+{
+    struct command_gateway_stats before;
+    struct command_gateway_stats after;
+    char expected[32];
+    char reply[32];
+    char out[256];
+
+    command_gateway_get_stats(&before);
+    unsigned int gid = gateway_request("@9 50 lights get 0", 9);
+
+    k_sleep(K_MSEC(150));
+    uart_collect(host_uart, out, sizeof(out));
+    snprintf(expected, sizeof(expected), "#50 END %d\r\n", -ETIMEDOUT);
+    zassert_not_null(strstr(out, expected), "No timeout reply: '%s'", out);
+
+    snprintf(reply, sizeof(reply), "#%u END 0\r\n", gid);
+    downstream_reply(reply);
+    uart_collect(host_uart, out, sizeof(out));
+    zassert_is_null(strstr(out, "#50"), "Late reply must be dropped");
+
+    command_gateway_get_stats(&after);
+    zassert_equal(after.timeouts, before.timeouts + 1, "Timeout not counted");
+    zassert_equal(after.dropped, before.dropped + 1, "Late reply not counted as dropped");
+}
+
+/* Broadcasts run here and are passed on downstream without a reply */
+ZTEST(gateway, test_broadcast)
+{
+    char line[64] = "@255 70 time";
+    char sent[128];
+    char out[256];
+
+    zassert_ok(commands_core_execute_line(line), "Broadcast should be accepted");
+    uart_collect(downstream_uart, sent, sizeof(sent));
+    zassert_equal(strcmp(sent, "@255 0 time\r\n"), 0, "Broadcast not passed on: '%s'", sent);
+
+    uart_collect(host_uart, out, sizeof(out));
+    zassert_not_null(strstr(out, "#70 OK TIME now="), "Broadcast not run locally: '%s'", out);
+    zassert_not_null(strstr(out, "#70 END 0\r\n"), "Missing END line: '%s'", out);
+
+    /* Downstream replies to broadcasts are not forwarded */
+    downstream_reply("#0 OK TIME now=1\r\n#0 END 0\r\n");
+    uart_collect(host_uart, out, sizeof(out));
+    zassert_is_null(strstr(out, "#0"), "Broadcast reply must be discarded");
+}
+
+/* Without gateway mode, requests for other units are refused */
+ZTEST(gateway, test_gateway_disabled)
+{
+    char line[64] = "@7 60 lights get 0";
+    char expected[32];
+    char out[256];
+
+    config_store_set(CONFIG_KEY_GATEWAY, 0, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    zassert_ok(commands_core_execute_line(line), "Request should be framed");
+    uart_collect(host_uart, out, sizeof(out));
+    snprintf(expected, sizeof(expected), "#60 END %d\r\n", -ENODEV);
+    zassert_not_null(strstr(out, expected), "Missing refusal: '%s'", out);
+
+    strcpy(line, "@x 61 lights get 0");
+    zassert_equal(commands_core_execute_line(line), -EINVAL, "Malformed address accepted");
+}
+
+ZTEST_SUITE(gateway, NULL, test_gateway_setup, test_gateway_before, test_gateway_after, NULL);
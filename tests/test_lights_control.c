@@ -25,16 +25,22 @@
 #include <zephyr/ztest.h>
 #include <zephyr/kernel.h>
 
+#include "config_store.h"
+#include "device_time.h"
 #include "lights_control.h"
+#include "lights_scene.h"
+#include "state_journal.h"
 
 /* Optional: If you track lights state in a global variable, reset it in setup. */
 
 /* Setup fixture: runs once before the test suite */
 static void *test_lights_control_setup(void)
 {
-    /* If lights_control has any init function, call it here:
-     * lights_control_init();
-     */
+    /* Scenes are applied on their own workqueue */
+    lights_scene_init();
+
+    /* Registers the rated_w observer used by the usage accounting */
+    lights_control_init();
     return NULL;
 }
 
@@ -126,5 +132,260 @@ ZTEST(lights_control, test_repeated_on_off_cycles)
     }
 }
 
+/* Test conditional writes: a stale version is rejected and reports the current state */
+ZTEST(lights_control, test_channel_compare_and_set)
+{
+    struct lights_channel_state before;
+    struct lights_channel_state after;
+    int ret;
+
+    ret = lights_control_get_channel(1, &before);
+    zassert_equal(ret, 0, "Failed to read channel 1");
+
+    /* Matching version: applied, version advances */
+    ret = lights_control_set_channel(1, !before.on, 40, before.version, &after);
+    zassert_equal(ret, 0, "Write with current version should apply");
+    zassert_equal(after.on, !before.on, "ON state not applied");
+    zassert_equal(after.level, 40, "Level not applied");
+    zassert_equal(after.version, before.version + 1, "Version should advance by one");
+
+    /* Stale version: rejected, current state returned, nothing changed */
+    ret = lights_control_set_channel(1, before.on, 70, before.version, &after);
+    zassert_equal(ret, -EAGAIN, "Write with stale version should be rejected");
+    zassert_equal(after.level, 40, "Rejected write must not change the level");
+    zassert_equal(after.version, before.version + 1, "Rejected write must not bump the version");
+
+    /* Unconditional write always applies */
+    ret = lights_control_set_channel(1, before.on, 70, LIGHTS_VERSION_ANY, &after);
+    zassert_equal(ret, 0, "Unconditional write should apply");
+    zassert_equal(after.level, 70, "Unconditional write not applied");
+}
+
+/* Test channel parameter validation */
+ZTEST(lights_control, test_channel_invalid)
+{
+    struct lights_channel_state state;
+
+    zassert_equal(lights_control_get_channel(LIGHTS_CHANNEL_COUNT, &state), -EINVAL,
+                  "Out-of-range channel should be rejected");
+    zassert_equal(lights_control_set_channel(0, true, 101, LIGHTS_VERSION_ANY, NULL), -EINVAL,
+                  "Out-of-range level should be rejected");
+}
+
+/* Test last-writer-wins coalescing of a burst of writes */
+ZTEST(lights_control, test_coalescing)
+{
+    struct lights_control_stats before;
+    struct lights_control_stats after;
+    struct lights_channel_state state;
+    struct lights_channel_state initial;
+
+    /* Known starting point, so every write below is a change */
+    lights_control_set_channel(2, false, 0, LIGHTS_VERSION_ANY, NULL);
+    lights_control_set_channel(3, false, 0, LIGHTS_VERSION_ANY, NULL);
+
+    config_store_set(CONFIG_KEY_COALESCE_MS, 50, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    lights_control_get_channel(2, &initial);
+    lights_control_get_stats(&before);
+
+    for (int level = 10; level <= 50; level += 10) {
+        zassert_ok(lights_control_set_channel(2, true, level, LIGHTS_VERSION_ANY, &state),
+                   "Staged write should be acknowledged");
+        zassert_equal(state.level, level, "Reply should show the staged level");
+    }
+    lights_control_set_channel(3, true, 20, LIGHTS_VERSION_ANY, NULL);
+
+    lights_control_get_stats(&after);
+    zassert_equal(after.writes, before.writes + 6, "Every write should be counted");
+    zassert_equal(after.coalesced, before.coalesced + 4, "Superseded writes should be coalesced");
+    zassert_equal(after.commits, before.commits, "Nothing should be committed within the window");
+    zassert_equal(after.pending, 2, "Both channels should wait for the commit");
+
+    lights_control_get_channel(2, &state);
+    zassert_equal(state.version, initial.version + 5, "Versions should advance per write");
+    zassert_equal(state.change_seq, initial.change_seq, "Event is recorded at commit");
+
+    k_sleep(K_MSEC(80));
+    lights_control_get_stats(&after);
+    zassert_equal(after.commits, before.commits + 1, "Window should end in one commit");
+    zassert_equal(after.pending, 0, "Nothing should be left pending");
+    lights_control_get_channel(2, &state);
+    zassert_true(state.change_seq > initial.change_seq, "Commit should record the change");
+
+    config_store_set(CONFIG_KEY_COALESCE_MS, 0, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* Test a staged scene applied by the one-shot timer at its deadline */
+ZTEST(lights_control, test_scene_commit_at)
+{
+    struct lights_scene_status before;
+    struct lights_scene_status status;
+    struct lights_channel_state state;
+
+    lights_control_set_channel(4, false, 0, LIGHTS_VERSION_ANY, NULL);
+    lights_control_set_channel(5, false, 0, LIGHTS_VERSION_ANY, NULL);
+    lights_scene_clear();
+    lights_scene_get_status(&before);
+
+    zassert_equal(lights_scene_commit_at(device_time_now_us()), -ENODATA,
+                  "Empty scene should not be committed");
+    zassert_ok(lights_scene_stage(4, true, 70), "Staging should succeed");
+    zassert_ok(lights_scene_stage(5, true, 30), "Staging should succeed");
+    zassert_equal(lights_scene_stage(LIGHTS_CHANNEL_COUNT, true, 30), -EINVAL,
+                  "Invalid channel should be rejected");
+
+    int64_t deadline = device_time_now_us() + 50000;
+
+    zassert_ok(lights_scene_commit_at(deadline), "Commit should be scheduled");
+    zassert_equal(lights_scene_stage(4, true, 10), -EBUSY, "Armed scene must not change");
+
+    k_sleep(K_MSEC(20));
+    lights_control_get_channel(4, &state);
+    zassert_false(state.on, "Scene must not apply before its deadline");
+
+    k_sleep(K_MSEC(60));
+    lights_control_get_channel(4, &state);
+    zassert_true(state.on && state.level == 70, "Channel 4 not applied");
+    lights_control_get_channel(5, &state);
+    zassert_true(state.on && state.level == 30, "Channel 5 not applied");
+
+    lights_scene_get_status(&status);
+    zassert_equal(status.commits, before.commits + 1, "One scene should be applied");
+    zassert_false(status.armed, "Scene should be disarmed after applying");
+    zassert_equal(status.staged, 0, "Staged changes should be consumed");
+    zassert_true(status.last_late_us >= 0 && status.last_late_us < 1000,
+                 "Scene applied %lld us after the deadline", (long long)status.last_late_us);
+}
+
+/* Test that clearing cancels a scheduled scene */
+ZTEST(lights_control, test_scene_clear)
+{
+    struct lights_channel_state state;
+
+    lights_control_set_channel(6, false, 0, LIGHTS_VERSION_ANY, NULL);
+    lights_scene_clear();
+    zassert_ok(lights_scene_stage(6, true, 90), "Staging should succeed");
+    zassert_ok(lights_scene_commit_at(device_time_now_us() + 20000), "Commit should be scheduled");
+    lights_scene_clear();
+
+    k_sleep(K_MSEC(40));
+    lights_control_get_channel(6, &state);
+    zassert_false(state.on, "Cleared scene must not apply");
+}
+
+/* Test that usage counters accumulate on-time, duty, cycles and energy */
+ZTEST(lights_control, test_usage_accounting)
+{
+    struct lights_channel_usage before;
+    struct lights_channel_usage after;
+
+    config_store_set(CONFIG_KEY_RATED_W, 1000, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    lights_control_set_channel(7, false, 0, LIGHTS_VERSION_ANY, NULL);
+    zassert_ok(lights_control_get_usage(7, &before), "Usage read failed");
+
+    zassert_ok(lights_control_set_channel(7, true, 50, LIGHTS_VERSION_ANY, NULL), "Set failed");
+    k_sleep(K_MSEC(200));
+    zassert_ok(lights_control_set_channel(7, false, 50, LIGHTS_VERSION_ANY, NULL), "Set failed");
+    k_sleep(K_MSEC(100));
+    zassert_ok(lights_control_get_usage(7, &after), "Usage read failed");
+
+    uint64_t on_ms = after.on_ms - before.on_ms;
+    uint64_t duty_ms = after.duty_ms - before.duty_ms;
+    uint64_t energy_mwh = after.energy_mwh - before.energy_mwh;
+
+    zassert_true(on_ms >= 190 && on_ms <= 260, "On-time %llu ms", (unsigned long long)on_ms);
+    zassert_true(duty_ms >= 90 && duty_ms <= 130, "Duty %llu ms", (unsigned long long)duty_ms);
+    zassert_equal(after.cycles, before.cycles + 1, "One switch cycle expected");
+    /* 1000 W at 50% for 0.2 s is 100 J, about 28 mWh */
+    zassert_true(energy_mwh >= 24 && energy_mwh <= 37, "Energy %llu mWh",
+                 (unsigned long long)energy_mwh);
+
+    /* Off time adds nothing */
+    k_sleep(K_MSEC(50));
+    zassert_ok(lights_control_get_usage(7, &before), "Usage read failed");
+    zassert_equal(before.on_ms, after.on_ms, "Off channel must not accumulate on-time");
+
+    zassert_equal(lights_control_get_usage(LIGHTS_CHANNEL_COUNT, &after), -EINVAL,
+                  "Invalid channel should be rejected");
+    config_store_set(CONFIG_KEY_RATED_W, 10, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* Test that a rating change is charged from the moment it happens, and that
+ * energy is journaled to the milliwatt-hour
+ */
+ZTEST(lights_control, test_usage_rating_change)
+{
+    struct lights_channel_usage before;
+    struct lights_channel_usage after;
+    int32_t wh;
+    int32_t mwh;
+
+    zassert_ok(state_journal_init(), "Journal initialization failed");
+    config_store_set(CONFIG_KEY_RATED_W, 1000, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    lights_control_set_channel(7, false, 0, LIGHTS_VERSION_ANY, NULL);
+    zassert_ok(lights_control_get_usage(7, &before), "Usage read failed");
+
+    zassert_ok(lights_control_set_channel(7, true, 100, LIGHTS_VERSION_ANY, NULL), "Set failed");
+    k_sleep(K_MSEC(100));
+    config_store_set(CONFIG_KEY_RATED_W, 10, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    k_sleep(K_MSEC(100));
+    zassert_ok(lights_control_set_channel(7, false, 100, LIGHTS_VERSION_ANY, NULL), "Set failed");
+    zassert_ok(lights_control_get_usage(7, &after), "Usage read failed");
+
+    /* 1000 W for 0.1 s is 100 J, 10 W for 0.1 s adds 1 J: about 28 mWh */
+    uint64_t energy_mwh = after.energy_mwh - before.energy_mwh;
+
+    zassert_true(energy_mwh >= 24 && energy_mwh <= 37, "Energy %llu mWh",
+                 (unsigned long long)energy_mwh);
+
+    lights_control_save_usage();
+    zassert_ok(state_journal_get(STATE_KEY_USAGE_CH(7, STATE_USAGE_ENERGY_WH), &wh), "Wh missing");
+    zassert_ok(state_journal_get(STATE_KEY_USAGE_ENERGY_MWH_CH(7), &mwh), "mWh missing");
+    zassert_equal((uint64_t)wh * 1000U + (uint64_t)mwh, after.energy_mwh,
+                  "Energy should be journaled to the mWh");
+}
+
+/* Test that a multi-channel write stages every channel and commits once */
+ZTEST(lights_control, test_set_channels)
+{
+    struct lights_control_stats before;
+    struct lights_control_stats after;
+    struct lights_channel_state state;
+    uint32_t groups[LIGHTS_GROUP_COUNT];
+
+    lights_control_set_channels(BIT(4) | BIT(5) | BIT(6), false, 10);
+    lights_control_get_stats(&before);
+
+    zassert_equal(lights_control_set_channels(BIT(4) | BIT(6), true, 60), 2,
+                  "Both channels should change");
+    lights_control_get_stats(&after);
+    zassert_equal(after.writes, before.writes + 2, "Every channel should be counted");
+    zassert_equal(after.commits, before.commits + 1, "One commit expected for the mask");
+
+    lights_control_get_channel(4, &state);
+    zassert_true(state.on && state.level == 60, "Channel 4 not set");
+    lights_control_get_channel(5, &state);
+    zassert_false(state.on, "Unselected channel must not change");
+
+    /* Keeping the level only switches the channels */
+    zassert_equal(lights_control_set_channels(BIT(4) | BIT(5), true, LIGHTS_LEVEL_KEEP), 1,
+                  "Only channel 5 should change");
+    lights_control_get_channel(5, &state);
+    zassert_true(state.on && state.level == 10, "Channel 5 should keep its level");
+
+    zassert_equal(lights_control_set_channels(BIT(4), true, 60), 0, "No change expected");
+    zassert_equal(lights_control_set_channels(BIT(LIGHTS_CHANNEL_COUNT), true, 0), -EINVAL,
+                  "Channel outside the driver should be rejected");
+    zassert_equal(lights_control_set_channels(BIT(4), true, 101), -EINVAL,
+                  "Invalid level should be rejected");
+
+    zassert_ok(lights_control_set_group(1, BIT(4) | BIT(5)), "Group update failed");
+    lights_control_get_groups(groups);
+    zassert_equal(groups[1], BIT(4) | BIT(5), "Group mask not stored");
+    zassert_equal(lights_control_set_group(LIGHTS_GROUP_COUNT, 0), -EINVAL,
+                  "Invalid group should be rejected");
+    lights_control_set_group(1, 0);
+}
+
 /* Test Suite Definition */
 ZTEST_SUITE(lights_control, NULL, test_lights_control_setup, NULL, NULL, test_lights_control_teardown);
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file test_menu.c
+ * @brief Test suite for the menu system.
+ *
+ * Description:
+ * ------------
+ * This file uses ZTest to verify the dynamic list menus from `menu_list.c`.
+ * A synthetic list with a large number of entries counts how often its
+ * formatting callback runs, which lets the tests check that:
+ *  - Page counts are computed correctly, including for empty lists.
+ *  - Rendering a page only formats the entries on that page.
+ *  - Out-of-range pages are clamped to the last page.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <stdio.h>
+
+#include "menu_list.h"
+
+struct test_list_ctx {
+	size_t count;
+	size_t formatted;
+	size_t first_index;
+};
+
+static size_t test_list_count(void *ctx)
+{
+	return ((struct test_list_ctx *)ctx)->count;
+}
+
+static int test_list_format(size_t index, char *buf, size_t len, void *ctx)
+{
+	struct test_list_ctx *list_ctx = ctx;
+
+	if (list_ctx->formatted == 0) {
+		list_ctx->first_index = index;
+	}
+	list_ctx->formatted++;
+	snprintf(buf, len, "Entry %u", (unsigned int)index);
+	return 0;
+}
+
+static struct test_list_ctx list_ctx;
+
+static const struct menu_list test_list = {
+	.title = "Test List",
+	.count = test_list_count,
+	.format = test_list_format,
+	.ctx = &list_ctx,
+	.page_size = 8,
+};
+
+/* Reset the synthetic list before each test */
+static void test_menu_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+	list_ctx.count = 1000;
+	list_ctx.formatted = 0;
+	list_ctx.first_index = 0;
+}
+
+/* Page count rounds up and never drops below one page */
+ZTEST(menu, test_list_page_count)
+{
+	zassert_equal(menu_list_page_count(&test_list), 125, "Unexpected page count for 1000 entries");
+
+	list_ctx.count = 1001;
+	zassert_equal(menu_list_page_count(&test_list), 126, "Partial page should be counted");
+
+	list_ctx.count = 0;
+	zassert_equal(menu_list_page_count(&test_list), 1, "Empty list should still have one page");
+}
+
+/* Rendering a page formats exactly the entries of that page */
+ZTEST(menu, test_list_render_formats_only_page)
+{
+	int ret = menu_list_render_page(&test_list, 3);
+
+	zassert_equal(ret, 8, "Expected a full page of entries");
+	zassert_equal(list_ctx.formatted, 8, "Only the visible page should be formatted");
+	zassert_equal(list_ctx.first_index, 24, "Page 3 should start at entry 24");
+}
+
+/* A page beyond the end is clamped to the (partial) last page */
+ZTEST(menu, test_list_render_clamps_page)
+{
+	list_ctx.count = 20;
+
+	int ret = menu_list_render_page(&test_list, 99);
+
+	zassert_equal(ret, 4, "Last page should hold the remaining 4 entries");
+	zassert_equal(list_ctx.first_index, 16, "Last page should start at entry 16");
+}
+
+/* Invalid lists are rejected */
+ZTEST(menu, test_list_render_invalid)
+{
+	zassert_equal(menu_list_render_page(NULL, 0), -EINVAL, "NULL list should be rejected");
+}
+
+ZTEST_SUITE(menu, NULL, NULL, test_menu_before, NULL, NULL);
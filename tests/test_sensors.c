@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2024
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file test_sensors.c
+ * @brief Test suite for the sensor readings driver and the lights regulator.
+ *
+ * Description:
+ * ------------
+ * This file uses ZTest to verify `sensor_readings.c` and `lights_regulator.c`
+ * on native_sim, where all sensor channels are emulated, including the
+ * per-channel filter chains applied to every sample. The periodic sampler is
+ * slowed down for the tests (SENSOR_SAMPLE_INTERVAL_MS in CMakeLists.txt), so
+ * they feed the chains with sensor_readings_sample(). The regulator tests
+ * close the loop through a simulated room: the emulated ambient light is
+ * daylight plus 10 lux per percent of brightness of the regulated channel.
+ *
+ * The regulator period is set to its maximum so the periodic timer does not
+ * fire during a test; the tests drive the loop with lights_regulator_step().
+ * The regulator settings changed by a test are restored after it, so other
+ * suites see the configured values.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <stdlib.h>
+
+#include "change_seq.h"
+#include "config_store.h"
+#include "event_log.h"
+#include "lights_control.h"
+#include "lights_regulator.h"
+#include "sensor_readings.h"
+
+#define ROOM_DAYLIGHT_LUX 100
+#define ROOM_LUX_PER_LEVEL 10
+
+/* Update the emulated sensor from the regulated channel's brightness */
+static int room_update(void)
+{
+    struct lights_channel_state state;
+
+    lights_control_get_channel(config_store_value(CONFIG_KEY_REG_CHANNEL), &state);
+    int level = state.on ? state.level : 0;
+
+    sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT,
+                             (ROOM_DAYLIGHT_LUX + level * ROOM_LUX_PER_LEVEL) * 1000);
+    sensor_readings_sample();
+    return level;
+}
+
+static void regulator_tune(int32_t setpoint, int32_t slew)
+{
+    config_store_set(CONFIG_KEY_REG_PERIOD_MS, 10000, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    config_store_set(CONFIG_KEY_REG_SETPOINT, setpoint, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    config_store_set(CONFIG_KEY_REG_KP, 20, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    config_store_set(CONFIG_KEY_REG_KI, 5, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    config_store_set(CONFIG_KEY_REG_SLEW, slew, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* Regulator settings the tests retune, restored after every test */
+static const enum config_key reg_keys[] = {
+    CONFIG_KEY_REG_SETPOINT, CONFIG_KEY_REG_KP, CONFIG_KEY_REG_KI,
+    CONFIG_KEY_REG_SLEW, CONFIG_KEY_REG_PERIOD_MS,
+};
+static int32_t reg_saved[ARRAY_SIZE(reg_keys)];
+
+static void test_sensors_before(void *fixture)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(reg_keys); i++) {
+        reg_saved[i] = config_store_value(reg_keys[i]);
+    }
+}
+
+static void test_sensors_after(void *fixture)
+{
+    lights_regulator_disable();
+    for (size_t i = 0; i < ARRAY_SIZE(reg_keys); i++) {
+        config_store_set(reg_keys[i], reg_saved[i], CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    }
+    sensor_readings_set_filters(SENSOR_READINGS_AMBIENT_LIGHT, NULL, 0);
+    sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT, 300000);
+    sensor_readings_sample();
+}
+
+ZTEST(sensors, test_emulated_readings)
+{
+    int32_t value;
+    int32_t saved;
+    int whole;
+
+    zassert_ok(sensor_readings_init(), "Init failed");
+    zassert_true(sensor_readings_is_emulated(SENSOR_READINGS_AMBIENT_LIGHT),
+                 "native_sim has no light sensor");
+
+    zassert_ok(sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT, 123456), "Set failed");
+    sensor_readings_sample();
+    zassert_ok(sensor_readings_get(SENSOR_READINGS_AMBIENT_LIGHT, &value, NULL), "Read failed");
+    zassert_equal(value, 123456, "Emulated value not returned");
+    zassert_ok(sensor_readings_get_ambient_light(&whole), "Whole read failed");
+    zassert_equal(whole, 123, "Whole lux should be rounded");
+
+    /* A reading below zero is a value, not an error code */
+    zassert_ok(sensor_readings_get(SENSOR_READINGS_TEMPERATURE, &saved, NULL), "Read failed");
+    zassert_ok(sensor_readings_emul_set(SENSOR_READINGS_TEMPERATURE, -22400), "Set failed");
+    sensor_readings_sample();
+    zassert_ok(sensor_readings_get_temperature(&whole), "Sub-zero read must succeed");
+    zassert_equal(whole, -22, "Negative values should be rounded too");
+    sensor_readings_emul_set(SENSOR_READINGS_TEMPERATURE, saved);
+    sensor_readings_sample();
+
+    zassert_equal(sensor_readings_get(SENSOR_READINGS_COUNT, &value, NULL), -EINVAL,
+                  "Invalid channel should be rejected");
+}
+
+/* Samples pass through the channel's filter chain before they are returned */
+ZTEST(sensors, test_filtered_readings)
+{
+    const struct sensor_filter_config stages[] = {
+        { SENSOR_FILTER_MEDIAN, 3 },
+        { SENSOR_FILTER_DEADBAND, 1000 },
+    };
+    struct sensor_filter_config current[SENSOR_FILTER_STAGES_MAX];
+    uint32_t updates;
+    uint32_t after;
+    int32_t value;
+    int whole;
+
+    zassert_ok(sensor_readings_set_filters(SENSOR_READINGS_AMBIENT_LIGHT, stages,
+                                           ARRAY_SIZE(stages)), "Set filters failed");
+    zassert_equal(sensor_readings_get_filters(SENSOR_READINGS_AMBIENT_LIGHT, current,
+                                              ARRAY_SIZE(current)), 2, "Unexpected stage count");
+    zassert_equal(current[0].type, SENSOR_FILTER_MEDIAN, "Unexpected first stage");
+
+    sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT, 200000);
+    sensor_readings_sample();
+    zassert_ok(sensor_readings_get(SENSOR_READINGS_AMBIENT_LIGHT, &value, &updates),
+               "First sample");
+    zassert_equal(value, 200000, "First sample passes unchanged");
+
+    /* A single spike is rejected by the median and withheld by the deadband */
+    sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT, 900000);
+    sensor_readings_sample();
+    zassert_ok(sensor_readings_get(SENSOR_READINGS_AMBIENT_LIGHT, &value, &after), "Read failed");
+    zassert_equal(after, updates, "Spike should be withheld");
+    zassert_equal(value, 200000, "Withheld sample must leave the last value");
+
+    /* Reading does not feed the chain, however often consumers poll */
+    for (int i = 0; i < 5; i++) {
+        zassert_ok(sensor_readings_get_ambient_light(&whole), "Whole read failed");
+        zassert_equal(whole, 200, "Whole-unit read uses the last value");
+    }
+    zassert_ok(sensor_readings_get(SENSOR_READINGS_AMBIENT_LIGHT, &value, &after), "Read failed");
+    zassert_equal(after, updates, "Reads must not advance the filter chain");
+}
+
+/* Sensor channels are stamped for sync only when their value changes */
+ZTEST(sensors, test_sensor_change_seq)
+{
+    uint32_t before;
+    uint32_t stamped;
+
+    sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT, 111000);
+    sensor_readings_sample();
+    before = change_seq_current();
+
+    sensor_readings_sample();
+    zassert_true(sensor_readings_change_seq(SENSOR_READINGS_AMBIENT_LIGHT) <= before,
+                 "An unchanged value must not be stamped");
+
+    sensor_readings_emul_set(SENSOR_READINGS_AMBIENT_LIGHT, 222000);
+    sensor_readings_sample();
+    stamped = sensor_readings_change_seq(SENSOR_READINGS_AMBIENT_LIGHT);
+    zassert_true(stamped > before, "A new value should be stamped");
+    zassert_true(stamped <= change_seq_current(), "Stamp must be an allocated number");
+}
+
+ZTEST(sensors, test_regulator_disabled)
+{
+    zassert_equal(lights_regulator_step(), -EAGAIN, "Disabled regulator must not step");
+}
+
+/* The loop settles at the brightness that produces the setpoint */
+ZTEST(sensors, test_regulator_converges)
+{
+    struct lights_regulator_status status;
+
+    regulator_tune(500, 1000);
+    room_update();
+    zassert_ok(lights_regulator_enable(), "Enable failed");
+
+    for (int i = 0; i < 40; i++) {
+        zassert_ok(lights_regulator_step(), "Step failed");
+        room_update();
+    }
+
+    lights_regulator_get_status(&status);
+    zassert_true(status.enabled, "Regulator should be running");
+    zassert_equal(status.level, (500 - ROOM_DAYLIGHT_LUX) / ROOM_LUX_PER_LEVEL,
+                  "Unexpected settled brightness");
+    zassert_true(abs(status.error_milli) <= 5000, "Error should be inside the deadband");
+}
+
+/* Brightness changes by at most reg_slew percent per second */
+ZTEST(sensors, test_regulator_slew_limit)
+{
+    regulator_tune(1000, 1);
+    int level = room_update();
+
+    zassert_ok(lights_regulator_enable(), "Enable failed");
+
+    for (int i = 0; i < 5; i++) {
+        zassert_ok(lights_regulator_step(), "Step failed");
+        int next = room_update();
+
+        zassert_true(abs(next - level) <= 10, "Slew limit exceeded: %d -> %d", level, next);
+        level = next;
+    }
+}
+
+/* Slow sensor updates are integrated over the time they cover, not the period */
+ZTEST(sensors, test_regulator_slow_sensor)
+{
+    struct lights_regulator_status before;
+    struct lights_regulator_status after;
+
+    regulator_tune(1000, 10);
+    config_store_set(CONFIG_KEY_REG_PERIOD_MS, 50, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+    room_update();
+    zassert_ok(lights_regulator_enable(), "Enable failed");
+
+    /* The timer consumes the first measurement, then the loop holds */
+    k_sleep(K_MSEC(100));
+    lights_regulator_get_status(&before);
+
+    k_sleep(K_MSEC(500));
+    room_update();
+    zassert_ok(lights_regulator_step(), "Step failed");
+    lights_regulator_get_status(&after);
+
+    /* 10 %/s over about 0.55 s, where one 50 ms period would allow 0.5 % */
+    zassert_true(after.level - before.level >= 4, "Slew should cover the sensor gap: %d -> %d",
+                 before.level, after.level);
+    zassert_true(after.level - before.level <= 7, "Slew limit exceeded: %d -> %d",
+                 before.level, after.level);
+}
+
+/* A setpoint the lights cannot reach raises one alarm */
+ZTEST(sensors, test_regulator_saturation_alarm)
+{
+    struct event_record event;
+    size_t alarms = 0;
+    uint32_t since = change_seq_current();
+
+    regulator_tune(5000, 1000);
+    room_update();
+    zassert_ok(lights_regulator_enable(), "Enable failed");
+
+    for (int i = 0; i < 10; i++) {
+        zassert_ok(lights_regulator_step(), "Step failed");
+        room_update();
+    }
+
+    while (event_log_next_after(since, &event) == 0) {
+        since = event.seq;
+        if (event.type == EVENT_ALARM && event.id == EVENT_ALARM_REG_SATURATED) {
+            alarms++;
+            zassert_equal(event.aux, 5000 * 1000, "Alarm should carry the setpoint");
+        }
+    }
+    zassert_equal(alarms, 1, "Saturation should be reported once, not every step");
+}
+
+ZTEST_SUITE(sensors, NULL, NULL, test_sensors_before, test_sensors_after, NULL);
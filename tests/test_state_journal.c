@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2024
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file test_state_journal.c
+ * @brief Test suite for the state journal.
+ *
+ * Description:
+ * ------------
+ * This file uses ZTest to verify `state_journal.c` on the native_sim flash
+ * simulator (`storage_partition`). Re-running state_journal_init() stands in
+ * for a reboot: it drops all RAM state and replays the journal from flash.
+ *
+ * The tests focus on:
+ *  - Values appended and committed survive a re-initialization.
+ *  - Uncommitted values are lost on re-initialization (write-ahead semantics).
+ *  - Waiting for the group commit returns once the window expires.
+ *  - Compaction keeps the latest value of every key.
+ *  - Object versions after a reboot never repeat those of an earlier boot.
+ *  - A wrapping boot counter forces hosts to resynchronize.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-21
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+
+#include "app_config.h"
+#include "change_seq.h"
+#include "config_store.h"
+#include "state_journal.h"
+
+/* Start every test from a freshly replayed journal */
+static void test_state_journal_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+	zassert_ok(state_journal_init(), "Journal initialization failed");
+}
+
+/* Committed values are replayed after a reboot */
+ZTEST(state_journal, test_commit_and_replay)
+{
+	int32_t value;
+
+	zassert_ok(state_journal_append(STATE_KEY_LIGHTS_ON, 1), "Append failed");
+	zassert_ok(state_journal_append(STATE_KEY_LIGHTS_LEVEL, 70), "Append failed");
+	zassert_ok(state_journal_commit(), "Commit failed");
+
+	zassert_ok(state_journal_init(), "Re-initialization failed");
+
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_ON, &value), "ON state missing after replay");
+	zassert_equal(value, 1, "Unexpected ON state after replay");
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_LEVEL, &value), "Level missing after replay");
+	zassert_equal(value, 70, "Unexpected level after replay");
+}
+
+/* Values that were never committed do not survive a reboot */
+ZTEST(state_journal, test_uncommitted_lost)
+{
+	int32_t value;
+
+	zassert_ok(state_journal_append(STATE_KEY_LIGHTS_LEVEL, 30), "Append failed");
+	zassert_ok(state_journal_commit(), "Commit failed");
+
+	zassert_ok(state_journal_append(STATE_KEY_LIGHTS_LEVEL, 90), "Append failed");
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_LEVEL, &value), "Get failed");
+	zassert_equal(value, 90, "New value should be visible before commit");
+
+	zassert_ok(state_journal_init(), "Re-initialization failed");
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_LEVEL, &value), "Get failed");
+	zassert_equal(value, 30, "Uncommitted value should be lost");
+}
+
+/* The group commit window completes a waiting writer */
+ZTEST(state_journal, test_wait_committed)
+{
+	int32_t value;
+
+	zassert_ok(state_journal_append(STATE_KEY_LIGHTS_ON, 0), "Append failed");
+	zassert_ok(state_journal_wait_committed(K_MSEC(STATE_JOURNAL_COMMIT_MS * 10)),
+		   "Commit window did not complete");
+
+	zassert_ok(state_journal_init(), "Re-initialization failed");
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_ON, &value), "Get failed");
+	zassert_equal(value, 0, "Committed value missing after replay");
+}
+
+/* Many updates force compactions without losing the latest values */
+ZTEST(state_journal, test_compaction_keeps_latest)
+{
+	int32_t value;
+
+	for (int i = 0; i < 2000; i++) {
+		zassert_ok(state_journal_append(STATE_KEY_LIGHTS_LEVEL, i % 101), "Append failed");
+	}
+	zassert_ok(state_journal_commit(), "Commit failed");
+	zassert_ok(state_journal_compact(), "Explicit compaction failed");
+
+	zassert_ok(state_journal_init(), "Re-initialization failed");
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_LEVEL, &value), "Get failed");
+	zassert_equal(value, 1999 % 101, "Latest value lost by compaction");
+}
+
+/* A version seen before a reboot cannot match a key after it */
+ZTEST(state_journal, test_versions_across_reboot)
+{
+	int32_t value;
+	uint32_t before;
+	uint32_t after;
+
+	change_seq_init();
+	config_store_init();
+	zassert_ok(state_journal_commit(), "Commit failed");
+	zassert_ok(config_store_get(CONFIG_KEY_COALESCE_MS, &value, &before), "Get failed");
+
+	zassert_ok(state_journal_init(), "Re-initialization failed");
+	change_seq_init();
+	config_store_init();
+	zassert_ok(config_store_get(CONFIG_KEY_COALESCE_MS, &value, &after), "Get failed");
+
+	zassert_equal(after, change_seq_first_version(), "Versions should start at the boot's base");
+	zassert_true(after > before, "Version %u after reboot repeats one before (%u)", after, before);
+	zassert_equal(config_store_set(CONFIG_KEY_COALESCE_MS, value, before, NULL, NULL), -EAGAIN,
+		      "Version from before the reboot must not match");
+}
+
+/* Cursors cannot be trusted in the boot where the 8-bit boot counter wraps */
+ZTEST(state_journal, test_boot_counter_wrap)
+{
+	zassert_ok(state_journal_append(STATE_KEY_BOOT_COUNT, 255), "Append failed");
+	change_seq_init();
+
+	zassert_equal(change_seq_floor(), 1U << 24, "Boot 0 should be skipped on wrap");
+	zassert_true(change_seq_is_stale(change_seq_current()),
+		     "A cursor could be from 255 boots ago after a wrap");
+
+	change_seq_init();
+	zassert_equal(change_seq_floor(), 2U << 24, "Boot counter should keep counting");
+	zassert_false(change_seq_is_stale(change_seq_current()), "Current cursor is trusted again");
+	zassert_true(change_seq_is_stale(1U << 24), "Cursor from the previous boot is stale");
+}
+
+/* A batch is committed as a whole, never split across two commits */
+ZTEST(state_journal, test_append_batch)
+{
+	const struct state_journal_update updates[] = {
+		{ STATE_KEY_USAGE_CH(0, STATE_USAGE_ENERGY_WH), 12 },
+		{ STATE_KEY_USAGE_ENERGY_MWH_CH(0), 345 },
+	};
+	const struct state_journal_update invalid[] = {
+		{ STATE_KEY_LIGHTS_LEVEL, 10 },
+		{ STATE_KEY_COUNT, 1 },
+	};
+	int32_t value;
+
+	for (int i = 0; i < STATE_JOURNAL_BATCH_MAX - 1; i++) {
+		zassert_ok(state_journal_append(STATE_KEY_LIGHTS_LEVEL, i), "Append failed");
+	}
+	uint32_t earlier = state_journal_ticket();
+
+	/* One slot left: the pending records are committed first */
+	zassert_ok(state_journal_append_batch(updates, ARRAY_SIZE(updates)), "Batch failed");
+	zassert_ok(state_journal_ticket_committed(earlier), "Full batch should be committed first");
+	zassert_equal(state_journal_ticket_committed(state_journal_ticket()), -EAGAIN,
+		      "The new batch should wait for its own commit");
+	zassert_ok(state_journal_commit(), "Commit failed");
+
+	zassert_ok(state_journal_init(), "Re-initialization failed");
+	zassert_ok(state_journal_get(updates[0].key, &value), "Get failed");
+	zassert_equal(value, 12, "Unexpected first value after replay");
+	zassert_ok(state_journal_get(updates[1].key, &value), "Get failed");
+	zassert_equal(value, 345, "Unexpected second value after replay");
+
+	zassert_equal(state_journal_append_batch(invalid, ARRAY_SIZE(invalid)), -EINVAL,
+		      "Batch with an invalid key accepted");
+	zassert_ok(state_journal_get(STATE_KEY_LIGHTS_LEVEL, &value), "Get failed");
+	zassert_equal(value, STATE_JOURNAL_BATCH_MAX - 2, "A rejected batch must record nothing");
+}
+
+/* Invalid keys are rejected */
+ZTEST(state_journal, test_invalid_key)
+{
+	int32_t value;
+
+	zassert_equal(state_journal_append(STATE_KEY_COUNT, 1), -EINVAL, "Invalid key accepted");
+	zassert_equal(state_journal_get(STATE_KEY_COUNT, &value), -EINVAL, "Invalid key accepted");
+}
+
+ZTEST_SUITE(state_journal, NULL, NULL, test_state_journal_before, NULL, NULL);
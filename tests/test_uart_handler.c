@@ -21,8 +21,12 @@
 #include <zephyr/ztest.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <stdio.h>
 #include <string.h>
 
+#include "app_config.h"
 #include "uart_handler.h"
 
 LOG_MODULE_REGISTER(test_uart_handler, LOG_LEVEL_INF);
@@ -59,6 +63,42 @@ ZTEST(uart_handler, test_uart_write_string)
 	zassert_true(ret == -EINVAL, "Expected -EINVAL when passing NULL");
 }
 
+/**
+ * @brief Test the sized write API
+ *
+ * Sized writes send exactly the given bytes, so a payload with an embedded
+ * NUL is accepted in full; the literal macro takes its length at compile
+ * time.
+ */
+ZTEST(uart_handler, test_uart_write_sized)
+{
+	static const char payload[] = { 'A', '\0', 'B', '\r', '\n' };
+	const struct device *uart = DEVICE_DT_GET(DT_CHOSEN(zephyr_shell_uart));
+	uint8_t sent[32];
+	char buf[8];
+
+	zassert_ok(uart_handler_init(), "UART initialization failed");
+	k_sleep(K_MSEC(20));
+	uart_emul_flush_tx_data(uart);
+
+	zassert_ok(uart_handler_write(payload, sizeof(payload)), "Binary write failed");
+	zassert_ok(uart_handler_write_literal("OK\r\n"), "Literal write failed");
+	zassert_ok(uart_handler_write(payload, 0), "Empty write should succeed");
+	zassert_equal(uart_handler_write(NULL, 1), -EINVAL, "Expected -EINVAL for NULL data");
+
+	/* A truncated snprintf() result only writes what is in the buffer */
+	int len = snprintf(buf, sizeof(buf), "%s", "truncated");
+
+	zassert_ok(uart_handler_write_formatted(buf, sizeof(buf), len), "Formatted write failed");
+
+	k_sleep(K_MSEC(20));
+	uint32_t n = uart_emul_get_tx_data(uart, sent, sizeof(sent));
+
+	zassert_equal(n, sizeof(payload) + 4 + 7, "Unexpected output length %u", n);
+	zassert_mem_equal(sent, payload, sizeof(payload), "Payload must be sent as is");
+	zassert_mem_equal(sent + sizeof(payload), "OK\r\ntruncat", 4 + 7, "Unexpected output");
+}
+
 /**
  * @brief Test the UART message queue behavior
  *
@@ -88,6 +128,178 @@ ZTEST(uart_handler, test_uart_msgq_behavior)
 				 "Retrieved line does not match the inserted line");
 }
 
+/**
+ * @brief Test the abort state when no abort was requested
+ *
+ * Ctrl-C and break can only be raised from the RX interrupt, so here we only
+ * check that no abort is pending by default, that clearing is harmless, and
+ * that writes are accepted afterwards.
+ */
+ZTEST(uart_handler, test_uart_abort_idle)
+{
+	zassert_false(uart_handler_abort_pending(), "No abort should be pending at start");
+
+	uart_handler_abort_clear();
+	zassert_false(uart_handler_abort_pending(), "Abort should stay cleared");
+
+	int ret = uart_handler_write_string("After abort clear\r\n");
+	zassert_true(ret == 0, "Expected writes to succeed without a pending abort");
+}
+
+/*
+ * Queue an input line and held-back output, then check that an abort injected
+ * with @p inject discards both and leaves only the abort marker.
+ */
+static void test_uart_abort_inject(void (*inject)(const struct device *uart))
+{
+	const struct device *uart = DEVICE_DT_GET(DT_CHOSEN(zephyr_shell_uart));
+	char line[UART_MSG_SIZE] = "lights stats";
+	uint8_t sent[32];
+
+	zassert_ok(uart_handler_init(), "UART initialization failed");
+	k_sleep(K_MSEC(20));
+	uart_emul_flush_tx_data(uart);
+	k_msgq_purge(&uart_msgq);
+
+	zassert_ok(k_msgq_put(&uart_msgq, line, K_NO_WAIT), "Failed to queue input");
+	uart_handler_tx_cork();
+	zassert_ok(uart_handler_write_literal("pending output\r\n"), "Write failed");
+
+	inject(uart);
+	k_sleep(K_MSEC(10));
+
+	zassert_true(uart_handler_abort_pending(), "Abort should be pending");
+	zassert_equal(uart_handler_write_literal("x"), -ECANCELED, "Output should be refused");
+	zassert_equal(k_msgq_num_used_get(&uart_msgq), 1, "Queued input should be purged");
+	zassert_ok(k_msgq_get(&uart_msgq, line, K_NO_WAIT), "Abort marker expected");
+	zassert_equal(line[0], '\0', "Abort marker must be an empty line");
+
+	/* Nothing is left in the TX ring for the uncork to send */
+	uart_handler_tx_uncork();
+	k_sleep(K_MSEC(10));
+	zassert_equal(uart_emul_get_tx_data(uart, sent, sizeof(sent)), 0,
+				  "Pending output should be discarded");
+
+	uart_handler_abort_clear();
+	zassert_false(uart_handler_abort_pending(), "Abort should be cleared");
+}
+
+static void test_uart_inject_ctrl_c(const struct device *uart)
+{
+	static const uint8_t ctrl_c = 0x03;
+
+	uart_emul_put_rx_data(uart, &ctrl_c, 1);
+}
+
+static void test_uart_inject_break(const struct device *uart)
+{
+	static const uint8_t eol = '\n';
+
+	/* The error is picked up by the interrupt the next received byte raises */
+	uart_emul_set_errors(uart, UART_BREAK);
+	uart_emul_put_rx_data(uart, &eol, 1);
+}
+
+/**
+ * @brief Test that Ctrl-C received on RX aborts pending TX and input
+ */
+ZTEST(uart_handler, test_uart_abort_ctrl_c)
+{
+	test_uart_abort_inject(test_uart_inject_ctrl_c);
+}
+
+/**
+ * @brief Test that a break condition aborts pending TX and input
+ */
+ZTEST(uart_handler, test_uart_abort_break)
+{
+	test_uart_abort_inject(test_uart_inject_break);
+}
+
+/**
+ * @brief Test that corked writes leave as a single transfer
+ *
+ * Several small writes under a cork must not start a transfer before the
+ * uncork, which then starts exactly one. An uncorked small write is sent
+ * by the coalescing deadline.
+ */
+ZTEST(uart_handler, test_uart_tx_cork)
+{
+	struct uart_handler_tx_stats before;
+	struct uart_handler_tx_stats after;
+
+	zassert_ok(uart_handler_init(), "UART initialization failed");
+	k_sleep(K_MSEC(10));
+
+	uart_handler_tx_get_stats(&before);
+	uart_handler_tx_cork();
+	zassert_ok(uart_handler_write_string("Turning lights ON...\r\n"), "Write failed");
+	zassert_ok(uart_handler_write_string("Lights turned ON.\r\n"), "Write failed");
+	zassert_ok(uart_handler_write_string("Enter your choice:\r\n"), "Write failed");
+
+	uart_handler_tx_get_stats(&after);
+	zassert_equal(after.writes, before.writes + 3, "Writes should be queued");
+	zassert_equal(after.transfers, before.transfers, "Corked output must be held back");
+
+	uart_handler_tx_uncork();
+	uart_handler_tx_get_stats(&after);
+	zassert_equal(after.transfers, before.transfers + 1, "Uncork should start one transfer");
+
+	k_sleep(K_MSEC(10));
+	uart_handler_tx_get_stats(&before);
+	zassert_ok(uart_handler_write_string("x"), "Write failed");
+	k_sleep(K_MSEC(10));
+	uart_handler_tx_get_stats(&after);
+	zassert_equal(after.transfers, before.transfers + 1, "Small write should still be sent");
+	zassert_equal(after.deadline_flushes, before.deadline_flushes + 1,
+		      "Small write should wait for the coalescing deadline");
+}
+
+static K_THREAD_STACK_DEFINE(tag_thread_stack, 1024);
+static struct k_thread tag_thread;
+static const char *tag_thread_seen;
+
+static void tag_thread_entry(void *p1, void *p2, void *p3)
+{
+	tag_thread_seen = uart_handler_reply_tag_get();
+	uart_handler_reply_tag_set("#2 ");
+	uart_handler_write_literal("b\r\n");
+	uart_handler_reply_tag_set(NULL);
+}
+
+/**
+ * @brief Test that reply tags belong to the thread that set them
+ *
+ * A second thread tagging its own reply neither sees nor replaces the tag
+ * of the first, and clearing a tag leaves later output untagged.
+ */
+ZTEST(uart_handler, test_uart_reply_tag_per_thread)
+{
+	const struct device *uart = DEVICE_DT_GET(DT_CHOSEN(zephyr_shell_uart));
+	char out[64] = { 0 };
+
+	zassert_ok(uart_handler_init(), "UART initialization failed");
+	k_sleep(K_MSEC(20));
+	uart_emul_flush_tx_data(uart);
+
+	uart_handler_reply_tag_set("#1 ");
+	k_thread_create(&tag_thread, tag_thread_stack, K_THREAD_STACK_SIZEOF(tag_thread_stack),
+			tag_thread_entry, NULL, NULL, NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	zassert_ok(k_thread_join(&tag_thread, K_MSEC(500)), "Tagging thread did not finish");
+	zassert_ok(uart_handler_write_literal("a\r\n"), "Write failed");
+	zassert_equal(strcmp(uart_handler_reply_tag_get(), "#1 "), 0, "Own tag was replaced");
+	uart_handler_reply_tag_set(NULL);
+	zassert_ok(uart_handler_write_literal("c\r\n"), "Write failed");
+
+	k_sleep(K_MSEC(20));
+	uart_emul_get_tx_data(uart, (uint8_t *)out, sizeof(out) - 1);
+
+	zassert_is_null(tag_thread_seen, "Tag leaked to another thread");
+	zassert_not_null(strstr(out, "#2 b\r\n"), "Second thread untagged: '%s'", out);
+	zassert_not_null(strstr(out, "#1 a\r\n"), "First thread untagged: '%s'", out);
+	zassert_not_null(strstr(out, "\nc\r\n"), "Output after clearing is tagged: '%s'", out);
+}
+
 /* 
  * Test suite definition: Groups all tests above into a single suite.
  */
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2024
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * @file test_utils.c
+ * @brief Test suite for the utility modules.
+ *
+ * Description:
+ * ------------
+ * This file uses ZTest to verify the helpers in `src/utils`:
+ *  - input_parser: tokenizing lines, parsing numeric/on-off arguments and
+ *    channel selectors.
+ *  - config_store: range checks and version-conditional writes.
+ *  - change_seq: changes are stamped with increasing sequence numbers.
+ *  - event_log: replay after a sequence number and gap detection.
+ *  - sensor_filter: fixed-point streaming filters and filter chains.
+ *
+ * @author Ameed Othman
+ * @date 2024-12-22
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <string.h>
+
+#include "app_config.h"
+#include "change_seq.h"
+#include "config_store.h"
+#include "event_log.h"
+#include "input_parser.h"
+#include "sensor_filter.h"
+
+/* Tokenizing splits on spaces and tabs and ignores repeated separators */
+ZTEST(utils, test_tokenize)
+{
+    char line[] = "  lights \tcas 2  7 on 40 ";
+    char *argv[8];
+
+    int argc = input_parser_tokenize(line, argv, ARRAY_SIZE(argv));
+    zassert_equal(argc, 6, "Unexpected argument count");
+    zassert_str_equal(argv[0], "lights", "Unexpected first argument");
+    zassert_str_equal(argv[5], "40", "Unexpected last argument");
+
+    char too_long[] = "a b c";
+    zassert_equal(input_parser_tokenize(too_long, argv, 2), -E2BIG, "Overflow not reported");
+}
+
+/* Number parsing rejects trailing garbage and out-of-range values */
+ZTEST(utils, test_parse_numbers)
+{
+    int32_t value;
+    uint32_t uvalue;
+    int64_t value64;
+    bool on;
+
+    zassert_ok(input_parser_parse_int("-42", &value), "Valid integer rejected");
+    zassert_equal(value, -42, "Unexpected integer value");
+    zassert_equal(input_parser_parse_int("12x", &value), -EINVAL, "Trailing garbage accepted");
+    zassert_equal(input_parser_parse_int("", &value), -EINVAL, "Empty string accepted");
+    zassert_equal(input_parser_parse_uint("-1", &uvalue), -EINVAL, "Negative unsigned accepted");
+    zassert_ok(input_parser_parse_uint("4294967295", &uvalue), "UINT32_MAX rejected");
+    zassert_ok(input_parser_parse_int64("-5000000000", &value64), "64-bit integer rejected");
+    zassert_equal(value64, -5000000000LL, "Unexpected 64-bit value");
+    zassert_equal(input_parser_parse_int64("1e6", &value64), -EINVAL, "Trailing garbage accepted");
+
+    zassert_ok(input_parser_parse_on_off("on", &on), "on rejected");
+    zassert_true(on, "on parsed as off");
+    zassert_ok(input_parser_parse_on_off("0", &on), "0 rejected");
+    zassert_false(on, "0 parsed as on");
+    zassert_equal(input_parser_parse_on_off("maybe", &on), -EINVAL, "Invalid on/off accepted");
+}
+
+/* Channel selectors compile into a mask of the selected channels */
+ZTEST(utils, test_parse_channels)
+{
+    const uint32_t groups[] = { 0x03, 0x30 };
+    uint32_t mask;
+
+    zassert_ok(input_parser_parse_channels("*", 8, groups, ARRAY_SIZE(groups), &mask),
+               "Wildcard rejected");
+    zassert_equal(mask, 0xff, "Wildcard should select every channel");
+    zassert_ok(input_parser_parse_channels("0,2,4-7", 8, groups, ARRAY_SIZE(groups), &mask),
+               "List with range rejected");
+    zassert_equal(mask, 0xf5, "Unexpected list mask");
+    zassert_ok(input_parser_parse_channels("g1,0", 8, groups, ARRAY_SIZE(groups), &mask),
+               "Group rejected");
+    zassert_equal(mask, 0x31, "Unexpected group mask");
+    zassert_ok(input_parser_parse_channels("0-31", 32, NULL, 0, &mask), "Full range rejected");
+    zassert_equal(mask, UINT32_MAX, "Full range should select all 32 channels");
+
+    zassert_equal(input_parser_parse_channels("8", 8, groups, ARRAY_SIZE(groups), &mask),
+                  -EINVAL, "Channel out of range accepted");
+    zassert_equal(input_parser_parse_channels("3-1", 8, groups, ARRAY_SIZE(groups), &mask),
+                  -EINVAL, "Reversed range accepted");
+    zassert_equal(input_parser_parse_channels("x", 8, groups, ARRAY_SIZE(groups), &mask),
+                  -EINVAL, "Garbage accepted");
+    zassert_equal(input_parser_parse_channels("1,", 8, groups, ARRAY_SIZE(groups), &mask),
+                  -EINVAL, "Empty item accepted");
+    zassert_equal(input_parser_parse_channels("g9", 8, groups, ARRAY_SIZE(groups), &mask),
+                  -EINVAL, "Unknown group accepted");
+}
+
+/* Conditional config writes apply only with the current version */
+ZTEST(utils, test_config_compare_and_set)
+{
+    int32_t value;
+    uint32_t version;
+    int32_t cur_value;
+    uint32_t cur_version;
+
+    zassert_ok(config_store_get(CONFIG_KEY_BRIGHTNESS_STEP, &value, &version), "Get failed");
+
+    int32_t next = (value == 5) ? 6 : 5;
+    zassert_ok(config_store_set(CONFIG_KEY_BRIGHTNESS_STEP, next, version, &cur_value, &cur_version),
+               "Write with current version rejected");
+    zassert_equal(cur_value, next, "Value not applied");
+    zassert_equal(cur_version, version + 1, "Version should advance by one");
+
+    zassert_equal(config_store_set(CONFIG_KEY_BRIGHTNESS_STEP, 7, version, &cur_value, &cur_version),
+                  -EAGAIN, "Write with stale version applied");
+    zassert_equal(cur_value, next, "Rejected write changed the value");
+
+    zassert_equal(config_store_set(CONFIG_KEY_BRIGHTNESS_STEP, 1000, CONFIG_STORE_VERSION_ANY,
+                                   NULL, NULL), -EINVAL, "Out-of-range value accepted");
+    zassert_equal(config_store_key_from_name("brightness_step"), CONFIG_KEY_BRIGHTNESS_STEP,
+                  "Key lookup by name failed");
+
+    /* Restore the default for other suites */
+    config_store_set(CONFIG_KEY_BRIGHTNESS_STEP, 10, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* Every applied change gets a sequence number newer than the previous one */
+ZTEST(utils, test_change_seq_stamps)
+{
+    uint32_t before = change_seq_current();
+    int32_t value;
+
+    zassert_ok(config_store_get(CONFIG_KEY_DEFAULT_LEVEL, &value, NULL), "Get failed");
+    zassert_ok(config_store_set(CONFIG_KEY_DEFAULT_LEVEL, value == 40 ? 41 : 40,
+                                CONFIG_STORE_VERSION_ANY, NULL, NULL), "Set failed");
+
+    uint32_t stamped = config_store_change_seq(CONFIG_KEY_DEFAULT_LEVEL);
+    zassert_true(stamped > before, "Change not stamped with a newer sequence number");
+    zassert_equal(stamped, change_seq_current(), "Stamp should be the current sequence number");
+    zassert_true(change_seq_next() > stamped, "Sequence must keep increasing");
+
+    config_store_set(CONFIG_KEY_DEFAULT_LEVEL, 50, CONFIG_STORE_VERSION_ANY, NULL, NULL);
+}
+
+/* Events replay in order; overwriting unseen events reports a gap */
+ZTEST(utils, test_event_log_replay)
+{
+    struct event_record event;
+    uint32_t since = change_seq_current();
+    uint32_t first = event_log_record(EVENT_ALARM, 1, 10, 20);
+    uint32_t second = event_log_record(EVENT_ALARM, 2, 30, 20);
+
+    zassert_false(event_log_has_gap(since), "No event was lost yet");
+    zassert_ok(event_log_next_after(since, &event), "First event not found");
+    zassert_equal(event.seq, first, "Events must replay oldest first");
+    zassert_equal(event.id, 1, "Unexpected event payload");
+    zassert_ok(event_log_next_after(first, &event), "Second event not found");
+    zassert_equal(event.seq, second, "Events must replay in sequence order");
+    zassert_equal(event_log_next_after(second, &event), -ENOENT, "No event after the newest");
+
+    for (int i = 0; i < EVENT_LOG_SIZE; i++) {
+        event_log_record(EVENT_ALARM, 3, i, 0);
+    }
+
+    zassert_true(event_log_has_gap(since), "Overwritten events must be reported as a gap");
+    zassert_false(event_log_has_gap(change_seq_current()), "Up-to-date reader has no gap");
+    zassert_equal(event_log_count(), EVENT_LOG_SIZE, "Log should be full");
+    zassert_true(event_log_has_gap(change_seq_current() + 1), "Future sequence numbers are a gap");
+}
+
+/* Feed samples to one filter; returns the number of emitted values */
+static int filter_feed(const struct sensor_filter_config *config, const int32_t *in, int n,
+                       int32_t *out)
+{
+    struct sensor_filter filter;
+    int emitted = 0;
+
+    zassert_ok(sensor_filter_init(&filter, config), "Filter init failed");
+    for (int i = 0; i < n; i++) {
+        if (sensor_filter_process(&filter, in[i], &out[emitted]) == 0) {
+            emitted++;
+        }
+    }
+    return emitted;
+}
+
+ZTEST(utils, test_sensor_filters)
+{
+    const int32_t spiky[] = { 10, 11, 900, 12, 13, -700, 14 };
+    const int32_t ramp[] = { 0, 100, 200, 300, 400, 500 };
+    int32_t out[8];
+
+    const struct sensor_filter_config median = { SENSOR_FILTER_MEDIAN, 3 };
+    zassert_equal(filter_feed(&median, spiky, ARRAY_SIZE(spiky), out), 7, "Median emits always");
+    zassert_equal(out[2], 11, "Spike should be rejected");
+    zassert_equal(out[5], 12, "Negative spike should be rejected");
+    zassert_equal(out[6], 13, "Unexpected median");
+
+    const struct sensor_filter_config average = { SENSOR_FILTER_AVERAGE, 4 };
+    filter_feed(&average, ramp, ARRAY_SIZE(ramp), out);
+    zassert_equal(out[1], 50, "Average of a partial window");
+    zassert_equal(out[5], 350, "Average of the last four samples");
+
+    const struct sensor_filter_config ewma = { SENSOR_FILTER_EWMA, 128 };
+    filter_feed(&ewma, ramp, 2, out);
+    zassert_equal(out[0], 0, "EWMA starts at the first sample");
+    zassert_equal(out[1], 50, "EWMA with alpha 1/2");
+
+    const struct sensor_filter_config decimate = { SENSOR_FILTER_DECIMATE, 3 };
+    zassert_equal(filter_feed(&decimate, ramp, ARRAY_SIZE(ramp), out), 2, "Keep one in three");
+    zassert_equal(out[1], 300, "Unexpected decimated sample");
+
+    const struct sensor_filter_config deadband = { SENSOR_FILTER_DEADBAND, 15 };
+    zassert_equal(filter_feed(&deadband, spiky, 5, out), 3, "Small changes should be withheld");
+    zassert_equal(out[2], 12, "Change from the last emitted value, not the last sample");
+
+    const struct sensor_filter_config bad = { SENSOR_FILTER_MEDIAN, SENSOR_FILTER_WINDOW_MAX + 1 };
+    struct sensor_filter filter;
+    zassert_equal(sensor_filter_init(&filter, &bad), -EINVAL, "Oversized window accepted");
+}
+
+ZTEST(utils, test_sensor_filter_chain)
+{
+    struct sensor_filter_chain chain = { 0 };
+    const struct sensor_filter_config stages[] = {
+        { SENSOR_FILTER_MEDIAN, 3 },
+        { SENSOR_FILTER_DEADBAND, 5 },
+    };
+    const struct sensor_filter_config bad[] = { { SENSOR_FILTER_EWMA, 0 } };
+    int32_t out;
+
+    zassert_ok(sensor_filter_chain_set(&chain, stages, ARRAY_SIZE(stages)), "Set failed");
+    zassert_ok(sensor_filter_chain_process(&chain, 100, &out), "First sample must pass");
+    zassert_equal(sensor_filter_chain_process(&chain, 1000, &out), -EAGAIN,
+                  "Spike inside the deadband after the median should be withheld");
+    zassert_equal(out, 100, "Withheld sample must not change the output");
+
+    zassert_equal(sensor_filter_chain_set(&chain, bad, ARRAY_SIZE(bad)), -EINVAL,
+                  "Invalid stage accepted");
+    zassert_equal(chain.count, 2, "Invalid configuration must leave the chain unchanged");
+}
+
+ZTEST_SUITE(utils, NULL, NULL, NULL, NULL, NULL);